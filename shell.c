@@ -34,28 +34,97 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <time.h>
 
 #include "shell.h"
+#include "shell_trace.h"
+#include "shell_status.h"
+#include "shell_scrollback.h"
+#include "shell_vars.h"
+#include "shell_pipe.h"
 
 
 
+#ifndef SHELL_OUT_CLOCK
+#if defined(CLOCK_MONOTONIC)
+#define SHELL_OUT_CLOCK()               shell_out_clock()
+#else
+#define SHELL_OUT_CLOCK()               0          //!< Define it with the timer of the target, in ms
+#endif
+#endif
+
+#define SHELL_OUT_LOST                  0xFFFF     //!< Where the cursor is isn't known
+
 
 
 //Declare Prototype
 static inline void shell_print_prompt(shellObject_t *pshell);
-static void shell_insert_char(shellObject_t *pshell, char ch);
+static inline uint16_t shell_prompt_len(shellObject_t *pshell);
+static void shell_cursor_move(shellObject_t *pshell, uint16_t from, uint16_t to);
+static void shell_cursor_after_print(shellObject_t *pshell, uint16_t end, uint16_t to);
+static void shell_erase_line(shellObject_t *pshell, uint16_t ncols);
+static void shell_redraw_line(shellObject_t *pshell);
+static void shell_reflow_line(shellObject_t *pshell, uint16_t old_ncols);
+static void shell_print_line(shellObject_t *pshell, uint16_t from, uint16_t to);
+static inline void shell_hl_plain(shellObject_t *pshell);
+static uint16_t shell_hl_edit(shellObject_t *pshell, uint16_t at, uint16_t len, int16_t shift);
+#if SHELL_CFG_HIGHLIGHT
+static uint8_t shell_hl_token(shellObject_t *pshell, uint16_t start, uint16_t end, bool first);
+static uint16_t shell_hl_lex(shellObject_t *pshell, uint16_t from, uint16_t to);
+#endif
+static void shell_insert_text(shellObject_t *pshell, const char *text, uint16_t len);
+static inline void shell_insert_char(shellObject_t *pshell, char ch);
 static void shell_remove_char(shellObject_t *pshell);
 static void shell_move_cursor_right(shellObject_t *pshell);
 static void shell_move_cursor_left(shellObject_t *pshell);
 
+static void shell_paste_begin(shellObject_t *pshell);
+static void shell_paste_end(shellObject_t *pshell);
+static bool shell_paste_char(shellObject_t *pshell, int32_t ch);
+
 static void shell_handle_history(shellObject_t *pshell);
 static void shell_push_history(shellObject_t *pshell);
 
 static size_t shell_read(shellObject_t *pshell);
+static void shell_read_busy(shellObject_t *pshell);
+static uint16_t shell_rows(shellObject_t *pshell);
+static void shell_page_lines(shellObject_t *pshell, uint16_t nlines);
+static void shell_read_pager(shellObject_t *pshell);
+
+static inline void shell_hold(shellObject_t *pshell);
+static inline void shell_release(shellObject_t *pshell);
+static bool shell_out_room(shellObject_t *pshell, size_t len);
+static void shell_out_raw(shellObject_t *pshell, const void *data, size_t len);
+static void shell_fmt_put(void *ctx, const char *data, size_t len);
+#if defined(CLOCK_MONOTONIC)
+static inline uint64_t shell_out_clock(void);
+#endif
+static inline void shell_out_kind(shellObject_t *pshell, uint8_t kind);
+static inline void shell_out_save(shellObject_t *pshell);
+static inline bool shell_piping(shellObject_t *pshell);
+static uint32_t shell_outq_remove(shell_outq_t *q, uint8_t first, uint8_t count);
+static void shell_outq_drain(shellObject_t *pshell);
+static bool shell_outq_coalesce(shellObject_t *pshell, uint32_t len);
+static void shell_outq_put(shellObject_t *pshell, const uint8_t *data, uint32_t len);
+static void shell_outq_redraw(shellObject_t *pshell);
+static void shell_json_write(shellObject_t *pshell, const uint8_t *src, size_t len);
+static void shell_record_begin(shellObject_t *pshell, bool cmd);
+static void shell_record_end(shellObject_t *pshell, bool cmd, int32_t status);
+static int32_t shell_cmd_machine(shellObject_t *pshell, int32_t argc, char *argv[]);
+
+
+
+
 
 
 
 
+#if SHELL_CFG_HIGHLIGHT
+/* colour of each class */
+static const uint8_t shell_hl_colour[] = {
+    VT_COL_DEFAULT, SHELL_HL_COLOUR_CMD, SHELL_HL_COLOUR_UNKNOWN, SHELL_HL_COLOUR_OPTION
+};
+#endif
 
 
 
@@ -67,47 +136,323 @@ static inline void shell_print_prompt(shellObject_t *pshell)
     pshell->line_cur = 0;
     pshell->line_pos = 0;
     pshell->line[0] = 0;
-    shellPrintf(pshell, pshell->prompt);
+    shell_hl_plain(pshell);
+    shellPuts(pshell, pshell->prompt);
 }
 
 
 //*****************************************************************************
-// insert len char of text at cursor position
-static void shell_insert_char(shellObject_t *pshell, char ch)
+static inline uint16_t shell_prompt_len(shellObject_t *pshell)
 {
-    int i;
+    return pshell->prompt_len;
+}
 
-    /* it's a large line, discard it */
-    if (pshell->line_pos < sizeof(pshell->line) - 1){
-        /* normal character */
-        if (pshell->line_cur < pshell->line_pos)
-        {
-            memmove(&pshell->line[pshell->line_cur + 1],
-                    &pshell->line[pshell->line_cur],
-                    pshell->line_pos - pshell->line_cur);
 
-            pshell->line[pshell->line_cur] = ch;
-            pshell->line[pshell->line_pos + 1] = 0;
+//*****************************************************************************
+// move the cursor between two offsets of the edit area (prompt included)
+static void shell_cursor_move(shellObject_t *pshell, uint16_t from, uint16_t to)
+{
+    uint16_t ncols = pshell->vt->ncols;
+    int32_t rows = (to / ncols) - (from / ncols);
+
+    if (rows < 0) {
+        shellPuts(pshell, vtMoveCursor(pshell->vt, -rows, VT_MOVE_CUR_UP));
+    }
+    else if (rows > 0) {
+        shellPuts(pshell, vtMoveCursor(pshell->vt, rows, VT_MOVE_CUR_DOWN));
+    }
+
+    if (rows != 0) {
+        shellPuts(pshell, vtMoveCursor(pshell->vt, (to % ncols) + 1, VT_MOVE_CUR_H));
+    }
+    else if (to < from) {
+        shellPuts(pshell, vtMoveCursor(pshell->vt, from - to, VT_MOVE_CUR_LEFT));
+    }
+    else if (to > from) {
+        shellPuts(pshell, vtMoveCursor(pshell->vt, to - from, VT_MOVE_CUR_RIGHT));
+    }
+}
 
-            if (pshell->echo){
-                shellPrintf(pshell, &pshell->line[pshell->line_cur]);
 
-                /* move the cursor to new position */
-                for (i = pshell->line_cur; i < pshell->line_pos; i++) {
-                    shellPutc(KEY_BS, pshell);
-                }
-            }
+//*****************************************************************************
+// place the cursor once the edit area is printed up to end
+static void shell_cursor_after_print(shellObject_t *pshell, uint16_t end, uint16_t to)
+{
+    uint16_t ncols = pshell->vt->ncols;
+
+    if (end && !(end % ncols)) {
+        /* the terminal waits on the last column to wrap */
+        if (to == end) {
+            shellPrintf(pshell, "\r\n");
+            return;
         }
-        else
-        {
-            pshell->line[pshell->line_pos] = ch;
-            if (pshell->echo) shellPutc(ch, pshell);
-            pshell->line[pshell->line_pos + 1] = 0;
+
+        shellPuts(pshell, vtMoveCursor(pshell->vt, ncols, VT_MOVE_CUR_H));
+        end--;
+    }
+
+    shell_cursor_move(pshell, end, to);
+}
+
+
+//*****************************************************************************
+// go back to the prompt and erase the edit area drawn on ncols columns
+static void shell_erase_line(shellObject_t *pshell, uint16_t ncols)
+{
+    uint16_t rows = (shell_prompt_len(pshell) + pshell->line_cur) / ncols;
+
+    if (rows) {
+        shellPuts(pshell, vtMoveCursor(pshell->vt, rows, VT_MOVE_CUR_UP));
+    }
+    shellPrintf(pshell, "\r");
+    shellPuts(pshell, vtEraseScreen(pshell->vt, VT_ERASE_SCREEN_DOWN));
+}
+
+
+//*****************************************************************************
+// print the prompt and the line, the cursor is set back to line_cur
+static void shell_redraw_line(shellObject_t *pshell)
+{
+    uint16_t plen = shell_prompt_len(pshell);
+
+    SHELL_TRACE_BEGIN(pshell, SHELL_TRACE_REDRAW, pshell->line_pos);
+
+    shell_hl_edit(pshell, 0, pshell->line_pos, 0);
+
+    shell_hl_plain(pshell);
+    shellPuts(pshell, pshell->prompt);
+    shell_print_line(pshell, 0, pshell->line_pos);
+    shell_cursor_after_print(pshell, plen + pshell->line_pos, plen + pshell->line_cur);
+
+    SHELL_TRACE_END(pshell, SHELL_TRACE_REDRAW, pshell->line_pos);
+}
+
+
+//*****************************************************************************
+// redraw the line after the screen width changed
+static void shell_reflow_line(shellObject_t *pshell, uint16_t old_ncols)
+{
+    uint16_t end = shell_prompt_len(pshell) + pshell->line_pos;
+
+    /* it holds on one row before and after, nothing moved */
+    if ((end < old_ncols) && (end < pshell->vt->ncols)) return;
+
+    SHELL_TRACE_BEGIN(pshell, SHELL_TRACE_REFLOW, pshell->vt->ncols);
+
+    shell_erase_line(pshell, old_ncols);
+    shell_redraw_line(pshell);
+
+    SHELL_TRACE_END(pshell, SHELL_TRACE_REFLOW, pshell->vt->ncols);
+}
+
+
+//*****************************************************************************
+// print line[from..to), the colour is sent only when the class changes and
+// a blank takes the colour in use
+static void shell_print_line(shellObject_t *pshell, uint16_t from, uint16_t to)
+{
+#if SHELL_CFG_HIGHLIGHT
+    const char *line = pshell->line;
+    const uint8_t *hl = pshell->hl;
+    uint16_t start;
+
+    if (!pshell->highlight) {
+        shellWrite(pshell, &line[from], to - from);
+        return;
+    }
+
+    while (from < to) {
+        start = from;
+
+        if ((line[from] != ' ') && (hl[from] != pshell->hl_sgr)) {
+            shellPuts(pshell, vtSetColour(pshell->vt, VT_CMD_COL_FOREGROUND, shell_hl_colour[hl[from]]));
+            pshell->hl_sgr = hl[from];
         }
 
-        pshell->line_pos++;
-        pshell->line_cur++;
+        while ((from < to) && ((line[from] == ' ') || (hl[from] == pshell->hl_sgr))) from++;
+
+        shellWrite(pshell, &line[start], from - start);
+    }
+#else
+    shellWrite(pshell, &pshell->line[from], to - from);
+#endif
+}
+
+
+//*****************************************************************************
+// the colour is kept while the line is edited, anything else is printed
+// with the default one
+static inline void shell_hl_plain(shellObject_t *pshell)
+{
+#if SHELL_CFG_HIGHLIGHT
+    if (pshell->hl_sgr == SHELL_HL_NONE) return;
+
+    shellPuts(pshell, vtSetColour(pshell->vt, VT_CMD_COL_FOREGROUND, VT_COL_DEFAULT));
+    pshell->hl_sgr = SHELL_HL_NONE;
+#else
+    (void) pshell;
+#endif
+}
+
+
+//*****************************************************************************
+// line[at..at+len) is new and the tail after it moved by shift. The tokens
+// around are classed again, return where the print starts: at, or before
+// when a token on the left changed its colour.
+static uint16_t shell_hl_edit(shellObject_t *pshell, uint16_t at, uint16_t len, int16_t shift)
+{
+#if SHELL_CFG_HIGHLIGHT
+    uint16_t tail = pshell->line_pos - (at + len);
+    uint16_t changed;
+
+    if (!pshell->highlight) return at;
+
+    if (shift) memmove(&pshell->hl[at + len], &pshell->hl[at + len - shift], tail);
+    memset(&pshell->hl[at], SHELL_HL_NEW, len);
+
+    changed = shell_hl_lex(pshell, at, at + len);
+
+    return (changed < at) ? changed : at;
+#else
+    (void) pshell;
+    (void) len;
+    (void) shift;
+
+    return at;
+#endif
+}
+
+
+#if SHELL_CFG_HIGHLIGHT
+//*****************************************************************************
+// class of the token line[start..end), first for the command name. The
+// last token can still become a command, it's red only once left.
+static uint8_t shell_hl_token(shellObject_t *pshell, uint16_t start, uint16_t end, bool first)
+{
+    const char *tok = &pshell->line[start];
+    uint16_t len = end - start;
+    bool prefix = false;
+    uint16_t i;
+
+    if (!first) return (tok[0] == '-') ? SHELL_HL_OPTION : SHELL_HL_NONE;
+
+    /* the application finds its commands itself */
+    if (pshell->cmds == NULL) return SHELL_HL_NONE;
+
+    for (i = 0; i < pshell->ncmds; i++) {
+        if (strncmp(pshell->cmds[i].name, tok, len)) continue;
+        if (pshell->cmds[i].name[len] == '\0') return SHELL_HL_CMD;
+        prefix = true;
+    }
+
+    if (!strncmp(SHELL_CMD_MACHINE, tok, len)) {
+        if (SHELL_CMD_MACHINE[len] == '\0') return SHELL_HL_CMD;
+        prefix = true;
+    }
+
+#if SHELL_CFG_VARS
+    if ((pshell->vars != NULL) && !strncmp(SHELL_CMD_SET, tok, len)) {
+        if (SHELL_CMD_SET[len] == '\0') return SHELL_HL_CMD;
+        prefix = true;
+    }
+#endif
+
+    return (prefix && (end == pshell->line_pos)) ? SHELL_HL_NONE : SHELL_HL_UNKNOWN;
+}
+
+
+//*****************************************************************************
+// class again the whole tokens over line[from..to), and the next one when
+// the command name is among them. Return the first position whose class
+// changed, line_pos if none did.
+static uint16_t shell_hl_lex(shellObject_t *pshell, uint16_t from, uint16_t to)
+{
+    const char *line = pshell->line;
+    uint16_t end = pshell->line_pos;
+    uint16_t changed = end;
+    uint16_t i, start;
+    uint8_t cls;
+    bool first;
+
+    if (to > end) to = end;
+
+    while (from && (line[from - 1] != ' ')) from--;
+    while ((to < end) && (line[to] != ' ')) to++;
+
+    for (i = 0; (i < from) && (line[i] == ' '); i++) {}
+    first = (i == from);
+
+    /* the next token becomes the command name, or stops being it */
+    if (first) {
+        while ((to < end) && (line[to] == ' ')) to++;
+        while ((to < end) && (line[to] != ' ')) to++;
+    }
+
+    for (i = from; i < to; ) {
+        start = i;
+
+        if (line[i] == ' ') {
+            cls = SHELL_HL_NONE;
+            i++;
+        }
+        else {
+            while ((i < to) && (line[i] != ' ')) i++;
+            cls = shell_hl_token(pshell, start, i, first);
+            first = false;
+        }
+
+        for (; start < i; start++) {
+            if (pshell->hl[start] == cls) continue;
+            if (start < changed) changed = start;
+            pshell->hl[start] = cls;
+        }
+    }
+
+    return changed;
+}
+#endif
+
+
+//*****************************************************************************
+// insert len char of text at cursor position
+static void shell_insert_text(shellObject_t *pshell, const char *text, uint16_t len)
+{
+    uint16_t plen;
+    uint16_t from;
+
+    /* it's a large line, discard what doesn't hold */
+    if (pshell->line_pos >= pshell->line_max) return;
+    if (len > pshell->line_max - pshell->line_pos) len = pshell->line_max - pshell->line_pos;
+    if (!len) return;
+
+    memmove(&pshell->line[pshell->line_cur + len],
+            &pshell->line[pshell->line_cur],
+            pshell->line_pos - pshell->line_cur);
+    memcpy(&pshell->line[pshell->line_cur], text, len);
+
+    pshell->line_pos += len;
+    pshell->line[pshell->line_pos] = 0;
+
+    if (pshell->echo){
+        plen = shell_prompt_len(pshell);
+
+        /* the token may change its colour before the cursor */
+        from = shell_hl_edit(pshell, pshell->line_cur, len, len);
+        shell_cursor_move(pshell, plen + pshell->line_cur, plen + from);
+
+        /* print the tail and move the cursor to new position */
+        shell_print_line(pshell, from, pshell->line_pos);
+        shell_cursor_after_print(pshell, plen + pshell->line_pos,
+                                 plen + pshell->line_cur + len);
     }
+
+    pshell->line_cur += len;
+}
+
+
+static inline void shell_insert_char(shellObject_t *pshell, char ch)
+{
+    shell_insert_text(pshell, &ch, 1);
 }
 
 
@@ -115,40 +460,36 @@ static void shell_insert_char(shellObject_t *pshell, char ch)
 // insert len char of text at cursor position
 static void shell_remove_char(shellObject_t *pshell)
 {
-    int i;
+    uint16_t plen;
+    uint16_t from;
 
     if(pshell->line_cur > 0) {
         pshell->line_cur--;
         pshell->line_pos--;
 
-        if (pshell->line_pos > pshell->line_cur)
-        {
-            memmove(&pshell->line[pshell->line_cur],
-                    &pshell->line[pshell->line_cur + 1],
-                    pshell->line_pos - pshell->line_cur);
-
-            pshell->line[pshell->line_pos] = 0;
+        memmove(&pshell->line[pshell->line_cur],
+                &pshell->line[pshell->line_cur + 1],
+                pshell->line_pos - pshell->line_cur);
 
-            if (pshell->echo) {
-                shellPutc(KEY_BS, pshell);
-                shellPrintf(pshell, &pshell->line[pshell->line_cur]);
-                shellPutc(' ', pshell);
-                shellPrintf(pshell , vtMoveCursor(pshell->vt, 1, VT_DELETE_CHAR));
+        pshell->line[pshell->line_pos] = 0;
 
-                /* move the cursor to the origin position */
-                for (i = pshell->line_cur; i <= pshell->line_pos; i++) {
-                    shellPutc(KEY_BS, pshell);
-                }
+        if (pshell->echo) {
+            plen = shell_prompt_len(pshell);
+            from = shell_hl_edit(pshell, pshell->line_cur, 0, -1);
+            shell_cursor_move(pshell, plen + pshell->line_cur + 1, plen + from);
 
+            if ((pshell->line_pos > pshell->line_cur) || (from < pshell->line_cur))
+            {
+                /* print the tail, blank the last char and move to the origin position */
+                shell_print_line(pshell, from, pshell->line_pos);
+                shellPutc(' ', pshell);
+                shell_cursor_after_print(pshell, plen + pshell->line_pos + 1,
+                                         plen + pshell->line_cur);
             }
-        }
-        else
-        {
-            if (pshell->echo) {
-                shellPutc(KEY_BS, pshell);
-                shellPrintf(pshell , vtMoveCursor(pshell->vt, 1, VT_DELETE_CHAR));
+            else
+            {
+                shellPuts(pshell, vtMoveCursor(pshell->vt, 1, VT_DELETE_CHAR));
             }
-            pshell->line[pshell->line_pos] = 0;
         }
     }
 }
@@ -158,16 +499,16 @@ static void shell_remove_char(shellObject_t *pshell)
 // insert len char of text at cursor position
 static void shell_move_cursor_right(shellObject_t *pshell)
 {
+    uint16_t plen;
+
     if(pshell->line_cur < pshell->line_pos){
         pshell->line_cur++;
 
         if (pshell->echo) {
-            //Move cursor down to start of line
-            if(!((pshell->line_cur + strlen(pshell->prompt)) % pshell->vt->ncols)) {
-                shellPrintf(pshell ,  vtMoveCursor(pshell->vt, 1, VT_MOVE_CUR_DOWN));
-                shellPrintf(pshell , vtMoveCursor(pshell->vt, 1, VT_MOVE_CUR_H));
-            }
-            else shellPrintf(pshell , vtMoveCursor(pshell->vt, 1, VT_MOVE_CUR_RIGHT));
+            plen = shell_prompt_len(pshell);
+
+            //Move cursor down to start of line when it wraps
+            shell_cursor_move(pshell, plen + pshell->line_cur - 1, plen + pshell->line_cur);
         }
     }
 }
@@ -177,14 +518,14 @@ static void shell_move_cursor_right(shellObject_t *pshell)
 // insert len char of text at cursor position
 static void shell_move_cursor_left(shellObject_t *pshell)
 {
+    uint16_t plen;
+
     if(pshell->line_cur > 0){
         if (pshell->echo) {
-            //Move cursor up to end of line
-            if(!((pshell->line_cur + strlen(pshell->prompt)) % pshell->vt->ncols)) {
-                shellPrintf(pshell , vtMoveCursor(pshell->vt, 1, VT_MOVE_CUR_UP));
-                shellPrintf(pshell , vtMoveCursor(pshell->vt, pshell->vt->ncols, VT_MOVE_CUR_H));
-            }
-            else shellPrintf(pshell , vtMoveCursor(pshell->vt, 1, VT_MOVE_CUR_LEFT));
+            plen = shell_prompt_len(pshell);
+
+            //Move cursor up to end of line when it wraps
+            shell_cursor_move(pshell, plen + pshell->line_cur, plen + pshell->line_cur - 1);
         }
 
         pshell->line_cur--;
@@ -193,41 +534,144 @@ static void shell_move_cursor_left(shellObject_t *pshell)
 
 
 
+//*****************************************************************************
+// open a gap at the cursor, the pasted text is written straight into it
+static void shell_paste_begin(shellObject_t *pshell)
+{
+    pshell->paste = true;
+    pshell->paste_cr = false;
+    pshell->paste_start = pshell->line_cur;
+    pshell->paste_tail = pshell->line_pos - pshell->line_cur;
+
+    memmove(&pshell->line[sizeof(pshell->line) - 1 - pshell->paste_tail],
+            &pshell->line[pshell->line_cur], pshell->paste_tail);
+}
+
+
+//*****************************************************************************
+// close the gap and draw the pasted text at once
+static void shell_paste_end(shellObject_t *pshell)
+{
+    uint16_t plen;
+    uint16_t from;
+
+    memmove(&pshell->line[pshell->line_cur],
+            &pshell->line[sizeof(pshell->line) - 1 - pshell->paste_tail],
+            pshell->paste_tail);
+
+    pshell->line_pos = pshell->line_cur + pshell->paste_tail;
+    pshell->line[pshell->line_pos] = 0;
+
+    if (pshell->echo && (pshell->line_cur != pshell->paste_start)) {
+        plen = shell_prompt_len(pshell);
+
+        from = shell_hl_edit(pshell, pshell->paste_start, pshell->line_cur - pshell->paste_start,
+                             pshell->line_cur - pshell->paste_start);
+        shell_cursor_move(pshell, plen + pshell->paste_start, plen + from);
+
+        shell_print_line(pshell, from, pshell->line_pos);
+        shell_cursor_after_print(pshell, plen + pshell->line_pos, plen + pshell->line_cur);
+    }
+
+    pshell->paste_start = pshell->line_cur;
+    pshell->paste_tail = 0;
+}
+
+
+//*****************************************************************************
+// store a pasted char, return true when a pasted line is complete
+static bool shell_paste_char(shellObject_t *pshell, int32_t ch)
+{
+    bool cr = pshell->paste_cr;
+
+    pshell->paste_cr = (ch == KEY_CR);
+
+    switch (ch) {
+        case VT_EVT_PASTE_END:
+            shell_paste_end(pshell);
+            pshell->paste = false;
+            return false;
+        case VT_EVT_SIZE:
+            /* the line is redrawn by the end of paste */
+            shellSetSize(pshell, pshell->vt->row_pos, pshell->vt->col_pos);
+            return false;
+        case KEY_LF:
+            /* second half of CR LF */
+            if (cr) return false;
+            /* fall through */
+        case KEY_CR:
+            if (pshell->paste_queue) {
+                shell_paste_end(pshell);
+
+                /* the next line starts empty */
+                pshell->paste_start = 0;
+                return true;
+            }
+            ch = ' ';
+            break;
+        case KEY_HT:
+            ch = ' ';
+            break;
+        default:
+            if ((ch > 0xFF) || !isprint(ch)) return false;
+    }
+
+    /* it's a large line, discard it */
+    if (pshell->line_cur + pshell->paste_tail < pshell->line_max) {
+        pshell->line[pshell->line_cur++] = ch;
+    }
+
+    return false;
+}
+
+
 static void shell_handle_history(shellObject_t *pshell)
 {
-   shellPrintf(pshell , vtEraseLine(pshell->vt, VT_ERASE_LINE_ALL));
-   shellPrintf(pshell , "\r");
-   shell_print_prompt(pshell);
+   SHELL_TRACE_BEGIN(pshell, SHELL_TRACE_HISTORY, pshell->history_current);
+
+   if (pshell->echo) {
+       shell_erase_line(pshell, pshell->vt->ncols);
+   }
 
    /* copy the history command */
    memcpy(pshell->line, &pshell->history[pshell->history_current][0],
           SHELL_HISTORY_CMD_SIZE);
 
-   pshell->line_cur = pshell->line_pos = strlen(pshell->line);
+   /* kept by a session with a longer line */
+   pshell->line_pos = strlen(pshell->line);
+   if (pshell->line_pos > pshell->line_max) pshell->line_pos = pshell->line_max;
+   pshell->line[pshell->line_pos] = 0;
+   pshell->line_cur = pshell->line_pos;
 
-   shellPrintf(pshell, pshell->line);
+   if (pshell->echo) {
+       shell_redraw_line(pshell);
+   }
+
+   SHELL_TRACE_END(pshell, SHELL_TRACE_HISTORY, pshell->history_current);
 }
 
 static void shell_push_history(shellObject_t *pshell)
 {
     int index;
+    int drop;
 
-    if (pshell->line_pos != 0)
+    if ((pshell->line_pos != 0) && (pshell->history_max != 0))
     {
         /* push history */
-        if (pshell->history_count >= SHELL_HISTORY_LINES)
+        if (pshell->history_count >= pshell->history_max)
         {
-            /* move history */
-            for (index = 0; index < SHELL_HISTORY_LINES - 1; index ++)
+            /* move history, a store may have loaded more than the maximum */
+            drop = pshell->history_count - pshell->history_max + 1;
+            for (index = 0; index < pshell->history_max - 1; index ++)
             {
                 memcpy(&pshell->history[index][0],
-                    &pshell->history[index + 1][0], SHELL_HISTORY_CMD_SIZE);
+                    &pshell->history[index + drop][0], SHELL_HISTORY_CMD_SIZE);
             }
             memset(&pshell->history[index][0], 0, SHELL_HISTORY_CMD_SIZE);
             memcpy(&pshell->history[index][0], pshell->line, SHELL_HISTORY_CMD_SIZE - 1);
 
             /* it's the maximum history */
-            pshell->history_count = SHELL_HISTORY_LINES;
+            pshell->history_count = pshell->history_max;
         }
         else
         {
@@ -240,6 +684,12 @@ static void shell_push_history(shellObject_t *pshell)
     }
 
     pshell->history_current = pshell->history_count;
+
+    if ((pshell->line_pos != 0) && (pshell->hist_ops != NULL)) {
+        pshell->hist_ops->push(pshell->hist_ctx, pshell->line);
+    }
+
+    SHELL_TRACE_MARK(pshell, SHELL_TRACE_HISTORY, pshell->history_count);
 }
 
 
@@ -249,15 +699,42 @@ static void shell_push_history(shellObject_t *pshell)
 static size_t shell_read(shellObject_t *pshell)
 {
     uint8_t tabnumchar;
-    int32_t ch = 0;
+    int32_t ch;
+
+    /* up to the end of the input, an escape sequence can be split */
+    for (;;) {
+        /* the window changed, ask again its size */
+        if (pshell->resize_pending) {
+            pshell->resize_pending = 0;
+            shellProbeSize(pshell);
+        }
+
+        ch = shellGetc(pshell);
+        if (ch == EOF) break;
 
-    while (ch != EOF) {
-        ch = vtProcessChar(pshell->vt, shellGetc(pshell));
+        ch = vtProcessChar(pshell->vt, ch);
 
         if (ch != EOF) {
-            if (!isprint(ch)){
+            SHELL_TRACE_MARK(pshell, SHELL_TRACE_KEY, ch);
+
+            if (pshell->paste) {
+                /* no echo until the end of the paste or the line */
+                if (shell_paste_char(pshell, ch)) {
+                    if (pshell->echo) shellPrintf(pshell, "\r\n");
+
+                    shell_push_history(pshell);
+
+                    return strlen(pshell->line);
+                }
+            }
+            else if ((ch > 0xFF) || !isprint(ch)){
                 switch(ch) {
                     case KB_UP:
+                        /* the commands of the other sessions come in when the browse starts */
+                        if ((pshell->hist_ops != NULL) && (pshell->history_current == pshell->history_count)) {
+                            pshell->hist_ops->sync(pshell->hist_ctx, pshell);
+                        }
+
                         /* prev history */
 
                         if (pshell->history_current > 0)
@@ -296,34 +773,51 @@ static size_t shell_read(shellObject_t *pshell)
                         shell_move_cursor_right(pshell);
                         break;
                     case KEY_LF:
-                        shellPutc(ch, pshell);
+                        /* echoed by the terminal itself without the echo */
+                        if (pshell->echo) shellPutc(ch, pshell);
 
                         shell_push_history(pshell);
 
                         return strlen(pshell->line);
+                    case KEY_ETX:
+                        /* drop the line */
+                        shell_hl_plain(pshell);
+                        shellPrintf(pshell, "^C\r\n");
+                        shell_print_prompt(pshell);
+                        break;
                     case KEY_FF:
-                        shellPrintf(pshell , vtSetCursor(pshell->vt, 1, 1));
-                        shellPrintf(pshell , vtEraseScreen(pshell->vt, VT_ERASE_SCREEN_ALL));
+#if SHELL_CFG_STATUS
+                        if (pshell->status != NULL) {
+                            shellStatusScreen(pshell, true);
+                            return 0;
+                        }
+#endif
+                        shellPuts(pshell, vtSetCursor(pshell->vt, 1, 1));
+                        shellPuts(pshell, vtEraseScreen(pshell->vt, VT_ERASE_SCREEN_ALL));
                         return 0;
                     case KEY_CR:
-                        shellPutc(ch, pshell);
+                        if (pshell->echo) shellPutc(ch, pshell);
                         break;
                     case KEY_DEL:
                     case KEY_BS:
                         shell_remove_char(pshell);
                         break;
                     case KEY_HT:
-                        if (pshell->echo) {
-                            tabnumchar = pshell->vt->col_pos % SHELL_NUM_TAB;
-                            if(!tabnumchar) tabnumchar = SHELL_NUM_TAB;
-                            shellPrintf(pshell , vtMoveCursor(pshell->vt, tabnumchar, VT_MOVE_CUR_RIGHT));
-                        }
+                        /* blanks up to the next stop, the screen and the line stay the same */
+                        tabnumchar = SHELL_NUM_TAB - (pshell->line_cur % SHELL_NUM_TAB);
+                        shell_insert_text(pshell, "        ", tabnumchar);
                         break;
                     case KEY_VT:
                         if (pshell->echo) {
-                            shellPrintf(pshell , vtMoveCursor(pshell->vt, 1, VT_MOVE_CUR_DOWN));
+                            shellPuts(pshell, vtMoveCursor(pshell->vt, 1, VT_MOVE_CUR_DOWN));
                         }
                         break;
+                    case VT_EVT_SIZE:
+                        shellSetSize(pshell, pshell->vt->row_pos, pshell->vt->col_pos);
+                        break;
+                    case VT_EVT_PASTE_BEGIN:
+                        shell_paste_begin(pshell);
+                        break;
                 }
             }
             else {
@@ -349,107 +843,1129 @@ static size_t shell_read(shellObject_t *pshell)
 
 
 
-/******************************************************************************/
-//Public Function
-shellObject_t *shellOpen(FILE *out, FILE *in, const char *prompt, shell_ops_t *ops)
+/* A command is running, only Ctrl-C is taken */
+static void shell_read_busy(shellObject_t *pshell)
 {
-    shellObject_t  *pshell;
-    vt100_t *pvt100;
+    int32_t ch;
 
-    //Create Instance of Shell Object
-    pshell = (shellObject_t *) malloc(sizeof(shellObject_t));
-    if (pshell == NULL) return NULL;
+    while ((ch = shellGetc(pshell)) != EOF) {
+        if (vtProcessChar(pshell->vt, ch) == KEY_ETX) {
+            shellPrintf(pshell, "^C\r\n");
+            pshell->intr = 1;
+        }
+    }
+}
 
-    pvt100 = (vt100_t *) malloc(sizeof(vt100_t));
-    if (pvt100 == NULL) return NULL;
 
 
-    //Set to 0 memory shell
-    memset(pshell, 0, sizeof(shellObject_t));
 
 
 
-    //Set prompt name
-    pshell->prompt = prompt;
 
-    //Set Default Echo
-    pshell->echo = SHELL_DEFAULT_ECHO;
 
-    pshell->in = in;
-    pshell->out = out;
-    pshell->vt = pvt100;
 
-    pshell->ops = ops;
 
-    return pshell;
-}
 
 
-s_err_t shellInit(shellObject_t *pshell, bool echo)
+
+
+//*****************************************************************************
+// rows of the screen where the output scrolls
+static uint16_t shell_rows(shellObject_t *pshell)
 {
-    pshell->echo = echo;
+#if SHELL_CFG_STATUS
+    return shellStatusRows(pshell);
+#else
+    return pshell->vt->nrows;
+#endif
+}
 
-    shellPrintf(pshell , vtResizeScreen(pshell->vt,
-                SHELL_DEFAULT_NROWS, SHELL_DEFAULT_NCOLS));    //Resize Screen
-    shellPrintf(pshell , vtChangeModeAttr(pshell->vt,
-                VT_MODE_SRM, VT_CMD_MODE_SET));                //Local Echo OFF
-    shellPrintf(pshell , vtChangeModeAttr(pshell->vt ,
-                VT_MODE_LNM, VT_CMD_MODE_SET));               //Line Feed CRLF
 
-    if (pshell->ops != NULL) {
-        pshell->ops->start_shell();
+//*****************************************************************************
+// pull the next lines, the generator isn't called again once it ended
+static void shell_page_lines(shellObject_t *pshell, uint16_t nlines)
+{
+    /* over the --More-- prompt */
+    shellPrintf(pshell, "\r%s", vtEraseLine(pshell->vt, VT_ERASE_LINE_END));
+
+    while (nlines--) {
+        if (!pshell->page(pshell, pshell->page_ctx)) {
+            pshell->page = NULL;
+            pshell->state = SHELL_STATE_RX_CMD;
+            return;
+        }
     }
 
-    shell_print_prompt(pshell);
+    shellPrintf(pshell, "--More--");
+}
 
-    shellPrintf(pshell , vtInvokeCursor(pshell->vt));
 
+//*****************************************************************************
+// space for a page, enter for a line, q or Ctrl-C to quit
+static void shell_read_pager(shellObject_t *pshell)
+{
+    uint16_t nrows = shell_rows(pshell);
+    int32_t ch;
 
-    return SYS_EOK;
+    while ((pshell->state == SHELL_STATE_PAGER) && ((ch = shellGetc(pshell)) != EOF)) {
+        switch (vtProcessChar(pshell->vt, ch)) {
+            case ' ':
+                shell_page_lines(pshell, (nrows > 1) ? (nrows - 1) : 1);
+                break;
+            case KEY_LF:
+                shell_page_lines(pshell, 1);
+                break;
+            case 'q':
+            case 'Q':
+            case KEY_ETX:
+                shellPrintf(pshell, "\r%s", vtEraseLine(pshell->vt, VT_ERASE_LINE_END));
+                pshell->page = NULL;
+                pshell->state = SHELL_STATE_RX_CMD;
+                break;
+            default:
+                break;
+        }
+    }
 }
 
 
-s_err_t shellClose(shellObject_t *pshell)
+//*****************************************************************************
+// the output is kept in the buffer until shell_release()
+static inline void shell_hold(shellObject_t *pshell)
 {
-    shellPrintf(pshell , vtEraseScreen(pshell->vt, VT_ERASE_SCREEN_ALL));
+    pshell->hold++;
+}
 
-    free(pshell->vt);
-    free(pshell);
 
-    return SYS_EOK;
+static inline void shell_release(shellObject_t *pshell)
+{
+    if (!--pshell->hold) shellFlush(pshell);
 }
 
 
-void shellPrintf(shellObject_t *pshell, const char *fmt, ...)
+//*****************************************************************************
+// a backend taking nothing is given SHELL_OUT_STALL_MS, tried each ms where
+// there is a clock. False once it's over, and at once for a backend which
+// stalled and took nothing since.
+static bool shell_out_stall(shellObject_t *pshell, uint32_t *waited)
 {
-    va_list args;
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ms = { 0, 1000000 };
+#endif
+
+    if (pshell->out_stalled || (*waited >= SHELL_OUT_STALL_MS)) {
+        pshell->out_stalled = true;
+        return false;
+    }
+    (*waited)++;
+
+#if defined(CLOCK_MONOTONIC)
+    nanosleep(&ms, NULL);
+#endif
+
+    return true;
+}
+
+
+//*****************************************************************************
+// make room in the output buffer, false if len never holds in it. A full
+// backend is waited, only a closed or stalled one loses the buffer, counted
+// in out_lost.
+static bool shell_out_room(shellObject_t *pshell, size_t len)
+{
+    uint32_t waited = 0;
+    uint16_t before;
+
+    if (len > sizeof(pshell->out_buf)) return false;
+
+    while (sizeof(pshell->out_buf) - pshell->out_len < len) {
+        before = pshell->out_len;
+
+        if (shellFlush(pshell) != SYS_EOK) {
+            waited = SHELL_OUT_STALL_MS;
+        }
+        else if (pshell->out_len != before) {
+            waited = 0;
+            pshell->out_stalled = false;
+            continue;
+        }
+
+        if (!shell_out_stall(pshell, &waited)) {
+            pshell->out_lost += pshell->out_len;
+            pshell->out_len = 0;
+#if SHELL_CFG_SCROLLBACK
+            pshell->out_saved = 0;
+#endif
+        }
+    }
+
+    return true;
+}
+
+
+//*****************************************************************************
+// append to the output buffer, whatever the mode
+static void shell_out_raw(shellObject_t *pshell, const void *data, size_t len)
+{
+    const uint8_t *src = (const uint8_t *) data;
+    size_t n;
+
+    while (len) {
+        shell_out_room(pshell, 1);
+
+        n = sizeof(pshell->out_buf) - pshell->out_len;
+        if (n > len) n = len;
+
+        memcpy(&pshell->out_buf[pshell->out_len], src, n);
+        pshell->out_len += n;
+        src += n;
+        len -= n;
+    }
+}
+
+
+//*****************************************************************************
+// writer of shellPrintf(), the pieces go in the output buffer where they fit
+static void shell_fmt_put(void *ctx, const char *data, size_t len)
+{
+    shellObject_t *pshell = (shellObject_t *) ctx;
+
+    if (!pshell->machine && (len <= sizeof(pshell->out_buf) - pshell->out_len)) {
+        memcpy(&pshell->out_buf[pshell->out_len], data, len);
+        pshell->out_len += len;
+        return;
+    }
+
+    shellWrite(pshell, data, len);
+}
+
+
+#if defined(CLOCK_MONOTONIC)
+//*****************************************************************************
+static inline uint64_t shell_out_clock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+#endif
+
+
+//*****************************************************************************
+// the next output is of another class, the queue keeps it apart
+static inline void shell_out_kind(shellObject_t *pshell, uint8_t kind)
+{
+    shell_outq_t *q = &pshell->outq;
+
+    shell_out_save(pshell);
+
+    if (q->buf != NULL) {
+        if (pshell->out_len) shellFlush(pshell);
+
+        /* the async text expects the line drawn */
+        if ((kind == SHELL_OUT_ASYNC) && q->redraw && !q->drawing) shell_outq_redraw(pshell);
+    }
+
+    pshell->out_kind = kind;
+    pshell->out_from = shell_prompt_len(pshell) + pshell->line_cur;
+}
+
+
+//*****************************************************************************
+// the output not saved yet goes in the scrollback, but the echo
+static inline void shell_out_save(shellObject_t *pshell)
+{
+#if SHELL_CFG_SCROLLBACK
+    if ((pshell->scrollback != NULL) && !pshell->machine && (pshell->out_kind != SHELL_OUT_EDIT)) {
+        shellScrollbackWrite(pshell->scrollback, &pshell->out_buf[pshell->out_saved],
+                             pshell->out_len - pshell->out_saved);
+    }
+    pshell->out_saved = pshell->out_len;
+#else
+    (void) pshell;
+#endif
+}
+
+
+//*****************************************************************************
+// the output of the session goes through a pipeline
+static inline bool shell_piping(shellObject_t *pshell)
+{
+#if SHELL_CFG_PIPE
+    return (pshell->pipe != NULL) && pshell->pipe->active;
+#else
+    (void) pshell;
+
+    return false;
+#endif
+}
+
+
+//*****************************************************************************
+// take count chunks out of the queue from first, return their bytes
+static uint32_t shell_outq_remove(shell_outq_t *q, uint8_t first, uint8_t count)
+{
+    uint32_t off = 0, len = 0;
+    uint8_t i;
+
+    for (i = 0; i < first; i++) off += q->seg[i].len;
+    for (i = first; i < first + count; i++) len += q->seg[i].len;
+
+    memmove(&q->buf[off], &q->buf[off + len], q->len - off - len);
+    q->len -= len;
+
+    memmove(&q->seg[first], &q->seg[first + count], (q->nseg - first - count) * sizeof(q->seg[0]));
+    q->nseg -= count;
+
+    return len;
+}
+
+
+//*****************************************************************************
+// write what the backend takes now, a client which takes nothing for the
+// timeout is disconnected
+static void shell_outq_drain(shellObject_t *pshell)
+{
+    shell_outq_t *q = &pshell->outq;
+    uint64_t now;
+    int32_t n;
+
+    while (q->len) {
+        SHELL_TRACE_BEGIN(pshell, SHELL_TRACE_FLUSH, q->len);
+        n = pshell->io->write(pshell->io_ctx, q->buf, q->len);
+        SHELL_TRACE_END(pshell, SHELL_TRACE_FLUSH, n);
+
+        if (n < 0) {
+            /* the connection is gone */
+            q->dropped += q->len;
+            q->len = 0;
+            q->nseg = 0;
+            q->closed = true;
+            return;
+        }
+
+        if (!n) {
+            now = SHELL_OUT_CLOCK();
+            if (!q->stalled) {
+                q->stalled = true;
+                q->stall_ms = now;
+            }
+            else if ((q->policy & SHELL_OUT_DISCONNECT) && (now - q->stall_ms >= q->timeout_ms)) {
+                q->dropped += q->len;
+                q->len = 0;
+                q->nseg = 0;
+                q->closed = true;
+                pshell->eof = true;
+            }
+            return;
+        }
+
+        q->stalled = false;
+
+        /* the chunks written, the first one can be cut */
+        while (n && q->nseg && ((uint32_t) n >= q->seg[0].len)) {
+            n -= q->seg[0].len;
+            q->len -= q->seg[0].len;
+            memmove(q->buf, &q->buf[q->seg[0].len], q->len);
+            memmove(&q->seg[0], &q->seg[1], --q->nseg * sizeof(q->seg[0]));
+            q->started = false;
+        }
+        if (n) {
+            q->seg[0].len -= n;
+            q->len -= n;
+            memmove(q->buf, &q->buf[n], q->len);
+            q->started = true;
+        }
+    }
+
+    q->stalled = false;
+}
+
+
+//*****************************************************************************
+// the echo queued at the end and the new one are dropped, the line is
+// drawn again from where the terminal is once the call is over
+static bool shell_outq_coalesce(shellObject_t *pshell, uint32_t len)
+{
+    shell_outq_t *q = &pshell->outq;
+    uint8_t first = q->nseg;
+    uint16_t from;
+
+    if (!(q->policy & SHELL_OUT_COALESCE) || (pshell->out_kind != SHELL_OUT_EDIT)) return false;
+
+    while (first && (q->seg[first - 1].kind == SHELL_OUT_EDIT) && !((first == 1) && q->started)) first--;
+
+    if (first < q->nseg) {
+        from = q->seg[first].from;
+    }
+    else {
+        /* the call writing now is partly written, where it ends isn't known */
+        if (q->nseg && q->seg[q->nseg - 1].open) return false;
+        from = pshell->out_from;
+    }
+
+    q->coalesced += shell_outq_remove(q, first, q->nseg - first) + len;
+    q->redraw = true;
+    q->redraw_from = from;
+
+    return true;
+}
+
+
+//*****************************************************************************
+// queue the output, the policies make room when it's full
+static void shell_outq_put(shellObject_t *pshell, const uint8_t *data, uint32_t len)
+{
+    shell_outq_t *q = &pshell->outq;
+    struct shell_out_seg *tail;
+    uint8_t i;
+
+    if (q->closed) {
+        q->dropped += len;
+        return;
+    }
+
+    /* the redraw will show it */
+    if (q->redraw && !q->drawing && (pshell->out_kind == SHELL_OUT_EDIT)) {
+        q->coalesced += len;
+        return;
+    }
+
+    shell_outq_drain(pshell);
+    if (q->closed) {
+        q->dropped += len;
+        return;
+    }
+
+    if (q->size - q->len < len) {
+        if (shell_outq_coalesce(pshell, len)) return;
+
+        if (q->policy & SHELL_OUT_DROP_ASYNC) {
+            for (i = q->started ? 1 : 0; (i < q->nseg) && (q->size - q->len < len); ) {
+                if ((q->seg[i].kind == SHELL_OUT_ASYNC) && !q->seg[i].open) q->dropped += shell_outq_remove(q, i, 1);
+                else i++;
+            }
+        }
+
+        if (q->size - q->len < len) {
+            q->dropped += len;
+
+            /* the screen isn't known any more, a new line and the line again */
+            if (pshell->echo && (pshell->state == SHELL_STATE_READY) && (pshell->out_kind != SHELL_OUT_ASYNC)) {
+                q->redraw = true;
+                q->redraw_from = SHELL_OUT_LOST;
+            }
+            return;
+        }
+    }
+
+    tail = q->nseg ? &q->seg[q->nseg - 1] : NULL;
+
+    if ((tail != NULL) && tail->open && (tail->kind == pshell->out_kind)) {
+        tail->len += len;
+    }
+    else if (q->nseg == SHELL_OUT_SEGMENTS) {
+        /* no chunk left, it's kept with the last one, which begins where it did */
+        if (tail->kind != pshell->out_kind) tail->kind = SHELL_OUT_DATA;
+        tail->len += len;
+        tail->open = true;
+    }
+    else {
+        tail = &q->seg[q->nseg++];
+        tail->len = len;
+        tail->from = pshell->out_from;
+        tail->kind = pshell->out_kind;
+        tail->open = true;
+    }
+
+    memcpy(&q->buf[q->len], data, len);
+    q->len += len;
+    if (q->len > q->high_water) q->high_water = q->len;
+}
+
+
+//*****************************************************************************
+// one redraw in place of the echo dropped, from where the terminal is.
+// Called at the end of an engine call, the line is as the user sees it.
+static void shell_outq_redraw(shellObject_t *pshell)
+{
+    shell_outq_t *q = &pshell->outq;
+    uint8_t kind = pshell->out_kind;
+    uint16_t rows, cur;
+
+    q->redraw = false;
+    q->drawing = true;
+    pshell->hold++;
+
+    pshell->out_kind = SHELL_OUT_EDIT;
+    pshell->out_from = q->redraw_from;
+
+    if (q->redraw_from == SHELL_OUT_LOST) {
+        shellPrintf(pshell, "\r\n");
+    }
+    else {
+        rows = q->redraw_from / pshell->vt->ncols;
+        if (rows) shellPuts(pshell, vtMoveCursor(pshell->vt, rows, VT_MOVE_CUR_UP));
+        shellPrintf(pshell, "\r");
+    }
+    shellPuts(pshell, vtEraseScreen(pshell->vt, VT_ERASE_SCREEN_DOWN));
+
+    if (pshell->echo && (pshell->state == SHELL_STATE_READY)) {
+        shell_redraw_line(pshell);
+    }
+    else if (pshell->echo && (pshell->state == SHELL_STATE_RX_CMD)) {
+        /* the line ended in the call, it's shown as entered */
+        cur = pshell->line_cur;
+        pshell->line_cur = pshell->line_pos;
+        shell_redraw_line(pshell);
+        pshell->line_cur = cur;
+        shell_hl_plain(pshell);
+        shellPrintf(pshell, "\r\n");
+    }
+
+    /* queued as echo, a next redraw can replace it */
+    if (pshell->out_len) shellFlush(pshell);
+
+    pshell->out_kind = kind;
+    q->drawing = false;
+
+    if (!--pshell->hold) shellFlush(pshell);
+}
+
+
+//*****************************************************************************
+// escape for a JSON string as it's written, the plain runs are copied at once
+static void shell_json_write(shellObject_t *pshell, const uint8_t *src, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    char esc[6] = { '\\' };
+    size_t esc_len;
+    size_t run;
+
+    while (len) {
+        for (run = 0; run < len; run++) {
+            if ((src[run] < ' ') || (src[run] == '"') || (src[run] == '\\') || (src[run] == KEY_DEL)) break;
+        }
+
+        shell_out_raw(pshell, src, run);
+        if (run == len) break;
+
+        esc_len = 2;
+        switch (src[run]) {
+            case '"':
+            case '\\':    esc[1] = src[run]; break;
+            case KEY_LF:  esc[1] = 'n'; break;
+            case KEY_CR:  esc[1] = 'r'; break;
+            case KEY_HT:  esc[1] = 't'; break;
+            default:
+                memcpy(&esc[1], "u00", 3);
+                esc[4] = hex[src[run] >> 4];
+                esc[5] = hex[src[run] & 0x0F];
+                esc_len = 6;
+        }
+        shell_out_raw(pshell, esc, esc_len);
+
+        src += run + 1;
+        len -= run + 1;
+    }
+}
+
+
+//*****************************************************************************
+// a command record is {"seq":N,"out":"...","status":S}, the out string is
+// streamed while the command runs. Other output is {"out":"..."}.
+static void shell_record_begin(shellObject_t *pshell, bool cmd)
+{
+    char head[32];
+    int len;
+
+    if (cmd) len = snprintf(head, sizeof(head), "{\"seq\":%lu,\"out\":\"", (unsigned long) ++pshell->seq);
+    else len = snprintf(head, sizeof(head), "{\"out\":\"");
+
+    shell_out_raw(pshell, head, len);
+    pshell->record = true;
+}
+
+
+static void shell_record_end(shellObject_t *pshell, bool cmd, int32_t status)
+{
+    char tail[32];
+    int len;
+
+    if (cmd) len = snprintf(tail, sizeof(tail), "\",\"status\":%ld}\n", (long) status);
+    else len = snprintf(tail, sizeof(tail), "\"}\n");
+
+    shell_out_raw(pshell, tail, len);
+    pshell->record = false;
+
+    if (!pshell->hold) shellFlush(pshell);
+}
+
+
+//*****************************************************************************
+// built-in, when no command of the table has the name
+static int32_t shell_cmd_machine(shellObject_t *pshell, int32_t argc, char *argv[])
+{
+    shellSetMachine(pshell, (argc < 2) || strcmp(argv[1], "off"));
+
+    return SYS_EOK;
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+shellObject_t *shellOpen(FILE *out, FILE *in, const char *prompt, shell_ops_t *ops)
+{
+    shellObject_t  *pshell;
+
+    pshell = shellOpenIo(&shell_io_file, NULL, prompt, ops);
+    if (pshell == NULL) return NULL;
+
+    //The FILE context is part of the object
+    pshell->file.in = in;
+    pshell->file.out = out;
+    pshell->io_ctx = &pshell->file;
+
+    return pshell;
+}
+
+
+shellObject_t *shellOpenIo(const shell_io_t *io, void *ctx, const char *prompt, shell_ops_t *ops)
+{
+    shellObject_t  *pshell;
+    vt100_t *pvt100;
+
+    //Create Instance of Shell Object
+    pshell = (shellObject_t *) malloc(sizeof(shellObject_t));
+    if (pshell == NULL) return NULL;
+
+    pvt100 = (vt100_t *) malloc(sizeof(vt100_t));
+    if (pvt100 == NULL) {
+        free(pshell);
+        return NULL;
+    }
+
+
+    //Set to 0 memory shell
+    memset(pshell, 0, sizeof(shellObject_t));
+
+    //Default size until the terminal answers the probe
+    vtInit(pvt100, SHELL_DEFAULT_NROWS, SHELL_DEFAULT_NCOLS);
+
+
+
+    //Set prompt name
+    pshell->prompt = prompt;
+    pshell->prompt_len = strlen(prompt);
+
+    pshell->line_max = sizeof(pshell->line) - 1;
+    pshell->history_max = SHELL_HISTORY_LINES;
+
+    //Set Default Echo
+    pshell->echo = SHELL_DEFAULT_ECHO;
+    pshell->paste_queue = SHELL_DEFAULT_PASTE_QUEUE;
+#if SHELL_CFG_HIGHLIGHT
+    pshell->highlight = SHELL_DEFAULT_HIGHLIGHT;
+#endif
+    shellSetMachine(pshell, SHELL_DEFAULT_MACHINE);
+
+    pshell->io = io;
+    pshell->io_ctx = ctx;
+    pshell->vt = pvt100;
+
+    pshell->ops = ops;
+
+    return pshell;
+}
+
+
+//*****************************************************************************
+// Set up the terminal and print the prompt. Without the echo the terminal
+// shows what is typed itself, the end of line included: nothing of the
+// line, CR and LF included, is written back.
+s_err_t shellInit(shellObject_t *pshell, bool echo)
+{
+    /* in machine mode the terminal setup isn't written */
+    if (pshell->machine) pshell->machine_echo = echo;
+    else pshell->echo = echo;
+
+    shell_hold(pshell);
+
+    shellPuts(pshell, vtChangeModeAttr(pshell->vt,
+                VT_MODE_SRM, VT_CMD_MODE_SET));                //Local Echo OFF
+    shellPuts(pshell, vtChangeModeAttr(pshell->vt ,
+                VT_MODE_LNM, VT_CMD_MODE_SET));               //Line Feed CRLF
+    shellPuts(pshell, vtChangeModeAttr(pshell->vt ,
+                VT_MODE_BPM, VT_CMD_MODE_SET));               //Bracketed Paste ON
+
+    if (pshell->ops != NULL) {
+        pshell->ops->start_shell();
+    }
+
+    shell_print_prompt(pshell);
+
+    shellProbeSize(pshell);                                     //Real screen size
+    shellPuts(pshell, vtInvokeCursor(pshell->vt));
+
+    shell_release(pshell);
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Ask the terminal size, it doesn't wait the reply
+s_err_t shellProbeSize(shellObject_t *pshell)
+{
+    uint16_t nrows, ncols;
+
+    /* a pty knows its size, no need to go through the terminal */
+    if ((pshell->io->winsize != NULL) &&
+        (pshell->io->winsize(pshell->io_ctx, &nrows, &ncols) == 0)) {
+        shellSetSize(pshell, nrows, ncols);
+        return SYS_EOK;
+    }
+
+    /* the cursor stops on the bottom right corner, the reply is its position */
+    shellPuts(pshell, vtSaveCursor(pshell->vt));
+    shellPuts(pshell, vtSetCursor(pshell->vt, VT_PROBE_POS, VT_PROBE_POS));
+    shellPuts(pshell, vtProbeSize(pshell->vt));
+    shellPuts(pshell, vtRestoreCursor(pshell->vt));
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Change the prompt, it's shown from the next line
+void shellSetPrompt(shellObject_t *pshell, const char *prompt)
+{
+    pshell->prompt = prompt;
+    pshell->prompt_len = strlen(prompt);
+}
+
+
+//*****************************************************************************
+// Run each line of a multi-line paste as a command instead of joining them
+void shellSetPasteQueue(shellObject_t *pshell, bool queue)
+{
+    pshell->paste_queue = queue;
+}
+
+
+//*****************************************************************************
+// Shorter line or history than the buffers of the session, 0 lines for no
+// history. Applied from the next edit.
+void shellSetLimits(shellObject_t *pshell, uint16_t line_max, uint16_t history_max)
+{
+    if (!line_max || (line_max > sizeof(pshell->line) - 1)) line_max = sizeof(pshell->line) - 1;
+    if (history_max > SHELL_HISTORY_LINES) history_max = SHELL_HISTORY_LINES;
+
+    pshell->line_max = line_max;
+    pshell->history_max = history_max;
+}
+
+
+//*****************************************************************************
+// Async signal safe, the size is probed by the next shellEngine() call
+void shellNotifyResize(shellObject_t *pshell)
+{
+    pshell->resize_pending = 1;
+}
+
+
+//*****************************************************************************
+// Set the screen size and reflow the line being edited
+void shellSetSize(shellObject_t *pshell, uint16_t nrows, uint16_t ncols)
+{
+    uint16_t old_ncols = pshell->vt->ncols;
+    uint16_t old_nrows = pshell->vt->nrows;
+
+    if (!nrows || !ncols) return;
+
+    pshell->vt->nrows = nrows;
+    pshell->vt->ncols = ncols;
+
+    /* in a paste the line is split at the cursor, its end redraws it */
+    if (pshell->echo && (pshell->state == SHELL_STATE_READY) && !pshell->paste && (old_ncols != ncols)) {
+        shell_reflow_line(pshell, old_ncols);
+    }
+
+#if SHELL_CFG_STATUS
+    /* the region follows the last row */
+    if ((old_nrows != nrows) || (old_ncols != ncols)) shellStatusScreen(pshell, false);
+#else
+    (void) old_nrows;
+#endif
+}
+
+
+s_err_t shellClose(shellObject_t *pshell)
+{
+#if SHELL_CFG_STATUS
+    shellStatusClose(pshell);
+#endif
+    shell_hl_plain(pshell);
+    shellPuts(pshell, vtChangeModeAttr(pshell->vt ,
+                VT_MODE_BPM, VT_CMD_MODE_RESET));             //Bracketed Paste OFF
+    shellPuts(pshell, vtEraseScreen(pshell->vt, VT_ERASE_SCREEN_ALL));
+    shellFlush(pshell);
+
+#if SHELL_CFG_TRACE
+    shellTraceClose(pshell);
+#endif
+    free(pshell->vt);
+    free(pshell);
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Formatted output, see shell_fmt.h for the conversions
+void shellPrintf(shellObject_t *pshell, const char *fmt, ...)
+{
+    va_list args;
+
+    /* out of a record the machine mode writes nothing */
+    if (pshell->machine && !pshell->record) return;
+
     va_start(args, fmt);
+    shell_hold(pshell);
+    shellFormat(shell_fmt_put, pshell, fmt, args);
+    shell_release(pshell);
+    va_end(args);
+}
+
+
+//*****************************************************************************
+// Write a string as it is, a '%' is no conversion
+void shellPuts(shellObject_t *pshell, const char *text)
+{
+    shellWrite(pshell, text, strlen(text));
+}
+
+
+//*****************************************************************************
+// Write bytes as they are
+int32_t shellWrite(shellObject_t *pshell, const void *data, size_t len)
+{
+    const uint8_t *src = (const uint8_t *) data;
+
+    if (pshell->machine) {
+#if SHELL_CFG_PIPE
+        /* filtered before it's framed */
+        if (shell_piping(pshell)) {
+            shellPipeFeed(pshell->pipe, src, len);
+            return len;
+        }
+#endif
+        if (pshell->record) shell_json_write(pshell, src, len);
+        if (!pshell->hold) shellFlush(pshell);
+        return len;
+    }
+
+    if (shell_out_room(pshell, len)) {
+        memcpy(&pshell->out_buf[pshell->out_len], src, len);
+        pshell->out_len += len;
+    }
+    else if (pshell->outq.buf != NULL) {
+        shell_out_raw(pshell, src, len);
+    }
+    else {
+        /* larger than the buffer, it goes straight to the backend */
+        return shellWriteDirect(pshell, src, len);
+    }
+
+    if (!pshell->hold) shellFlush(pshell);
+
+    return len;
+}
+
+
+//*****************************************************************************
+// Write bytes past the output buffer, what it holds goes first. In
+// machine mode they're framed as by shellWrite(). A full backend is
+// waited, return the bytes taken: less than len once it stalled
+// SHELL_OUT_STALL_MS, the rest is counted in out_lost.
+int32_t shellWriteDirect(shellObject_t *pshell, const void *data, size_t len)
+{
+    const uint8_t *src = (const uint8_t *) data;
+    size_t count = len;
+    uint32_t waited = 0;
+    int32_t n;
+
+    if (pshell->machine) return shellWrite(pshell, data, len);
+
+    /* the buffer first, the order is kept */
+    if (pshell->out_len && !shell_out_room(pshell, sizeof(pshell->out_buf))) return SYS_EIO;
+    if (shellFlush(pshell) != SYS_EOK) return SYS_EIO;
+
+#if SHELL_CFG_PIPE
+    if (shell_piping(pshell)) {
+        shellPipeFeed(pshell->pipe, src, len);
+        return len;
+    }
+#endif
+
+#if SHELL_CFG_SCROLLBACK
+    if ((pshell->scrollback != NULL) && (pshell->out_kind != SHELL_OUT_EDIT)) {
+        shellScrollbackWrite(pshell->scrollback, src, count);
+    }
+#endif
+
+    /* the queue takes it as it is */
+    if (pshell->outq.buf != NULL) {
+        shell_outq_put(pshell, src, len);
+        shellFlush(pshell);
+        return len;
+    }
+
+    while (count) {
+        n = pshell->io->write(pshell->io_ctx, src, count);
+        if (n < 0) return SYS_EIO;
+
+        if (n) {
+            waited = 0;
+            pshell->out_stalled = false;
+        }
+        else if (!shell_out_stall(pshell, &waited)) {
+            pshell->out_lost += count;
+            break;
+        }
+
+        src += n;
+        count -= n;
+    }
+
+    return len - count;
+}
+
+
+//*****************************************************************************
+// Give the buffered output to the backend, once. What a full backend
+// doesn't take stays for the next flush.
+s_err_t shellFlush(shellObject_t *pshell)
+{
+    shell_outq_t *q = &pshell->outq;
+    int32_t n;
+
+#if SHELL_CFG_PIPE
+    /* the output of the command goes to the first filter, where it is */
+    if (shell_piping(pshell) && !pshell->machine && pshell->out_len) {
+        n = pshell->out_len;
+        pshell->out_len = 0;
+#if SHELL_CFG_SCROLLBACK
+        pshell->out_saved = 0;
+#endif
+        shellPipeFeed(pshell->pipe, pshell->out_buf, n);
+        return SYS_EOK;
+    }
+#endif
+
+    shell_out_save(pshell);
+
+    /* the backend never blocks, the queue takes the output */
+    if (q->buf != NULL) {
+        if (pshell->out_len) {
+            shell_outq_put(pshell, pshell->out_buf, pshell->out_len);
+            pshell->out_len = 0;
+#if SHELL_CFG_SCROLLBACK
+            pshell->out_saved = 0;
+#endif
+        }
 
-    vfprintf(pshell->out, fmt, args);
+        if (!pshell->hold && q->nseg) q->seg[q->nseg - 1].open = false;
 
-    va_end(args);
+        shell_outq_drain(pshell);
+
+        return q->closed ? SYS_EIO : SYS_EOK;
+    }
+
+    if (!pshell->out_len) return SYS_EOK;
+
+    SHELL_TRACE_BEGIN(pshell, SHELL_TRACE_FLUSH, pshell->out_len);
+    n = pshell->io->write(pshell->io_ctx, pshell->out_buf, pshell->out_len);
+    SHELL_TRACE_END(pshell, SHELL_TRACE_FLUSH, n);
+    if (n < 0) return SYS_EIO;
+
+    memmove(pshell->out_buf, &pshell->out_buf[n], pshell->out_len - n);
+    pshell->out_len -= n;
+#if SHELL_CFG_SCROLLBACK
+    pshell->out_saved = pshell->out_len;
+#endif
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Change the backend, the pending output goes to the previous one
+s_err_t shellSetIo(shellObject_t *pshell, const shell_io_t *io, void *ctx)
+{
+    if (io == NULL) return SYS_ERROR;
+
+    shellFlush(pshell);
+
+    pshell->io = io;
+    pshell->io_ctx = ctx;
+    pshell->in_pos = pshell->in_len = 0;
+    pshell->eof = false;
+
+    return SYS_EOK;
 }
 
 
+int32_t shellGetc(shellObject_t *pshell)
+{
+    int32_t n;
+
+    /* bulk read from the input ring or the backend */
+    if (pshell->in_pos >= pshell->in_len) {
+        if (pshell->rx.buf != NULL) n = shellRingRead(&pshell->rx, pshell->in_buf, sizeof(pshell->in_buf));
+        else n = pshell->io->read(pshell->io_ctx, pshell->in_buf, sizeof(pshell->in_buf));
+        if (n <= 0) {
+            if (n < 0) pshell->eof = true;
+            return EOF;
+        }
+
+        pshell->in_pos = 0;
+        pshell->in_len = n;
+    }
+
+    return pshell->in_buf[pshell->in_pos++];
+}
+
 
-inline int32_t shellGetc(shellObject_t *pshell)
+//*****************************************************************************
+// Bulk read of the input, past the VT parser and the line editor. Return
+// the bytes read, 0 if none is there yet or -1 once the input is closed.
+int32_t shellRead(shellObject_t *pshell, void *buf, size_t len)
 {
-    int32_t ch;
+    int32_t n;
 
-    ch = fgetc(pshell->in);
-    clearerr(pshell->in);
+    if (!len) return 0;
 
-    if (ch == EOF){
-        return EOF;
+    /* a big read goes straight in the buffer of the caller */
+    if ((pshell->in_pos >= pshell->in_len) && (len >= sizeof(pshell->in_buf))) {
+        if (pshell->rx.buf != NULL) n = shellRingRead(&pshell->rx, (uint8_t *) buf, len);
+        else n = pshell->io->read(pshell->io_ctx, (uint8_t *) buf, len);
+        if (n < 0) pshell->eof = true;
+
+        return (n < 0) ? -1 : n;
     }
 
-    return ch;
+    if (pshell->in_pos >= pshell->in_len) {
+        if (pshell->rx.buf != NULL) n = shellRingRead(&pshell->rx, pshell->in_buf, sizeof(pshell->in_buf));
+        else n = pshell->io->read(pshell->io_ctx, pshell->in_buf, sizeof(pshell->in_buf));
+        if (n <= 0) {
+            if (n < 0) pshell->eof = true;
+            return (n < 0) ? -1 : 0;
+        }
+
+        pshell->in_pos = 0;
+        pshell->in_len = n;
+    }
+
+    n = pshell->in_len - pshell->in_pos;
+    if ((size_t) n > len) n = len;
+
+    memcpy(buf, &pshell->in_buf[pshell->in_pos], n);
+    pshell->in_pos += n;
+
+    return n;
+}
+
+
+//*****************************************************************************
+// The input comes from a ring filled by an interrupt or a reader thread,
+// the size is a power of 2
+bool shellSetInputRing(shellObject_t *pshell, uint8_t *buf, uint32_t size)
+{
+    return shellRingInit(&pshell->rx, buf, size);
+}
+
+
+//*****************************************************************************
+// The output goes through a bounded queue, the backend must not block:
+// a write returns 0 while the client doesn't read. Once full the policy
+// chooses what is lost, the output is never waited. NULL removes it,
+// what isn't written yet is dropped.
+s_err_t shellSetOutputQueue(shellObject_t *pshell, uint8_t *buf, uint32_t size, uint8_t policy, uint32_t timeout_ms)
+{
+    shell_outq_t *q = &pshell->outq;
+
+    if ((buf != NULL) && (size < SHELL_OUT_QUEUE_MIN)) return SYS_ERROR;
+
+    if (q->buf != NULL) shellFlush(pshell);
+
+    memset(q, 0, sizeof(shell_outq_t));
+    q->buf = buf;
+    q->size = size;
+    q->policy = policy;
+    q->timeout_ms = timeout_ms;
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Bytes not taken by the backend yet
+uint32_t shellOutputPending(shellObject_t *pshell)
+{
+    return pshell->out_len + pshell->outq.len;
+}
+
+
+void shellOutputStats(shellObject_t *pshell, shell_out_stats_t *stats)
+{
+    stats->queued = shellOutputPending(pshell);
+    stats->high_water = pshell->outq.high_water;
+    stats->dropped = pshell->outq.dropped + pshell->out_lost;
+    stats->coalesced = pshell->outq.coalesced;
+    stats->closed = pshell->outq.closed;
+}
+
+
+//*****************************************************************************
+// Producer side of the input ring, safe in an interrupt, return the bytes taken
+uint32_t shellFeed(shellObject_t *pshell, const uint8_t *data, uint32_t len)
+{
+    return shellRingWrite(&pshell->rx, data, len);
 }
 
 
-inline int32_t shellPutc(int32_t ch, shellObject_t *pshell)
+int32_t shellPutc(int32_t ch, shellObject_t *pshell)
 {
-    return fputc(ch, pshell->out);
+    uint8_t byte = ch;
+
+    if (pshell->machine) {
+        shellWrite(pshell, &byte, 1);
+        return ch;
+    }
+
+    if (!shell_out_room(pshell, 1)) return EOF;
+
+    pshell->out_buf[pshell->out_len++] = ch;
+
+    if (!pshell->hold) shellFlush(pshell);
+
+    return ch;
 }
 
 
@@ -457,8 +1973,12 @@ inline int32_t shellPutc(int32_t ch, shellObject_t *pshell)
 
 char *shellEngine(shellObject_t *pshell)
 {
+    char *line = NULL;
     size_t nchar;
 
+    /* one write for all the echo of this call */
+    shell_hold(pshell);
+
     switch(pshell->state){
         case SHELL_STATE_START:
             pshell->state++;
@@ -467,23 +1987,528 @@ char *shellEngine(shellObject_t *pshell)
             pshell->state++;
             break;
         case SHELL_STATE_READY:
+            shell_out_kind(pshell, SHELL_OUT_EDIT);
+            SHELL_TRACE_BEGIN(pshell, SHELL_TRACE_READ, pshell->line_pos);
             nchar = shell_read(pshell);
-            if(nchar != -1) {
+            SHELL_TRACE_END(pshell, SHELL_TRACE_READ, nchar);
+            if(nchar != (size_t) -1) {
+                /* the output of the command has the default colour */
+                shell_hl_plain(pshell);
                 pshell->state++;
-                return pshell->line;
+                line = pshell->line;
+#if SHELL_CFG_SCROLLBACK
+                /* its echo isn't kept, the line entered is */
+                if (pshell->scrollback != NULL) {
+                    shellScrollbackLine(pshell->scrollback, pshell->prompt, pshell->line,
+                                        pshell->echo ? pshell->line_pos : 0);
+                }
+#endif
             }
+            shell_out_kind(pshell, SHELL_OUT_DATA);
             break;
         case SHELL_STATE_RX_CMD:
             shell_print_prompt(pshell);
             pshell->state = SHELL_STATE_READY;
             break;
+        case SHELL_STATE_BUSY:
+            shell_read_busy(pshell);
+            break;
+        case SHELL_STATE_PAGER:
+            shell_read_pager(pshell);
+            break;
+        case SHELL_STATE_XFER:
+            pshell->raw(pshell, pshell->raw_ctx);
+            break;
         default:
             pshell->state = 0;
     }
 
+    /* the echo dropped by the output queue, drawn once as it is now */
+    if (pshell->outq.redraw && !pshell->outq.drawing) shell_outq_redraw(pshell);
+
+#if SHELL_CFG_STATUS
+    /* the status fields set since the last pass */
+    shellStatusPoll(pshell, false);
+#endif
+
+    shell_release(pshell);
+
+    return line;
+}
+
+
+
+//*****************************************************************************
+// Set the command table used by shellExec()
+s_err_t shellSetCommands(shellObject_t *pshell, const shell_cmd_t *cmds, uint16_t ncmds)
+{
+    if ((cmds == NULL) && ncmds) return SYS_ERROR;
+
+    pshell->cmds = cmds;
+    pshell->ncmds = ncmds;
+
+    return SYS_EOK;
+}
+
+
+const shell_cmd_t *shellFindCommand(shellObject_t *pshell, const char *name)
+{
+    uint16_t i;
+
+    for (i = 0; i < pshell->ncmds; i++) {
+        if (!strcmp(pshell->cmds[i].name, name)) return &pshell->cmds[i];
+    }
+
     return NULL;
 }
 
 
+//*****************************************************************************
+// Split the line in place on blanks, return the number of arguments
+int32_t shellParseArgs(char *line, char *argv[], int32_t max)
+{
+    int32_t argc = 0;
+
+    while (*line) {
+        while ((*line == ' ') || (*line == '\t')) *line++ = 0;
+        if (!*line) break;
+
+        if (argc < max) argv[argc++] = line;
+
+        while (*line && (*line != ' ') && (*line != '\t')) line++;
+    }
+
+    if (argc < max) argv[argc] = NULL;
+
+    return argc;
+}
+
+
+//*****************************************************************************
+// Run the command of the line in the caller context
+int32_t shellExec(shellObject_t *pshell, char *line)
+{
+    return shellExecWith(pshell, line, NULL, NULL);
+}
+
+
+//*****************************************************************************
+// As shellExec(), the commands of run are tried first. The line goes through
+// the same record, expansion and pipes
+int32_t shellExecWith(shellObject_t *pshell, char *line, shell_exec_func_t run, void *ctx)
+{
+    char *argv[SHELL_MAX_ARGS + 1];
+    const shell_cmd_t *cmd;
+    bool framed = pshell->machine;
+    int32_t status = SYS_EOK;
+    int32_t argc;
+#if SHELL_CFG_VARS
+    char expanded[SHELL_VARS_LINE_LEN];
+    bool was_expanded = pshell->expanded;
+#endif
+
+    /* one record per line in machine mode */
+    if (framed) shell_record_begin(pshell, true);
+
+    SHELL_TRACE_BEGIN(pshell, SHELL_TRACE_EXEC, pshell->seq);
+
+#if SHELL_CFG_VARS
+    /* the variables are replaced before the line is split */
+    if ((pshell->vars != NULL) && (strchr(line, '$') != NULL)) {
+        if (shellVarsExpand(pshell, line, expanded, sizeof(expanded)) >= 0) {
+            line = expanded;
+            pshell->expanded = true;
+        }
+        else {
+            shellPrintf(pshell, "line too long once expanded\r\n");
+            status = SYS_ERROR;
+            line[0] = 0;
+        }
+    }
+#endif
+
+    argc = shellParseArgs(line, argv, SHELL_MAX_ARGS);
+
+#if SHELL_CFG_PIPE
+    /* "| filter" and "> file" taken out, the output goes through them */
+    if (argc && (shellPipeBegin(pshell, &argc, argv) != SYS_EOK)) {
+        status = SYS_ERROR;
+        argc = 0;
+    }
+#endif
+
+    if (argc && ((run == NULL) || !run(ctx, pshell, argc, argv, &status))) {
+        cmd = shellFindCommand(pshell, argv[0]);
+
+        if (cmd != NULL) {
+            status = cmd->func(pshell, argc, argv);
+        }
+        else if (!strcmp(argv[0], SHELL_CMD_MACHINE)) {
+            status = shell_cmd_machine(pshell, argc, argv);
+        }
+#if SHELL_CFG_VARS
+        else if ((pshell->vars != NULL) && !strcmp(argv[0], SHELL_CMD_SET)) {
+            status = shellVarsCmd(pshell, argc, argv);
+        }
+#endif
+        else {
+            shellPrintf(pshell, "%s: command not found\r\n", argv[0]);
+            status = SYS_ENOSYS;
+        }
+    }
+
+#if SHELL_CFG_PIPE
+    if (shell_piping(pshell)) {
+        s_err_t err = shellPipeEnd(pshell);
+        if (status == SYS_EOK) status = err;
+    }
+#endif
+
+    SHELL_TRACE_END(pshell, SHELL_TRACE_EXEC, status);
+
+#if SHELL_CFG_VARS
+    pshell->expanded = was_expanded;
+#endif
+
+    if (framed) shell_record_end(pshell, true, status);
+
+    return status;
+}
+
+
+//*****************************************************************************
+// True while the command runs on the line with its variables replaced, the
+// arguments aren't in the line typed then
+bool shellExecExpanded(shellObject_t *pshell)
+{
+#if SHELL_CFG_VARS
+    return pshell->expanded;
+#else
+    (void) pshell;
+    return false;
+#endif
+}
+
+
+//*****************************************************************************
+// Run the lines of a script one after the other, up to the first which
+// fails. The blank lines and the ones starting by '#' are skipped.
+int32_t shellExecBatch(shellObject_t *pshell, const char *script)
+{
+    char line[SHELL_BUFFER_LINE_LEN];
+    int32_t status = SYS_EOK;
+    size_t len;
+
+    while (*script && (status == SYS_EOK)) {
+        len = strcspn(script, "\n");
+
+        if (len >= sizeof(line)) {
+            shellPrintf(pshell, "%.*s...: line too long\r\n", 16, script);
+            return SYS_ERROR;
+        }
+
+        memcpy(line, script, len);
+        line[len] = 0;
+        if (len && (line[len - 1] == '\r')) line[len - 1] = 0;
+
+        script += len;
+        if (*script) script++;
+
+        len = strspn(line, " \t");
+        if (!line[len] || (line[len] == '#')) continue;
+
+        status = shellExec(pshell, line);
+    }
+
+    return status;
+}
+
+
+//*****************************************************************************
+// Print lines above the line being edited, the edit line is drawn again
+void shellPrintAsync(shellObject_t *pshell, const char *text, size_t len)
+{
+    bool editing = pshell->echo && (pshell->state == SHELL_STATE_READY);
+    uint8_t kind = pshell->out_kind;
+
+    if (!len) return;
+
+    /* a record of its own, or in the record of the command running */
+    if (pshell->machine) {
+        if (pshell->record) {
+            shellWrite(pshell, text, len);
+        }
+        else {
+            shell_out_kind(pshell, SHELL_OUT_ASYNC);
+            shell_record_begin(pshell, false);
+            shellWrite(pshell, text, len);
+            shell_record_end(pshell, false, 0);
+            shell_out_kind(pshell, kind);
+        }
+        return;
+    }
+
+    /* it ends where it began, the queue can drop it as a whole */
+    shell_out_kind(pshell, SHELL_OUT_ASYNC);
+    shell_hold(pshell);
+
+    if (editing) {
+        shell_erase_line(pshell, pshell->vt->ncols);
+    }
+
+    shell_hl_plain(pshell);
+    shellWrite(pshell, text, len);
+
+    if (editing) {
+        if (text[len - 1] != '\n') shellPrintf(pshell, "\r\n");
+        shell_redraw_line(pshell);
+    }
+
+    shell_release(pshell);
+    shell_out_kind(pshell, kind);
+}
+
+
+//*****************************************************************************
+// The caller runs a command, the prompt comes back when it's done
+void shellSetBusy(shellObject_t *pshell, bool busy)
+{
+    if (busy) {
+        pshell->intr = 0;
+        pshell->state = SHELL_STATE_BUSY;
+    }
+    else if (pshell->state == SHELL_STATE_BUSY) {
+        pshell->state = SHELL_STATE_RX_CMD;
+    }
+}
+
+
+//*****************************************************************************
+// Return true once if Ctrl-C was hit while busy
+bool shellInterrupted(shellObject_t *pshell)
+{
+    if (!pshell->intr) return false;
+
+    pshell->intr = 0;
+    return true;
+}
+
+
+//*****************************************************************************
+// Paged output, the generator is called a screen at a time while the
+// user asks for more. Outside of a command of the session (a job, no echo)
+// all the output is pulled at once.
+s_err_t shellPage(shellObject_t *pshell, shell_page_func_t gen, void *ctx)
+{
+    uint16_t nrows = shell_rows(pshell);
+
+    if (gen == NULL) return SYS_ERROR;
+
+    pshell->page = gen;
+    pshell->page_ctx = ctx;
+
+    /* the filters take it all, the head one can stop it */
+    if (shell_piping(pshell)) {
+        while (!pshell->intr && gen(pshell, ctx)) {}
+        pshell->page = NULL;
+        return SYS_EOK;
+    }
+
+    if (!pshell->echo || (pshell->state != SHELL_STATE_RX_CMD)) {
+        while (gen(pshell, ctx)) {}
+        pshell->page = NULL;
+        return SYS_EOK;
+    }
+
+    /* the first screen, the --More-- line takes the last row */
+    pshell->state = SHELL_STATE_PAGER;
+    shell_page_lines(pshell, (nrows > 1) ? (nrows - 1) : 1);
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Give the input to a reader instead of the line editor, from a command
+// of the session. The reader is called by shellEngine() until it gives
+// the input back with a NULL reader, then the prompt comes again.
+s_err_t shellSetRaw(shellObject_t *pshell, shell_raw_func_t func, void *ctx)
+{
+    if (func == NULL) {
+        if (pshell->state != SHELL_STATE_XFER) return SYS_ERROR;
+
+        pshell->raw = NULL;
+        pshell->raw_ctx = NULL;
+        pshell->state = SHELL_STATE_RX_CMD;
+        return SYS_EOK;
+    }
+
+    /* a job or a pager has nothing to give */
+    if (pshell->state != SHELL_STATE_RX_CMD) return SYS_EBUSY;
+
+    pshell->raw = func;
+    pshell->raw_ctx = ctx;
+    pshell->state = SHELL_STATE_XFER;
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Machine mode: no echo, no prompt and no VT sequence, each command line
+// gets a JSON record with its sequence number, output and status
+void shellSetMachine(shellObject_t *pshell, bool on)
+{
+    if (on == pshell->machine) return;
+
+    if (on) {
+        pshell->machine_echo = pshell->echo;
+        pshell->echo = false;
+    }
+    else {
+        pshell->echo = pshell->machine_echo;
+    }
+
+    pshell->machine = on;
+}
+
+
+//*****************************************************************************
+// History store shared with other sessions, it's loaded at once
+void shellSetHistory(shellObject_t *pshell, const shell_hist_ops_t *ops, void *ctx)
+{
+    pshell->hist_ops = ops;
+    pshell->hist_ctx = ctx;
+
+    if (ops != NULL) ops->sync(ctx, pshell);
+}
+
+
+//*****************************************************************************
+// Draw the prompt and the line again, the cursor is on the line being edited
+void shellRedraw(shellObject_t *pshell)
+{
+    if (!pshell->echo || (pshell->state != SHELL_STATE_READY)) return;
+
+    shell_hold(pshell);
+    shell_erase_line(pshell, pshell->vt->ncols);
+    shell_redraw_line(pshell);
+    shell_release(pshell);
+}
+
+
+//*****************************************************************************
+// Colour the line from the command table while it's typed
+void shellSetHighlight(shellObject_t *pshell, bool on)
+{
+#if SHELL_CFG_HIGHLIGHT
+    if (on == pshell->highlight) return;
+
+    shell_hold(pshell);
+    shell_hl_plain(pshell);
+    pshell->highlight = on;
+    shell_release(pshell);
+
+    shellRedraw(pshell);
+#else
+    (void) pshell;
+    (void) on;
+#endif
+}
+
+
+//*****************************************************************************
+// Keep the output in a scrollback, see shell_scrollback.h. NULL to stop
+void shellSetScrollback(shellObject_t *pshell, struct shell_scrollback *sb)
+{
+#if SHELL_CFG_SCROLLBACK
+    shellFlush(pshell);
+
+    pshell->scrollback = sb;
+    pshell->out_saved = pshell->out_len;
+#else
+    (void) pshell;
+    (void) sb;
+#endif
+}
+
+
+//*****************************************************************************
+// The connection is gone, the session goes on with the output kept only
+s_err_t shellDetach(shellObject_t *pshell)
+{
+#if SHELL_CFG_SCROLLBACK
+    return shellSetIo(pshell, &shell_io_detached, NULL);
+#else
+    (void) pshell;
+
+    return SYS_ENOSYS;
+#endif
+}
+
+
+//*****************************************************************************
+// Give a connection to a session, the screen and nlines lines before it
+// are written again, then the line being edited
+s_err_t shellAttach(shellObject_t *pshell, const shell_io_t *io, void *ctx, uint32_t nlines)
+{
+#if SHELL_CFG_SCROLLBACK
+    shell_scrollback_t *sb = pshell->scrollback;
+    bool editing = pshell->echo && (pshell->state == SHELL_STATE_READY);
+    uint32_t len;
+    uint8_t *buf;
+
+    if (shellSetIo(pshell, io, ctx) != SYS_EOK) return SYS_ERROR;
+    if (pshell->machine) return SYS_EOK;
+
+    shell_hold(pshell);
+
+    /* a new terminal, set as shellInit() does */
+    shellPuts(pshell, vtChangeModeAttr(pshell->vt, VT_MODE_SRM, VT_CMD_MODE_SET));
+    shellPuts(pshell, vtChangeModeAttr(pshell->vt, VT_MODE_LNM, VT_CMD_MODE_SET));
+    shellPuts(pshell, vtChangeModeAttr(pshell->vt, VT_MODE_BPM, VT_CMD_MODE_SET));
+
+    shellPuts(pshell, vtSetCursor(pshell->vt, 1, 1));
+    shellPuts(pshell, vtEraseScreen(pshell->vt, VT_ERASE_SCREEN_ALL));
+#if SHELL_CFG_STATUS
+    shellStatusScreen(pshell, true);
+#endif
+
+    if (sb != NULL) {
+        /* the screen but the row of the prompt, the line not ended after
+           the output of a command */
+        nlines += shell_rows(pshell) - 1;
+
+        len = shellScrollbackRead(sb, nlines, !editing, NULL, 0);
+        buf = len ? (uint8_t *) malloc(len) : NULL;
+
+        if (buf != NULL) {
+            len = shellScrollbackRead(sb, nlines, !editing, buf, len);
+
+            /* already in the scrollback */
+            shellFlush(pshell);
+            pshell->scrollback = NULL;
+            shellWrite(pshell, buf, len);
+            shellFlush(pshell);
+            pshell->scrollback = sb;
+            pshell->out_saved = pshell->out_len;
+
+            free(buf);
+        }
+    }
+
+    if (editing) shell_redraw_line(pshell);
 
+    shellProbeSize(pshell);
+    shell_release(pshell);
 
+    return SYS_EOK;
+#else
+    (void) pshell;
+    (void) io;
+    (void) ctx;
+    (void) nlines;
+
+    return SYS_ENOSYS;
+#endif
+}
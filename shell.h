@@ -33,11 +33,14 @@
 #define _SHELL_H
 
 
+#include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 
 #include "vt100.h"
+#include "shell_io.h"
+#include "shell_fmt.h"
 
 
 #ifdef __cplusplus
@@ -84,6 +87,17 @@ extern "C" {
 
 
 #define SHELL_DEFAULT_ECHO               true
+#define SHELL_DEFAULT_PASTE_QUEUE        false     //!< Pasted lines run as commands
+#define SHELL_DEFAULT_MACHINE            false     //!< JSON lines records instead of a terminal
+#define SHELL_DEFAULT_HIGHLIGHT          true      //!< With SHELL_CFG_HIGHLIGHT
+
+#ifndef SHELL_CMD_MACHINE
+#define SHELL_CMD_MACHINE               "machine"  //!< Built-in command, "machine off" to leave
+#endif
+
+#ifndef SHELL_CMD_SET
+#define SHELL_CMD_SET                   "set"      //!< Built-in command with SHELL_CFG_VARS
+#endif
 
 
 #define SHELL_NUM_TAB                    4
@@ -99,11 +113,88 @@ extern "C" {
 #define SHELL_HISTORY_CMD_SIZE          32
 #endif
 
+#ifndef SHELL_CFG_TRACE
+#define SHELL_CFG_TRACE                 0          //!< Tracepoints, see shell_trace.h
+#endif
+
+#ifndef SHELL_CFG_HIGHLIGHT
+#define SHELL_CFG_HIGHLIGHT             0          //!< Colours of the line from the command table
+#endif
+
+#ifndef SHELL_HL_COLOUR_CMD
+#define SHELL_HL_COLOUR_CMD             VT_COL_GREEN   //!< Command of the table
+#endif
+
+#ifndef SHELL_HL_COLOUR_UNKNOWN
+#define SHELL_HL_COLOUR_UNKNOWN         VT_COL_RED     //!< No command of the table starts so
+#endif
+
+#ifndef SHELL_HL_COLOUR_OPTION
+#define SHELL_HL_COLOUR_OPTION          VT_COL_CYAN    //!< Argument starting by '-'
+#endif
+
+#ifndef SHELL_CFG_STATUS
+#define SHELL_CFG_STATUS                0          //!< Status rows, see shell_status.h
+#endif
+
+#ifndef SHELL_CFG_SCROLLBACK
+#define SHELL_CFG_SCROLLBACK            0          //!< Output kept for a reattach, see shell_scrollback.h
+#endif
+
+#ifndef SHELL_CFG_VARS
+#define SHELL_CFG_VARS                  0          //!< Variables expanded in the lines, see shell_vars.h
+#endif
+
+#ifndef SHELL_CFG_PIPE
+#define SHELL_CFG_PIPE                  0          //!< "| filter" and "> file" after a command, see shell_pipe.h
+#endif
+
+#ifndef SHELL_IN_BUFFER_LEN
+#define SHELL_IN_BUFFER_LEN             32         //!< Bytes read from the backend at once
+#endif
+
+#ifndef SHELL_OUT_BUFFER_LEN
+#define SHELL_OUT_BUFFER_LEN            128        //!< Output given to the backend at once
+#endif
+
+#ifndef SHELL_OUT_STALL_MS
+#define SHELL_OUT_STALL_MS              1000       //!< Wait of a backend taking nothing, then its output is dropped
+#endif
+
+#ifndef SHELL_OUT_SEGMENTS
+#define SHELL_OUT_SEGMENTS              16         //!< Chunks told apart in the output queue
+#endif
+
+#define SHELL_OUT_QUEUE_MIN             512        //!< Smallest output queue
+
+#ifndef SHELL_MAX_ARGS
+#define SHELL_MAX_ARGS                  16         //!< Max arguments of a command
+#endif
+
 
 #define SHELL_STATE_START               0
 #define SHELL_STATE_LOGIN               1
 #define SHELL_STATE_READY               2
 #define SHELL_STATE_RX_CMD              3
+#define SHELL_STATE_BUSY                4          //!< A command runs, only Ctrl-C is read
+#define SHELL_STATE_PAGER               5          //!< Paged output, waits a key for more
+#define SHELL_STATE_XFER                6          //!< Raw input given to a reader, no line editor
+
+
+#define SHELL_OUT_DROP_ASYNC            0x01       //!< The oldest async text makes room
+#define SHELL_OUT_COALESCE              0x02       //!< Queued echo replaced by one redraw of the line
+#define SHELL_OUT_DISCONNECT            0x04       //!< Input closed once nothing is written for the timeout
+
+#define SHELL_OUT_DATA                  0          //!< Output of the commands, kept
+#define SHELL_OUT_EDIT                  1          //!< Echo of the line editor
+#define SHELL_OUT_ASYNC                 2          //!< shellPrintAsync(), the line drawn again after it
+
+
+#define SHELL_HL_NONE                   0          //!< Default colour, blanks and plain arguments
+#define SHELL_HL_CMD                    1
+#define SHELL_HL_UNKNOWN                2
+#define SHELL_HL_OPTION                 3
+#define SHELL_HL_NEW                    0xFF       //!< Not drawn yet
 
 
 
@@ -120,6 +211,105 @@ struct shell_ops
 typedef struct shell_ops shell_ops_t;
 
 
+typedef struct shellObject shellObject_t;
+
+/**
+ * Command handler, argv[0] is the command name
+ */
+typedef int32_t (*shell_cmd_func_t)(shellObject_t *pshell, int32_t argc, char *argv[]);
+
+/**
+ * Commands of the caller of shellExecWith(), looked up before the table of
+ * the session. Returns false if argv[0] isn't one of them
+ */
+typedef bool (*shell_exec_func_t)(void *ctx, shellObject_t *pshell, int32_t argc, char *argv[], int32_t *status);
+
+/**
+ * Paged output generator, prints the next line and returns 1, or 0 at the end
+ */
+typedef int32_t (*shell_page_func_t)(shellObject_t *pshell, void *ctx);
+
+/**
+ * Reader of the raw input in the transfer state, it reads with
+ * shellRead() and leaves the state with shellSetRaw(pshell, NULL, NULL)
+ */
+typedef void (*shell_raw_func_t)(shellObject_t *pshell, void *ctx);
+
+/**
+ * Command Structure
+ */
+struct shell_cmd
+{
+    const char          *name;                     //!< Command name
+    shell_cmd_func_t    func;                      //!< Handler
+    const char          *help;                     //!< One line help
+    const struct shell_args *args;                 //!< Typed arguments, see shell_args.h. Optional
+};
+typedef struct shell_cmd shell_cmd_t;
+
+
+/**
+ * History store, shared with other sessions
+ */
+struct shell_hist_ops
+{
+    void (*push)(void *ctx, const char *line);                 //!< Line added to the history
+    void (*sync)(void *ctx, shellObject_t *pshell);            //!< Reload the history if it changed
+};
+typedef struct shell_hist_ops shell_hist_ops_t;
+
+
+/**
+ * Chunk of the output queue, written by one call
+ */
+struct shell_out_seg
+{
+    uint32_t            len;
+    uint16_t            from;                      //!< Cursor in the edit area before it
+    uint8_t             kind;                      //!< SHELL_OUT_DATA...
+    bool                open;                      //!< The call writing it isn't over
+};
+
+/**
+ * Bounded output queue, in front of a backend which doesn't block
+ */
+struct shell_outq
+{
+    uint8_t             *buf;                      //!< NULL, the output waits the backend
+    uint32_t            size;
+    uint32_t            len;
+    uint8_t             policy;                    //!< SHELL_OUT_DROP_ASYNC...
+    uint32_t            timeout_ms;
+    uint64_t            stall_ms;                  //!< Since nothing is written
+    bool                stalled;
+    bool                started;                   //!< The first chunk is partly written
+    bool                redraw;                    //!< The line is drawn again at the end of the call
+    bool                drawing;
+    bool                closed;                    //!< Disconnected, the output is dropped
+    uint16_t            redraw_from;               //!< Cursor where the dropped echo began
+    uint8_t             nseg;
+    struct shell_out_seg seg[SHELL_OUT_SEGMENTS];
+
+    uint32_t            high_water;
+    uint32_t            dropped;                   //!< Bytes never written
+    uint32_t            coalesced;                 //!< Bytes of echo replaced by a redraw
+};
+typedef struct shell_outq shell_outq_t;
+
+/**
+ * Counters of the output queue
+ */
+struct shell_out_stats
+{
+    uint32_t            queued;
+    uint32_t            high_water;
+    uint32_t            dropped;                   //!< By the queue or a stalled backend
+    uint32_t            coalesced;
+    bool                closed;
+};
+typedef struct shell_out_stats shell_out_stats_t;
+
+
 /**
  * Shell Object Structure
  */
@@ -127,32 +317,144 @@ struct shellObject{
     char                line[SHELL_BUFFER_LINE_LEN];   //!< Buffer Line
     uint16_t            line_pos;
     uint16_t            line_cur;
+    uint16_t            line_max;                  //!< Chars of a line, up to SHELL_BUFFER_LINE_LEN - 1
     const char          *prompt;
+    uint16_t            prompt_len;                //!< Width of the prompt
     bool                echo;
     uint8_t             state;
+    volatile sig_atomic_t resize_pending;          //!< Window size changed, probe it again
+
+    bool                paste;                     //!< Inside a bracketed paste
+    bool                paste_queue;               //!< Each pasted line is a command
+    bool                paste_cr;                  //!< Last pasted char was a CR
+    uint16_t            paste_start;               //!< Cursor when the paste began
+    uint16_t            paste_tail;                //!< Tail moved to the end of line
+
+    volatile sig_atomic_t intr;                    //!< Ctrl-C received while busy
+    const shell_cmd_t   *cmds;                     //!< Command table
+    uint16_t            ncmds;
+
+    bool                machine;                   //!< Machine mode, only records are written
+    bool                machine_echo;              //!< Echo restored out of the machine mode
+    bool                record;                    //!< The output goes in a record
+    uint32_t            seq;                       //!< Sequence of the last command record
+
+#if SHELL_CFG_TRACE
+    struct shell_trace  *trace;                    //!< Event ring, NULL until enabled
+    bool                trace_on;
+#endif
+
+#if SHELL_CFG_STATUS
+    struct shell_status *status;                   //!< Status rows, NULL without
+#endif
+
+#if SHELL_CFG_SCROLLBACK
+    struct shell_scrollback *scrollback;           //!< Output kept, NULL without
+    uint16_t            out_saved;                 //!< Bytes of out_buf already in it
+#endif
+
+#if SHELL_CFG_VARS
+    struct shell_vars   *vars;                     //!< Variables, NULL without
+    bool                expanded;                  //!< The command runs on the expanded copy of the line
+#endif
+
+#if SHELL_CFG_PIPE
+    struct shell_pipe   *pipe;                     //!< Pipelines, NULL without
+#endif
+
+#if SHELL_CFG_HIGHLIGHT
+    bool                highlight;
+    uint8_t             hl_sgr;                    //!< Class of the colour set on the terminal
+    uint8_t             hl[SHELL_BUFFER_LINE_LEN]; //!< Class of each char of the line as drawn
+#endif
+
+    shell_page_func_t   page;                      //!< Generator of the paged output
+    void                *page_ctx;
+
+    shell_raw_func_t    raw;                       //!< Reader of the transfer state
+    void                *raw_ctx;
 
     uint16_t            history_current;
     uint16_t            history_count;
+    uint16_t            history_max;               //!< Lines kept, up to SHELL_HISTORY_LINES
     char                history[SHELL_HISTORY_LINES][SHELL_HISTORY_CMD_SIZE];
-
-    FILE                *in;
-    FILE                *out;
+    const shell_hist_ops_t *hist_ops;              //!< Persistent history, can be NULL
+    void                *hist_ctx;
+
+    const shell_io_t    *io;                       //!< I/O backend
+    void                *io_ctx;                   //!< Context of the backend
+    shell_io_file_t     file;                      //!< Context of the stdio backend
+    shell_ring_t        rx;                        //!< Input ring, read instead of the backend once set
+    uint8_t             in_buf[SHELL_IN_BUFFER_LEN];
+    uint16_t            in_pos;
+    uint16_t            in_len;
+    uint8_t             out_buf[SHELL_OUT_BUFFER_LEN];
+    uint16_t            out_len;
+    uint32_t            out_lost;                  //!< Bytes dropped by a stalled backend, see shellOutputStats()
+    bool                out_stalled;               //!< Not waited again until it takes something
+    uint8_t             hold;                      //!< Output kept until the end of the call
+    uint8_t             out_kind;                  //!< Class of the output being written
+    uint16_t            out_from;                  //!< Cursor in the edit area when it began
+    shell_outq_t        outq;
+    bool                eof;                       //!< The input is closed
     vt100_t             *vt;
     shell_ops_t         *ops;
 };
-typedef struct shellObject shellObject_t;
 
 
 
 
+struct shell_scrollback;                           //!< See shell_scrollback.h
+
 shellObject_t *shellOpen(FILE *out, FILE *in, const char *prompt, shell_ops_t *ops);
+shellObject_t *shellOpenIo(const shell_io_t *io, void *ctx, const char *prompt, shell_ops_t *ops);
 s_err_t shellInit(shellObject_t *pshell, bool echo);
 s_err_t shellClose(shellObject_t *pshell);
-void shellPrintf(shellObject_t *pshell, const char *fmt, ...);
+s_err_t shellSetIo(shellObject_t *pshell, const shell_io_t *io, void *ctx);
+void shellPrintf(shellObject_t *pshell, const char *fmt, ...) SHELL_FMT_CHECK(2, 3);
+void shellPuts(shellObject_t *pshell, const char *text);
+int32_t shellWrite(shellObject_t *pshell, const void *data, size_t len);
+int32_t shellWriteDirect(shellObject_t *pshell, const void *data, size_t len);
+s_err_t shellFlush(shellObject_t *pshell);
 int32_t shellGetc(shellObject_t *pshell);
+int32_t shellRead(shellObject_t *pshell, void *buf, size_t len);
+bool shellSetInputRing(shellObject_t *pshell, uint8_t *buf, uint32_t size);
+s_err_t shellSetOutputQueue(shellObject_t *pshell, uint8_t *buf, uint32_t size, uint8_t policy, uint32_t timeout_ms);
+uint32_t shellOutputPending(shellObject_t *pshell);
+void shellOutputStats(shellObject_t *pshell, shell_out_stats_t *stats);
+uint32_t shellFeed(shellObject_t *pshell, const uint8_t *data, uint32_t len);
 int32_t shellPutc(int32_t ch, shellObject_t *pshell);
 char *shellEngine(shellObject_t *pshell);
 
+s_err_t shellProbeSize(shellObject_t *pshell);
+void shellNotifyResize(shellObject_t *pshell);
+void shellSetSize(shellObject_t *pshell, uint16_t nrows, uint16_t ncols);
+void shellSetPrompt(shellObject_t *pshell, const char *prompt);
+void shellSetPasteQueue(shellObject_t *pshell, bool queue);
+void shellSetLimits(shellObject_t *pshell, uint16_t line_max, uint16_t history_max);
+
+s_err_t shellSetCommands(shellObject_t *pshell, const shell_cmd_t *cmds, uint16_t ncmds);
+const shell_cmd_t *shellFindCommand(shellObject_t *pshell, const char *name);
+int32_t shellParseArgs(char *line, char *argv[], int32_t max);
+int32_t shellExec(shellObject_t *pshell, char *line);
+int32_t shellExecWith(shellObject_t *pshell, char *line, shell_exec_func_t run, void *ctx);
+bool shellExecExpanded(shellObject_t *pshell);
+int32_t shellExecBatch(shellObject_t *pshell, const char *script);
+
+void shellPrintAsync(shellObject_t *pshell, const char *text, size_t len);
+void shellSetBusy(shellObject_t *pshell, bool busy);
+bool shellInterrupted(shellObject_t *pshell);
+
+s_err_t shellPage(shellObject_t *pshell, shell_page_func_t gen, void *ctx);
+s_err_t shellSetRaw(shellObject_t *pshell, shell_raw_func_t func, void *ctx);
+void shellSetMachine(shellObject_t *pshell, bool on);
+void shellSetHistory(shellObject_t *pshell, const shell_hist_ops_t *ops, void *ctx);
+void shellRedraw(shellObject_t *pshell);
+void shellSetHighlight(shellObject_t *pshell, bool on);
+void shellSetScrollback(shellObject_t *pshell, struct shell_scrollback *sb);
+s_err_t shellDetach(shellObject_t *pshell);
+s_err_t shellAttach(shellObject_t *pshell, const shell_io_t *io, void *ctx, uint32_t nlines);
+
 
 
 
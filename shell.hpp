@@ -0,0 +1,260 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell.hpp
+* @details C++ wrapper of the shell terminal
+*
+*   shell::Shell owns the session and closes it when destroyed. Lines are
+*   views of the session buffer and the handlers take their arguments as
+*   views of the line: nothing is allocated beyond shellOpen().
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 11:20:45
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_HPP
+#define _SHELL_HPP
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "shell.h"
+#include "shell_fmt.hpp"
+
+
+namespace shell {
+
+
+class Shell;
+
+/**
+ * Command handler, args[0] is the command name
+ */
+using Handler = int32_t (*)(Shell &shell, std::span<std::string_view> args);
+
+/**
+ * Command Structure
+ */
+struct Command
+{
+    std::string_view    name;
+    Handler             func;
+    std::string_view    help;
+};
+
+
+/**
+ * Split a line on blanks, return the number of arguments
+ */
+inline std::size_t splitArgs(std::string_view line, std::span<std::string_view> argv) noexcept
+{
+    std::size_t argc = 0;
+    std::size_t pos = 0;
+
+    while (argc < argv.size()) {
+        pos = line.find_first_not_of(" \t", pos);
+        if (pos == std::string_view::npos) break;
+
+        std::size_t end = line.find_first_of(" \t", pos);
+        if (end == std::string_view::npos) end = line.size();
+
+        argv[argc++] = line.substr(pos, end - pos);
+        pos = end;
+    }
+
+    return argc;
+}
+
+
+/**
+ * Session, move only
+ */
+class Shell
+{
+public:
+    Shell() noexcept = default;
+
+    Shell(FILE *out, FILE *in, const char *prompt, shell_ops_t *ops = nullptr) noexcept
+        : pshell_(shellOpen(out, in, prompt, ops)) {}
+
+    // Take the ownership of an opened session
+    explicit Shell(shellObject_t *pshell) noexcept : pshell_(pshell) {}
+
+    ~Shell() { reset(); }
+
+    Shell(Shell &&other) noexcept : pshell_(std::exchange(other.pshell_, nullptr)) {}
+
+    Shell &operator=(Shell &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            pshell_ = std::exchange(other.pshell_, nullptr);
+        }
+        return *this;
+    }
+
+    Shell(const Shell &) = delete;
+    Shell &operator=(const Shell &) = delete;
+
+    explicit operator bool() const noexcept { return pshell_ != nullptr; }
+    shellObject_t *get() const noexcept { return pshell_; }
+    shellObject_t *release() noexcept { return std::exchange(pshell_, nullptr); }
+
+    void reset(shellObject_t *pshell = nullptr) noexcept
+    {
+        if (pshell_ != nullptr) shellClose(pshell_);
+        pshell_ = pshell;
+    }
+
+    s_err_t init(bool echo = SHELL_DEFAULT_ECHO) noexcept { return shellInit(pshell_, echo); }
+
+    /**
+     * Run the engine up to a complete line or the end of the input.
+     * The view is in the session buffer, valid until the next read.
+     */
+    std::optional<std::string_view> readLine() noexcept
+    {
+        for (;;) {
+            uint8_t state = pshell_->state;
+            char *line = shellEngine(pshell_);
+
+            if (line != nullptr) return std::string_view(line);
+
+            /* the input is drained */
+            if ((state == SHELL_STATE_READY) || (state == SHELL_STATE_BUSY) ||
+                (state == SHELL_STATE_PAGER) || (state == SHELL_STATE_XFER)) return std::nullopt;
+        }
+    }
+
+    // Line being edited or last completed line
+    std::string_view line() const noexcept { return std::string_view(pshell_->line, pshell_->line_pos); }
+
+    void write(std::string_view text) noexcept
+    {
+        shellWrite(pshell_, text.data(), text.size());
+    }
+
+    /**
+     * Write views and integers one after the other, no format string
+     */
+    template <typename... T>
+    void print(const T &...parts) noexcept
+    {
+        (put(parts), ...);
+    }
+
+    /**
+     * As shellPrintf(), the format checked against the arguments
+     */
+    template <typename... T>
+    void printf(Format<std::type_identity_t<T>...> fmt, T... args) noexcept
+    {
+        shell::printf<T...>(pshell_, fmt, args...);
+    }
+
+    /**
+     * Run the command of the line through shellExecWith(), as a line of the
+     * C table: same record, expansion and pipes. cmds are looked up first.
+     * A line other than the one just read is copied on the stack, the
+     * arguments are views of the line run
+     */
+    int32_t exec(std::string_view line, std::span<const Command> cmds) noexcept
+    {
+        char buf[SHELL_BUFFER_LINE_LEN];
+        Commands table{ *this, cmds };
+
+        /* the line just read is run in place, as by shellExec(), the
+         * errors can point in the line echoed */
+        if ((line.data() == pshell_->line) && (line.size() < sizeof(pshell_->line)) && !line.data()[line.size()]) {
+            return shellExecWith(pshell_, pshell_->line, run, &table);
+        }
+
+        if (line.size() >= sizeof(buf)) {
+            print(line.substr(0, 16), "...: line too long\r\n");
+            return SYS_ERROR;
+        }
+
+        line.copy(buf, line.size());
+        buf[line.size()] = 0;
+
+        return shellExecWith(pshell_, buf, run, &table);
+    }
+
+private:
+    struct Commands
+    {
+        Shell                       &shell;
+        std::span<const Command>    cmds;
+    };
+
+    static bool run(void *ctx, shellObject_t *pshell, int32_t argc, char *argv[], int32_t *status) noexcept
+    {
+        Commands *table = static_cast<Commands *>(ctx);
+        std::array<std::string_view, SHELL_MAX_ARGS> args;
+
+        (void) pshell;
+        for (int32_t i = 0; i < argc; i++) args[i] = argv[i];
+
+        for (const Command &cmd : table->cmds) {
+            if (cmd.name == args[0]) {
+                *status = cmd.func(table->shell, std::span<std::string_view>(args.data(), argc));
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    template <typename T>
+    void put(const T &part) noexcept
+    {
+        if constexpr (std::is_same_v<T, char>) {
+            shellPutc(part, pshell_);
+        }
+        else if constexpr (std::is_same_v<T, bool>) {
+            write(part ? "true" : "false");
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            char buf[24];
+            auto res = std::to_chars(buf, buf + sizeof(buf), part);
+            write(std::string_view(buf, res.ptr - buf));
+        }
+        else {
+            write(std::string_view(part));
+        }
+    }
+
+    shellObject_t       *pshell_ = nullptr;
+};
+
+
+} // namespace shell
+
+#endif /* _SHELL_HPP */
@@ -0,0 +1,555 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_args.c
+* @details Typed arguments of the commands, declared once in a table
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 23:58:16
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <string.h>
+
+#include "shell_args.h"
+
+
+
+
+
+/* words of a bool, the odd ones are true */
+static const char *const args_bools[] = { "off", "on", "false", "true", "no", "yes", "0", "1", NULL };
+
+
+
+//Declare Prototype
+static inline bool args_is_option(const shell_arg_t *arg);
+static const shell_arg_t *args_short(const shell_args_t *schema, char opt);
+static const shell_arg_t *args_long(const shell_args_t *schema, const char *name, size_t len);
+static int32_t args_choice(const char *const *choices, const char *word);
+static s_err_t args_fail(shell_args_err_t *err, int32_t argc, char *argv[], int32_t index, const char *at,
+                         const char *msg, const shell_arg_t *arg);
+static const char *args_store(const shell_arg_t *arg, const char *value, uint8_t *base);
+static const shell_arg_t *args_wants(const shell_args_t *schema, const char *word);
+static void args_label(const shell_arg_t *arg, char *label, size_t size);
+
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+static inline bool args_is_option(const shell_arg_t *arg)
+{
+    return arg->opt != 0;
+}
+
+
+//*****************************************************************************
+// the tables are a handful of entries, a scan beats a hash
+static const shell_arg_t *args_short(const shell_args_t *schema, char opt)
+{
+    uint8_t i;
+
+    if (opt == SHELL_OPT_LONG) return NULL;
+
+    for (i = 0; i < schema->count; i++) {
+        if (schema->table[i].opt == opt) return &schema->table[i];
+    }
+
+    return NULL;
+}
+
+
+static const shell_arg_t *args_long(const shell_args_t *schema, const char *name, size_t len)
+{
+    const shell_arg_t *arg;
+    uint8_t i;
+
+    for (i = 0; i < schema->count; i++) {
+        arg = &schema->table[i];
+        if (!args_is_option(arg) || (arg->name[0] != name[0])) continue;
+        if (!strncmp(arg->name, name, len) && !arg->name[len]) return arg;
+    }
+
+    return NULL;
+}
+
+
+//*****************************************************************************
+// index of the word in the choices, -1 if it isn't one
+static int32_t args_choice(const char *const *choices, const char *word)
+{
+    int32_t i;
+
+    for (i = 0; choices[i] != NULL; i++) {
+        if (!strcmp(choices[i], word)) return i;
+    }
+
+    return -1;
+}
+
+
+//*****************************************************************************
+// at is where the error is in argv[index], NULL after the last argument
+static s_err_t args_fail(shell_args_err_t *err, int32_t argc, char *argv[], int32_t index, const char *at,
+                         const char *msg, const shell_arg_t *arg)
+{
+    if (err == NULL) return SYS_ERROR;
+
+    err->index = index;
+    err->msg = msg;
+    err->arg = arg;
+
+    if (at != NULL) err->column = at - argv[0] + 1;
+    else err->column = argv[argc - 1] - argv[0] + strlen(argv[argc - 1]) + 1;
+
+    return SYS_ERROR;
+}
+
+
+//*****************************************************************************
+// convert the value in its field, the error or NULL
+static const char *args_store(const shell_arg_t *arg, const char *value, uint8_t *base)
+{
+    void *field = base + arg->offset;
+    int64_t number;
+    int32_t index;
+
+    switch (arg->type) {
+        case SHELL_ARG_T_INT:
+        case SHELL_ARG_T_UINT:
+            if (shellArgsNumber(value, &number) != SYS_EOK) return "not a number";
+            if ((number < arg->min) || (number > arg->max)) return "out of range";
+
+            if (arg->type == SHELL_ARG_T_INT) *(int32_t *) field = number;
+            else *(uint32_t *) field = number;
+            break;
+
+        case SHELL_ARG_T_BOOL:
+            index = args_choice(args_bools, value);
+            if (index < 0) return "not a bool";
+            *(bool *) field = index & 1;
+            break;
+
+        case SHELL_ARG_T_ENUM:
+            index = args_choice(arg->choices, value);
+            if (index < 0) return "bad choice";
+            *(int32_t *) field = index;
+            break;
+
+        case SHELL_ARG_T_STR:
+            *(const char **) field = value;
+            break;
+
+        default:
+            *(bool *) field = true;
+            break;
+    }
+
+    return NULL;
+}
+
+
+//*****************************************************************************
+// option of the word which takes the next word as its value, or NULL
+static const shell_arg_t *args_wants(const shell_args_t *schema, const char *word)
+{
+    const shell_arg_t *arg;
+
+    if (word[1] == '-') {
+        if (strchr(word, '=') != NULL) return NULL;
+
+        arg = args_long(schema, &word[2], strlen(&word[2]));
+        return ((arg != NULL) && (arg->type != SHELL_ARG_T_FLAG)) ? arg : NULL;
+    }
+
+    for (word++; *word; word++) {
+        arg = args_short(schema, *word);
+        if (arg == NULL) return NULL;
+        if (arg->type != SHELL_ARG_T_FLAG) return word[1] ? NULL : arg;
+    }
+
+    return NULL;
+}
+
+
+//*****************************************************************************
+// -c, --count <n> or <pin>
+static void args_label(const shell_arg_t *arg, char *label, size_t size)
+{
+    const char *value = (arg->type == SHELL_ARG_T_FLAG) ? "" :
+                        (arg->type == SHELL_ARG_T_STR) ? " <str>" :
+                        (arg->type == SHELL_ARG_T_ENUM) ? " <choice>" :
+                        (arg->type == SHELL_ARG_T_BOOL) ? " <on|off>" : " <n>";
+
+    if (!args_is_option(arg)) snprintf(label, size, "<%s>", arg->name);
+    else if (arg->opt == SHELL_OPT_LONG) snprintf(label, size, "    --%s%s", arg->name, value);
+    else snprintf(label, size, "-%c, --%s%s", arg->opt, arg->name, value);
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+//*****************************************************************************
+// Handler of the commands with a schema: parse, check, then run
+int32_t shellArgsCmd(shellObject_t *pshell, int32_t argc, char *argv[])
+{
+    const shell_cmd_t *cmd = shellFindCommand(pshell, argv[0]);
+    const shell_args_t *schema;
+    shell_args_err_t err;
+    union {
+        int64_t         align;
+        void            *ptr;
+        uint8_t         buf[SHELL_ARGS_SIZE_MAX];
+    } args;
+
+    if ((cmd == NULL) || (cmd->args == NULL) || (cmd->args->size > sizeof(args))) return SYS_ENOSYS;
+    schema = cmd->args;
+
+    /* unless the command took them */
+    if ((argc > 1) && (!strcmp(argv[1], "--help") || (!strcmp(argv[1], "-h") && (args_short(schema, 'h') == NULL)))) {
+        shellArgsHelp(pshell, argv[0], schema);
+        return SYS_EOK;
+    }
+
+    if (shellArgsParse(schema, argc, argv, &args, &err) != SYS_EOK) {
+        shellArgsError(pshell, argv, &err);
+        return SYS_ERROR;
+    }
+
+    return schema->run(pshell, &args);
+}
+
+
+//*****************************************************************************
+// Fill the structure from argv, the options not given take their default
+s_err_t shellArgsParse(const shell_args_t *schema, int32_t argc, char *argv[], void *args, shell_args_err_t *err)
+{
+    uint8_t *base = (uint8_t *) args;
+    const shell_arg_t *arg;
+    const char *value, *msg;
+    const char *c;
+    bool only_pos = false;
+    uint8_t next = 0;                               //Table entry of the next positional
+    int32_t i;
+    size_t len;
+
+    memset(args, 0, schema->size);
+
+    for (i = 0; i < schema->count; i++) {
+        arg = &schema->table[i];
+        if (!args_is_option(arg)) continue;
+
+        switch (arg->type) {
+            case SHELL_ARG_T_INT:
+            case SHELL_ARG_T_ENUM: *(int32_t *) (base + arg->offset) = arg->def; break;
+            case SHELL_ARG_T_UINT: *(uint32_t *) (base + arg->offset) = arg->def; break;
+            case SHELL_ARG_T_BOOL: *(bool *) (base + arg->offset) = arg->def; break;
+            default: break;
+        }
+    }
+
+    for (i = 1; i < argc; i++) {
+        char *word = argv[i];
+
+        /* a negative number is an argument, unless the digit is an option */
+        if (!only_pos && (word[0] == '-') && word[1] &&
+            !((word[1] >= '0') && (word[1] <= '9') && (args_short(schema, word[1]) == NULL))) {
+
+            if (!strcmp(word, "--")) {
+                only_pos = true;
+                continue;
+            }
+
+            if (word[1] == '-') {
+                value = strchr(word, '=');
+                len = (value != NULL) ? (size_t) (value - &word[2]) : strlen(&word[2]);
+
+                arg = args_long(schema, &word[2], len);
+                if (arg == NULL) return args_fail(err, argc, argv, i, word, "unknown option", NULL);
+
+                if (arg->type == SHELL_ARG_T_FLAG) {
+                    if (value != NULL) return args_fail(err, argc, argv, i, value, "takes no value", arg);
+                    *(bool *) (base + arg->offset) = true;
+                    continue;
+                }
+
+                if (value != NULL) value++;
+                else if (i + 1 < argc) value = argv[++i];
+                else return args_fail(err, argc, argv, argc, NULL, "missing value", arg);
+
+                msg = args_store(arg, value, base);
+                if (msg != NULL) return args_fail(err, argc, argv, i, value, msg, arg);
+                continue;
+            }
+
+            /* -vq flags together, -c5 or -c 5 */
+            for (c = &word[1]; *c; c++) {
+                arg = args_short(schema, *c);
+                if (arg == NULL) return args_fail(err, argc, argv, i, c, "unknown option", NULL);
+
+                if (arg->type == SHELL_ARG_T_FLAG) {
+                    *(bool *) (base + arg->offset) = true;
+                    continue;
+                }
+
+                if (c[1]) value = c + 1;
+                else if (i + 1 < argc) value = argv[++i];
+                else return args_fail(err, argc, argv, argc, NULL, "missing value", arg);
+
+                msg = args_store(arg, value, base);
+                if (msg != NULL) return args_fail(err, argc, argv, i, value, msg, arg);
+                break;
+            }
+            continue;
+        }
+
+        while ((next < schema->count) && args_is_option(&schema->table[next])) next++;
+        if (next >= schema->count) return args_fail(err, argc, argv, i, word, "too many arguments", NULL);
+
+        arg = &schema->table[next++];
+        msg = args_store(arg, word, base);
+        if (msg != NULL) return args_fail(err, argc, argv, i, word, msg, arg);
+    }
+
+    while ((next < schema->count) && args_is_option(&schema->table[next])) next++;
+    if (next < schema->count) return args_fail(err, argc, argv, argc, NULL, "missing argument", &schema->table[next]);
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Tell the column of the error, with a mark under the line just typed
+void shellArgsError(shellObject_t *pshell, char *argv[], const shell_args_err_t *err)
+{
+    const shell_arg_t *arg = err->arg;
+    uint32_t col;
+    uint8_t i;
+
+    /* argv in the edit line, as it was echoed above */
+    if (pshell->echo && !pshell->machine &&
+        (argv[0] >= pshell->line) && (argv[0] < &pshell->line[SHELL_BUFFER_LINE_LEN])) {
+        col = pshell->prompt_len + (argv[0] - pshell->line) + err->column - 1;
+        if (col < pshell->vt->ncols) shellPrintf(pshell, "%*s^\r\n", (int) col, "");
+    }
+
+    shellPrintf(pshell, "%s: col %u%s: %s", argv[0], err->column, shellExecExpanded(pshell) ? " once expanded" : "", err->msg);
+
+    if (arg != NULL) {
+        if (!args_is_option(arg)) shellPrintf(pshell, ", <%s>", arg->name);
+        else shellPrintf(pshell, ", --%s", arg->name);
+
+        if ((arg->type == SHELL_ARG_T_INT) || (arg->type == SHELL_ARG_T_UINT)) {
+            shellPrintf(pshell, " is %lld..%lld", (long long) arg->min, (long long) arg->max);
+        }
+        else if (arg->type == SHELL_ARG_T_ENUM) {
+            for (i = 0; arg->choices[i] != NULL; i++) {
+                shellPrintf(pshell, "%s%s", i ? "|" : " is ", arg->choices[i]);
+            }
+        }
+    }
+
+    shellPrintf(pshell, "\r\n");
+}
+
+
+//*****************************************************************************
+// Usage of a command, built from its table
+void shellArgsHelp(shellObject_t *pshell, const char *name, const shell_args_t *schema)
+{
+    const shell_arg_t *arg;
+    char label[48];
+    uint8_t i, j;
+
+    shellPrintf(pshell, "usage: %s", name);
+    for (i = 0; i < schema->count; i++) {
+        if (args_is_option(&schema->table[i])) {
+            shellPrintf(pshell, " [options]");
+            break;
+        }
+    }
+    for (i = 0; i < schema->count; i++) {
+        if (!args_is_option(&schema->table[i])) shellPrintf(pshell, " <%s>", schema->table[i].name);
+    }
+    shellPrintf(pshell, "\r\n");
+
+    for (i = 0; i < schema->count; i++) {
+        arg = &schema->table[i];
+
+        args_label(arg, label, sizeof(label));
+        shellPrintf(pshell, "  %-*s %s", SHELL_ARGS_HELP_WIDTH, label, (arg->help != NULL) ? arg->help : "");
+
+        if ((arg->type == SHELL_ARG_T_INT) || (arg->type == SHELL_ARG_T_UINT)) {
+            shellPrintf(pshell, " (%lld..%lld)", (long long) arg->min, (long long) arg->max);
+        }
+        else if (arg->type == SHELL_ARG_T_ENUM) {
+            for (j = 0; arg->choices[j] != NULL; j++) {
+                shellPrintf(pshell, "%s%s", j ? "|" : " (", arg->choices[j]);
+            }
+            shellPrintf(pshell, ")");
+        }
+
+        if (args_is_option(arg)) {
+            switch (arg->type) {
+                case SHELL_ARG_T_INT:
+                case SHELL_ARG_T_UINT: shellPrintf(pshell, ", %lld by default", (long long) arg->def); break;
+                case SHELL_ARG_T_BOOL: shellPrintf(pshell, ", %s by default", args_bools[arg->def ? 1 : 0]); break;
+                case SHELL_ARG_T_ENUM: shellPrintf(pshell, ", %s by default", arg->choices[arg->def]); break;
+                default: break;
+            }
+        }
+
+        shellPrintf(pshell, "\r\n");
+    }
+}
+
+
+//*****************************************************************************
+// What can follow argv and starts with prefix: the choices of the value
+// expected, or the option names, without their "--". The count found
+uint16_t shellArgsComplete(const shell_args_t *schema, int32_t argc, char *argv[], const char *prefix,
+                           const char **out, uint16_t max)
+{
+    const shell_arg_t *wants = NULL;
+    const shell_arg_t *arg;
+    const char *const *choices = NULL;
+    const char *name;
+    bool only_pos = false;
+    uint8_t npos = 0;
+    uint16_t count = 0;
+    size_t len;
+    int32_t i;
+
+    for (i = 1; i < argc; i++) {
+        const char *word = argv[i];
+
+        if (wants != NULL) {
+            wants = NULL;
+        }
+        else if (!only_pos && (word[0] == '-') && word[1] &&
+                 !((word[1] >= '0') && (word[1] <= '9') && (args_short(schema, word[1]) == NULL))) {
+            if (!strcmp(word, "--")) only_pos = true;
+            else wants = args_wants(schema, word);
+        }
+        else {
+            npos++;
+        }
+    }
+
+    /* the option names */
+    if ((wants == NULL) && !only_pos && (prefix[0] == '-')) {
+        if ((prefix[1] != '-') && prefix[1]) return 0;
+
+        name = prefix[1] ? &prefix[2] : "";
+        len = strlen(name);
+
+        for (i = 0; i < schema->count; i++) {
+            arg = &schema->table[i];
+            if (!args_is_option(arg) || strncmp(arg->name, name, len)) continue;
+
+            if (count < max) out[count] = arg->name;
+            count++;
+        }
+
+        return count;
+    }
+
+    /* or the choices of the value */
+    if (wants == NULL) {
+        for (i = 0; i < schema->count; i++) {
+            if (args_is_option(&schema->table[i])) continue;
+            if (!npos--) {
+                wants = &schema->table[i];
+                break;
+            }
+        }
+    }
+
+    if (wants == NULL) return 0;
+
+    if (wants->type == SHELL_ARG_T_ENUM) choices = wants->choices;
+    else if (wants->type == SHELL_ARG_T_BOOL) choices = args_bools;
+    else return 0;
+
+    /* on and off are enough for a bool */
+    len = strlen(prefix);
+    for (i = 0; (choices[i] != NULL) && ((choices != args_bools) || (i < 2)); i++) {
+        if (strncmp(choices[i], prefix, len)) continue;
+
+        if (count < max) out[count] = choices[i];
+        count++;
+    }
+
+    return count;
+}
+
+
+//*****************************************************************************
+// Decimal, 0x hexadecimal or 0b binary, signed, without the locale of strtol()
+s_err_t shellArgsNumber(const char *str, int64_t *value)
+{
+    uint64_t limit, number = 0;
+    bool minus = false;
+    uint8_t base = 10;
+    uint8_t digit;
+
+    if ((*str == '-') || (*str == '+')) minus = (*str++ == '-');
+
+    if ((str[0] == '0') && ((str[1] == 'x') || (str[1] == 'X'))) {
+        base = 16;
+        str += 2;
+    }
+    else if ((str[0] == '0') && ((str[1] == 'b') || (str[1] == 'B'))) {
+        base = 2;
+        str += 2;
+    }
+
+    if (!*str) return SYS_ERROR;
+
+    limit = minus ? (uint64_t) INT64_MAX + 1 : (uint64_t) INT64_MAX;
+
+    for (; *str; str++) {
+        if ((*str >= '0') && (*str <= '9')) digit = *str - '0';
+        else if ((*str >= 'a') && (*str <= 'f')) digit = *str - 'a' + 10;
+        else if ((*str >= 'A') && (*str <= 'F')) digit = *str - 'A' + 10;
+        else return SYS_ERROR;
+
+        if (digit >= base) return SYS_ERROR;
+        if (number > (limit - digit) / base) return SYS_ERROR;
+
+        number = number * base + digit;
+    }
+
+    *value = minus ? (int64_t) (0 - number) : (int64_t) number;
+
+    return SYS_EOK;
+}
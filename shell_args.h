@@ -0,0 +1,190 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_args.h
+* @details Typed arguments of the commands, declared once in a table
+*
+*   The arguments and options of a command are described by a table of
+*   shell_arg_t, each one stored in a field of the command structure.
+*   shellArgsCmd() is the handler of all these commands: it parses argv
+*   with the table of the command, checks the ranges and the choices and
+*   calls the typed handler with the filled structure, or tells the column
+*   of the first bad argument. "-h" and "--help" print the usage built
+*   from the same table, shellArgsComplete() gives what can follow.
+*
+*   struct led { int32_t pin; int32_t mode; int32_t count; bool verbose; };
+*   static const char *const led_modes[] = { "off", "on", "blink", NULL };
+*   static const shell_arg_t led_table[] = {
+*       SHELL_ARG_INT(struct led, pin, "pin", 0, 31, "Pin number"),
+*       SHELL_ARG_ENUM(struct led, mode, "mode", led_modes, "Led mode"),
+*       SHELL_OPT_INT('c', "count", struct led, count, 1, 1, 100, "Blinks"),
+*       SHELL_OPT_FLAG('v', "verbose", struct led, verbose, "Tell the steps"),
+*   };
+*   static int32_t led_run(shellObject_t *pshell, const void *args)
+*   {
+*       const struct led *led = args;
+*       ...
+*   }
+*   static const shell_args_t led_args = SHELL_ARGS(struct led, led_table, led_run);
+*
+*   { "led", shellArgsCmd, "Drive a led", &led_args },
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 23:58:16
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_ARGS_H
+#define _SHELL_ARGS_H
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef SHELL_ARGS_SIZE_MAX
+#define SHELL_ARGS_SIZE_MAX             128        //!< Largest structure of arguments
+#endif
+
+#ifndef SHELL_ARGS_HELP_WIDTH
+#define SHELL_ARGS_HELP_WIDTH           22         //!< Column of the help text in the usage
+#endif
+
+
+/*** Types of argument ***/
+#define SHELL_ARG_T_INT                 0          //!< int32_t
+#define SHELL_ARG_T_UINT                1          //!< uint32_t
+#define SHELL_ARG_T_BOOL                2          //!< bool, on/off, true/false, yes/no, 1/0
+#define SHELL_ARG_T_ENUM                3          //!< int32_t, index of the choice
+#define SHELL_ARG_T_STR                 4          //!< const char *, in the line
+#define SHELL_ARG_T_FLAG                5          //!< bool, an option without value
+
+
+/* offset of the field, which must have the size of the type */
+#define SHELL_ARG_FIELD(s, f, t)        (offsetof(s, f) + 0 * sizeof(char [1 - 2 * (sizeof(((s *) 0)->f) != sizeof(t))]))
+
+/*** Positional arguments, all needed, in the order of the table ***/
+#define SHELL_ARG_INT(s, f, name, min, max, help) \
+    { name, 0, SHELL_ARG_T_INT, SHELL_ARG_FIELD(s, f, int32_t), min, max, 0, NULL, help }
+#define SHELL_ARG_UINT(s, f, name, min, max, help) \
+    { name, 0, SHELL_ARG_T_UINT, SHELL_ARG_FIELD(s, f, uint32_t), min, max, 0, NULL, help }
+#define SHELL_ARG_BOOL(s, f, name, help) \
+    { name, 0, SHELL_ARG_T_BOOL, SHELL_ARG_FIELD(s, f, bool), 0, 1, 0, NULL, help }
+#define SHELL_ARG_ENUM(s, f, name, choices, help) \
+    { name, 0, SHELL_ARG_T_ENUM, SHELL_ARG_FIELD(s, f, int32_t), 0, 0, 0, choices, help }
+#define SHELL_ARG_STR(s, f, name, help) \
+    { name, 0, SHELL_ARG_T_STR, SHELL_ARG_FIELD(s, f, const char *), 0, 0, 0, NULL, help }
+
+#define SHELL_OPT_LONG                  '\1'       //!< opt of an option without short name
+
+/*** Options, -c value or --name value, def when not given ***/
+#define SHELL_OPT_INT(opt, name, s, f, def, min, max, help) \
+    { name, opt, SHELL_ARG_T_INT, SHELL_ARG_FIELD(s, f, int32_t), min, max, def, NULL, help }
+#define SHELL_OPT_UINT(opt, name, s, f, def, min, max, help) \
+    { name, opt, SHELL_ARG_T_UINT, SHELL_ARG_FIELD(s, f, uint32_t), min, max, def, NULL, help }
+#define SHELL_OPT_BOOL(opt, name, s, f, def, help) \
+    { name, opt, SHELL_ARG_T_BOOL, SHELL_ARG_FIELD(s, f, bool), 0, 1, def, NULL, help }
+#define SHELL_OPT_ENUM(opt, name, s, f, def, choices, help) \
+    { name, opt, SHELL_ARG_T_ENUM, SHELL_ARG_FIELD(s, f, int32_t), 0, 0, def, choices, help }
+#define SHELL_OPT_STR(opt, name, s, f, help) \
+    { name, opt, SHELL_ARG_T_STR, SHELL_ARG_FIELD(s, f, const char *), 0, 0, 0, NULL, help }
+#define SHELL_OPT_FLAG(opt, name, s, f, help) \
+    { name, opt, SHELL_ARG_T_FLAG, SHELL_ARG_FIELD(s, f, bool), 0, 1, 0, NULL, help }
+
+/* schema of a command, run is a shell_args_func_t, not cast: it takes the const void * */
+#define SHELL_ARGS(s, table, run) \
+    { run, table, sizeof(table) / sizeof((table)[0]), sizeof(s) }
+
+
+/**
+ * Handler, args points to the structure of the command, given to SHELL_ARGS()
+ */
+typedef int32_t (*shell_args_func_t)(shellObject_t *pshell, const void *args);
+
+/**
+ * Argument or option
+ */
+struct shell_arg
+{
+    const char          *name;                     //!< Long option, or name shown by the usage
+    char                opt;                       //!< Short option, SHELL_OPT_LONG, or 0 for a positional argument
+    uint8_t             type;                      //!< SHELL_ARG_T_INT...
+    uint16_t            offset;                    //!< Field in the structure
+    int64_t             min;                       //!< Range of the numbers
+    int64_t             max;
+    int64_t             def;                       //!< Value of an option not given
+    const char *const   *choices;                  //!< Enum, NULL terminated
+    const char          *help;
+};
+typedef struct shell_arg shell_arg_t;
+
+/**
+ * Arguments of a command
+ */
+struct shell_args
+{
+    shell_args_func_t   run;
+    const shell_arg_t   *table;
+    uint8_t             count;
+    uint16_t            size;                      //!< Of the structure, up to SHELL_ARGS_SIZE_MAX
+};
+typedef struct shell_args shell_args_t;
+
+/**
+ * Parse error
+ */
+struct shell_args_err
+{
+    int32_t             index;                     //!< Bad argv, or argc for a missing one
+    uint16_t            column;                    //!< From the start of the command name
+    const char          *msg;
+    const shell_arg_t   *arg;                      //!< Argument concerned, can be NULL
+};
+typedef struct shell_args_err shell_args_err_t;
+
+
+
+
+int32_t shellArgsCmd(shellObject_t *pshell, int32_t argc, char *argv[]);
+s_err_t shellArgsParse(const shell_args_t *schema, int32_t argc, char *argv[], void *args, shell_args_err_t *err);
+void shellArgsError(shellObject_t *pshell, char *argv[], const shell_args_err_t *err);
+void shellArgsHelp(shellObject_t *pshell, const char *name, const shell_args_t *schema);
+uint16_t shellArgsComplete(const shell_args_t *schema, int32_t argc, char *argv[], const char *prefix,
+                           const char **out, uint16_t max);
+s_err_t shellArgsNumber(const char *str, int64_t *value);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_ARGS_H */
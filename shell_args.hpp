@@ -0,0 +1,698 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_args.hpp
+* @details Typed arguments of the C++ commands, checked at compile time
+*
+*   The schema of a command lists the fields of its structure of
+*   arguments. It is built by the compiler: the short options index a
+*   table by their char, the long ones go through a perfect hash searched
+*   at compile time, a duplicated option or an enum without its choices
+*   doesn't compile. The defaults are the initializers of the structure.
+*
+*   struct Led { int pin; Mode mode; int count = 1; bool verbose = false; };
+*   constexpr std::string_view modes[] = { "off", "on", "blink" };
+*   constexpr auto led_schema = shell::schema<Led>(
+*       shell::arg<&Led::pin>("pin").range(0, 31).help("Pin number"),
+*       shell::arg<&Led::mode>("mode").oneOf(modes).help("Led mode"),
+*       shell::opt<&Led::count>('c', "count").range(1, 100).help("Blinks"),
+*       shell::opt<&Led::verbose>('v', "verbose").help("Tell the steps"));
+*   int32_t led(shell::Shell &shell, const Led &args);
+*
+*   { "led", shell::command<led_schema, led>, "Drive a led" },
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 23:58:16
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_ARGS_HPP
+#define _SHELL_ARGS_HPP
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "shell.hpp"
+#include "shell_args.h"
+
+
+namespace shell {
+
+
+namespace detail {
+
+template <typename M>
+struct Member;
+
+template <typename C, typename T>
+struct Member<T C::*>
+{
+    using Class = C;
+    using Type = T;
+};
+
+// words of a bool, the odd ones are true
+inline constexpr std::string_view bools[] = { "off", "on", "false", "true", "no", "yes", "0", "1" };
+
+template <typename T>
+constexpr int64_t lowest()
+{
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) return std::numeric_limits<T>::min();
+    else return 0;
+}
+
+template <typename T>
+constexpr int64_t highest()
+{
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+        if constexpr (sizeof(T) >= sizeof(int64_t)) return std::numeric_limits<int64_t>::max();
+        else return std::numeric_limits<T>::max();
+    }
+    else {
+        return 0;
+    }
+}
+
+constexpr uint32_t hash(uint32_t seed, std::string_view text)
+{
+    for (char c : text) seed = (seed ^ static_cast<uint8_t>(c)) * 16777619u;
+    return seed;
+}
+
+} // namespace detail
+
+
+/**
+ * Decimal, 0x hexadecimal or 0b binary, signed, without the locale.
+ * The view doesn't need to end with a 0, unlike shellArgsNumber()
+ */
+inline bool parseNumber(std::string_view text, int64_t &value) noexcept
+{
+    bool minus = false;
+    int base = 10;
+    uint64_t number;
+
+    if (!text.empty() && ((text[0] == '-') || (text[0] == '+'))) {
+        minus = (text[0] == '-');
+        text.remove_prefix(1);
+    }
+
+    if ((text.size() > 1) && (text[0] == '0') && ((text[1] | 0x20) == 'x')) base = 16;
+    else if ((text.size() > 1) && (text[0] == '0') && ((text[1] | 0x20) == 'b')) base = 2;
+    if (base != 10) text.remove_prefix(2);
+
+    if (text.empty()) return false;
+
+    auto res = std::from_chars(text.data(), text.data() + text.size(), number, base);
+    if ((res.ec != std::errc()) || (res.ptr != text.data() + text.size())) return false;
+
+    if (number > (minus ? uint64_t(INT64_MAX) + 1 : uint64_t(INT64_MAX))) return false;
+
+    value = minus ? int64_t(0 - number) : int64_t(number);
+    return true;
+}
+
+
+/**
+ * Argument or option stored in the field M. A bool option is a flag
+ */
+template <auto M>
+struct Arg
+{
+    using Class = typename detail::Member<decltype(M)>::Class;
+    using Type = typename detail::Member<decltype(M)>::Type;
+
+    static_assert(std::is_integral_v<Type> || std::is_enum_v<Type> || std::is_same_v<Type, std::string_view>,
+                  "an argument is a number, a bool, an enum or a string_view");
+
+    std::string_view    name;
+    char                opt = 0;                   //!< Short option, SHELL_OPT_LONG, or 0 for a positional argument
+    std::string_view    about;
+    int64_t             min = detail::lowest<Type>();
+    int64_t             max = detail::highest<Type>();
+    std::span<const std::string_view> choices;
+
+    constexpr Arg range(int64_t lo, int64_t hi) const
+    {
+        Arg a = *this;
+
+        a.min = lo;
+        a.max = hi;
+        return a;
+    }
+
+    constexpr Arg oneOf(std::span<const std::string_view> words) const
+    {
+        Arg a = *this;
+
+        a.choices = words;
+        return a;
+    }
+
+    constexpr Arg help(std::string_view text) const
+    {
+        Arg a = *this;
+
+        a.about = text;
+        return a;
+    }
+
+    // convert the value in its field, the error or nullptr
+    const char *store(std::string_view value, Class &out) const noexcept
+    {
+        if constexpr (std::is_same_v<Type, std::string_view>) {
+            out.*M = value;
+        }
+        else if constexpr (std::is_same_v<Type, bool>) {
+            if (opt) {
+                out.*M = true;
+                return nullptr;
+            }
+
+            for (std::size_t i = 0; i < std::size(detail::bools); i++) {
+                if (detail::bools[i] == value) {
+                    out.*M = i & 1;
+                    return nullptr;
+                }
+            }
+            return "not a bool";
+        }
+        else {
+            int64_t number = -1;
+
+            if (!choices.empty()) {
+                for (std::size_t i = 0; i < choices.size(); i++) {
+                    if (choices[i] == value) number = i;
+                }
+                if (number < 0) return "bad choice";
+            }
+            else {
+                if (!parseNumber(value, number)) return "not a number";
+                if ((number < min) || (number > max)) return "out of range";
+            }
+
+            out.*M = static_cast<Type>(number);
+        }
+
+        return nullptr;
+    }
+};
+
+// positional argument, needed
+template <auto M>
+consteval Arg<M> arg(std::string_view name)
+{
+    Arg<M> a;
+
+    a.name = name;
+    return a;
+}
+
+// option, -c value or --name value; without short name opt is SHELL_OPT_LONG
+template <auto M>
+consteval Arg<M> opt(char c, std::string_view name)
+{
+    Arg<M> a;
+
+    a.name = name;
+    a.opt = c;
+    return a;
+}
+
+
+/**
+ * Parse error
+ */
+struct ArgsError
+{
+    std::size_t         index;                     //!< Bad argument, or the count for a missing one
+    std::size_t         column;                    //!< From the start of the command name
+    const char          *msg;
+    int                 arg;                       //!< Entry concerned, -1 for none
+};
+
+
+/**
+ * Arguments of a command stored in the structure T
+ */
+template <typename T, typename... A>
+class Schema
+{
+    static_assert((std::is_same_v<typename A::Class, T> && ...), "the fields belong to the structure");
+    static_assert(sizeof...(A) < UINT8_MAX, "too many arguments");
+
+    static constexpr std::size_t N = sizeof...(A);
+    static constexpr std::size_t H = std::bit_ceil(2 * N + 1);    //!< Slots of the perfect hash
+
+public:
+    using Args = T;
+
+    consteval explicit Schema(A... args)
+        : args_(args...), names_{ args.name... }, opts_{ args.opt... },
+          flags_{ (args.opt && std::is_same_v<typename A::Type, bool>)... },
+          bools_{ (!args.opt && std::is_same_v<typename A::Type, bool>)... },
+          strings_{ std::is_same_v<typename A::Type, std::string_view>... },
+          choices_{ args.choices... }, min_{ args.min... }, max_{ args.max... }
+    {
+        if (((std::is_enum_v<typename A::Type> && args.choices.empty()) || ...)) throw "an enum needs its choices";
+
+        for (std::size_t i = 0; i < N; i++) {
+            uint8_t c = static_cast<uint8_t>(opts_[i]);
+
+            if (names_[i].empty()) throw "an argument needs a name";
+            if (c >= 128) throw "a short option is ASCII";
+            if (c <= static_cast<uint8_t>(SHELL_OPT_LONG)) continue;
+            if (shorts_[c]) throw "duplicated short option";
+            shorts_[c] = i + 1;
+        }
+
+        for (std::size_t i = 0; i < N; i++) {
+            for (std::size_t j = i + 1; j < N; j++) {
+                if (opts_[i] && opts_[j] && (names_[i] == names_[j])) throw "duplicated long option";
+            }
+        }
+
+        for (seed_ = 1; !place(); seed_++) {
+            if (seed_ > 0xFFF) throw "no perfect hash for the long options";
+        }
+    }
+
+    bool hasShort(char c) const noexcept { return (static_cast<uint8_t>(c) < 128) && shorts_[static_cast<uint8_t>(c)]; }
+
+    /**
+     * Fill out from the arguments, args[0] is the command name
+     */
+    bool parse(std::span<std::string_view> args, T &out, ArgsError &err) const noexcept
+    {
+        std::size_t next = 0;                      //Entry of the next positional
+        bool only_pos = false;
+        const char *msg;
+        int i;
+
+        out = T{};
+
+        for (std::size_t n = 1; n < args.size(); n++) {
+            std::string_view word = args[n];
+
+            if (!only_pos && isOption(word)) {
+                if (word == "--") {
+                    only_pos = true;
+                    continue;
+                }
+
+                if (word[1] == '-') {
+                    std::size_t eq = word.find('=');
+                    std::string_view value;
+
+                    i = findLong(word.substr(2, (eq == word.npos) ? word.npos : eq - 2));
+                    if (i < 0) return fail(err, args, n, word.data(), "unknown option", -1);
+
+                    if (flags_[i]) {
+                        if (eq != word.npos) return fail(err, args, n, &word[eq], "takes no value", i);
+                        store(i, word, out);
+                        continue;
+                    }
+
+                    if (eq != word.npos) value = word.substr(eq + 1);
+                    else if (n + 1 < args.size()) value = args[++n];
+                    else return fail(err, args, args.size(), nullptr, "missing value", i);
+
+                    msg = store(i, value, out);
+                    if (msg != nullptr) return fail(err, args, n, value.data(), msg, i);
+                    continue;
+                }
+
+                /* -vq flags together, -c5 or -c 5 */
+                for (std::size_t c = 1; c < word.size(); c++) {
+                    std::string_view value;
+
+                    i = findShort(word[c]);
+                    if (i < 0) return fail(err, args, n, &word[c], "unknown option", -1);
+
+                    if (flags_[i]) {
+                        store(i, word, out);
+                        continue;
+                    }
+
+                    if (c + 1 < word.size()) value = word.substr(c + 1);
+                    else if (n + 1 < args.size()) value = args[++n];
+                    else return fail(err, args, args.size(), nullptr, "missing value", i);
+
+                    msg = store(i, value, out);
+                    if (msg != nullptr) return fail(err, args, n, value.data(), msg, i);
+                    break;
+                }
+                continue;
+            }
+
+            while ((next < N) && opts_[next]) next++;
+            if (next >= N) return fail(err, args, n, word.data(), "too many arguments", -1);
+
+            msg = store(next, word, out);
+            if (msg != nullptr) return fail(err, args, n, word.data(), msg, next);
+            next++;
+        }
+
+        while ((next < N) && opts_[next]) next++;
+        if (next < N) return fail(err, args, args.size(), nullptr, "missing argument", next);
+
+        return true;
+    }
+
+    /**
+     * Tell the column of the error, with a mark under the line just typed
+     */
+    void error(Shell &shell, std::span<std::string_view> args, const ArgsError &err) const noexcept
+    {
+        shellObject_t *pshell = shell.get();
+        const char *start = args[0].data();
+
+        if (pshell->echo && !pshell->machine &&
+            (start >= pshell->line) && (start < &pshell->line[SHELL_BUFFER_LINE_LEN])) {
+            std::size_t col = pshell->prompt_len + (start - pshell->line) + err.column - 1;
+
+            if (col < pshell->vt->ncols) {
+                for (; col; col--) shell.print(' ');
+                shell.print("^\r\n");
+            }
+        }
+
+        shell.print(args[0], ": col ", err.column, shellExecExpanded(pshell) ? " once expanded: " : ": ", err.msg);
+
+        if (err.arg >= 0) {
+            if (opts_[err.arg]) shell.print(", --", names_[err.arg]);
+            else shell.print(", <", names_[err.arg], '>');
+
+            printRange(shell, err.arg, " is ", "");
+        }
+
+        shell.print("\r\n");
+    }
+
+    /**
+     * Usage of the command
+     */
+    void help(Shell &shell, std::string_view name) const noexcept
+    {
+        const T defaults{};
+
+        shell.print("usage: ", name);
+        for (std::size_t i = 0; i < N; i++) {
+            if (opts_[i]) {
+                shell.print(" [options]");
+                break;
+            }
+        }
+        for (std::size_t i = 0; i < N; i++) {
+            if (!opts_[i]) shell.print(" <", names_[i], '>');
+        }
+        shell.print("\r\n");
+
+        for (std::size_t i = 0; i < N; i++) {
+            std::size_t len;
+
+            visit(i, [&](const auto &arg) {
+                len = label(shell, i);
+                for (; len < SHELL_ARGS_HELP_WIDTH; len++) shell.print(' ');
+                shell.print(' ');
+                if (!arg.about.empty()) shell.print(arg.about);
+                printRange(shell, i, " (", ")");
+                if (opts_[i] && !flags_[i]) printDefault(shell, arg, defaults);
+            });
+            shell.print("\r\n");
+        }
+    }
+
+    /**
+     * What can follow the arguments and starts with prefix: the choices of
+     * the value expected, or the option names, without their "--"
+     */
+    std::size_t complete(std::span<std::string_view> args, std::string_view prefix,
+                         std::span<std::string_view> out) const noexcept
+    {
+        std::size_t count = 0;
+        std::size_t npos = 0;
+        bool only_pos = false;
+        int wants = -1;
+
+        for (std::size_t n = 1; n < args.size(); n++) {
+            std::string_view word = args[n];
+
+            if (wants >= 0) wants = -1;
+            else if (!only_pos && isOption(word)) {
+                if (word == "--") only_pos = true;
+                else wants = takesNext(word);
+            }
+            else npos++;
+        }
+
+        /* the option names */
+        if ((wants < 0) && !only_pos && prefix.starts_with('-')) {
+            if ((prefix.size() > 1) && (prefix[1] != '-')) return 0;
+
+            prefix.remove_prefix((prefix.size() > 1) ? 2 : 1);
+            for (std::size_t i = 0; i < N; i++) {
+                if (!opts_[i] || !names_[i].starts_with(prefix)) continue;
+                if (count < out.size()) out[count] = names_[i];
+                count++;
+            }
+            return count;
+        }
+
+        /* or the choices of the value */
+        for (std::size_t i = 0; (wants < 0) && (i < N); i++) {
+            if (!opts_[i] && !npos--) wants = i;
+        }
+        if (wants < 0) return 0;
+
+        std::span<const std::string_view> words = choices_[wants];
+        if (bools_[wants]) words = std::span<const std::string_view>(detail::bools, 2);
+
+        for (std::string_view word : words) {
+            if (!word.starts_with(prefix)) continue;
+            if (count < out.size()) out[count] = word;
+            count++;
+        }
+
+        return count;
+    }
+
+private:
+    // a negative number is an argument, unless the digit is an option
+    bool isOption(std::string_view word) const noexcept
+    {
+        return (word.size() > 1) && (word[0] == '-') &&
+               !((word[1] >= '0') && (word[1] <= '9') && !hasShort(word[1]));
+    }
+
+    int findShort(char c) const noexcept
+    {
+        return hasShort(c) ? shorts_[static_cast<uint8_t>(c)] - 1 : -1;
+    }
+
+    int findLong(std::string_view name) const noexcept
+    {
+        uint8_t i = slots_[detail::hash(seed_, name) & (H - 1)];
+
+        return (i && (names_[i - 1] == name)) ? i - 1 : -1;
+    }
+
+    // option of the word which takes the next word as its value, or -1
+    int takesNext(std::string_view word) const noexcept
+    {
+        int i;
+
+        if (word[1] == '-') {
+            if (word.find('=') != word.npos) return -1;
+
+            i = findLong(word.substr(2));
+            return ((i >= 0) && !flags_[i]) ? i : -1;
+        }
+
+        for (std::size_t c = 1; c < word.size(); c++) {
+            i = findShort(word[c]);
+            if (i < 0) return -1;
+            if (!flags_[i]) return (c + 1 == word.size()) ? i : -1;
+        }
+
+        return -1;
+    }
+
+    // the long options in the slots of the hash, false on a collision
+    consteval bool place()
+    {
+        slots_ = {};
+
+        for (std::size_t i = 0; i < N; i++) {
+            if (!opts_[i]) continue;
+
+            uint8_t &slot = slots_[detail::hash(seed_, names_[i]) & (H - 1)];
+            if (slot) return false;
+            slot = i + 1;
+        }
+
+        return true;
+    }
+
+    // the entry i of the tuple, a switch once compiled
+    template <typename F>
+    void visit(std::size_t i, F &&func) const noexcept
+    {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (void) (((i == I) && (func(std::get<I>(args_)), true)) || ...);
+        }(std::index_sequence_for<A...>{});
+    }
+
+    const char *store(std::size_t i, std::string_view value, T &out) const noexcept
+    {
+        const char *msg = nullptr;
+
+        visit(i, [&](const auto &arg) { msg = arg.store(value, out); });
+        return msg;
+    }
+
+    bool fail(ArgsError &err, std::span<std::string_view> args, std::size_t index, const char *at,
+              const char *msg, int arg) const noexcept
+    {
+        std::string_view last = args.back();
+
+        err.index = index;
+        err.msg = msg;
+        err.arg = arg;
+        err.column = ((at != nullptr) ? at : last.data() + last.size()) - args[0].data() + 1;
+
+        return false;
+    }
+
+    // -c, --count <n> or <pin>, its width
+    std::size_t label(Shell &shell, std::size_t i) const noexcept
+    {
+        std::string_view value = flags_[i] ? "" : strings_[i] ? " <str>" : !choices_[i].empty() ? " <choice>" :
+                                 bools_[i] ? " <on|off>" : " <n>";
+
+        shell.print("  ");
+
+        if (!opts_[i]) {
+            shell.print('<', names_[i], '>');
+            return names_[i].size() + 2;
+        }
+
+        if (opts_[i] == SHELL_OPT_LONG) shell.print("    --", names_[i], value);
+        else shell.print('-', opts_[i], ", --", names_[i], value);
+
+        return 6 + names_[i].size() + value.size();
+    }
+
+    void printRange(Shell &shell, std::size_t i, std::string_view open, std::string_view close) const noexcept
+    {
+        if (!choices_[i].empty()) {
+            for (std::size_t c = 0; c < choices_[i].size(); c++) shell.print(c ? "|" : open, choices_[i][c]);
+            shell.print(close);
+        }
+        else if (!flags_[i] && !bools_[i] && !strings_[i]) {
+            shell.print(open, min_[i], "..", max_[i], close);
+        }
+    }
+
+    template <typename Entry>
+    void printDefault(Shell &shell, const Entry &arg, const T &defaults) const noexcept
+    {
+        using Type = typename Entry::Type;
+        const Type &value = defaults.*memberOf(arg);
+
+        if constexpr (std::is_same_v<Type, std::string_view>) {
+            if (!value.empty()) shell.print(", ", value, " by default");
+        }
+        else if constexpr (std::is_same_v<Type, bool>) {
+            shell.print(", ", detail::bools[value ? 1 : 0], " by default");
+        }
+        else if (!arg.choices.empty()) {
+            auto index = static_cast<std::size_t>(value);
+            if (index < arg.choices.size()) shell.print(", ", arg.choices[index], " by default");
+        }
+        else {
+            shell.print(", ", static_cast<int64_t>(value), " by default");
+        }
+    }
+
+    template <auto M>
+    static constexpr auto memberOf(const Arg<M> &) noexcept { return M; }
+
+    std::tuple<A...>    args_;
+    std::array<std::string_view, N> names_;
+    std::array<char, N> opts_;
+    std::array<bool, N> flags_;                    //!< Options without value
+    std::array<bool, N> bools_;                    //!< Positional bools, on or off
+    std::array<bool, N> strings_;
+    std::array<std::span<const std::string_view>, N> choices_;
+    std::array<int64_t, N> min_;
+    std::array<int64_t, N> max_;
+    std::array<uint8_t, 128> shorts_{};            //!< Entry + 1 of each short option
+    std::array<uint8_t, H> slots_{};               //!< Entry + 1 of each long option
+    uint32_t            seed_ = 1;
+};
+
+
+template <typename T, typename... A>
+consteval Schema<T, A...> schema(A... args)
+{
+    return Schema<T, A...>(args...);
+}
+
+
+/**
+ * Handler of a command with a schema: parse, check, then Run(shell, args)
+ */
+template <const auto &S, auto Run>
+int32_t command(Shell &shell, std::span<std::string_view> args) noexcept
+{
+    typename std::remove_cvref_t<decltype(S)>::Args parsed;
+    ArgsError err;
+
+    /* unless the command took them */
+    if ((args.size() > 1) && ((args[1] == "--help") || ((args[1] == "-h") && !S.hasShort('h')))) {
+        S.help(shell, args[0]);
+        return SYS_EOK;
+    }
+
+    if (!S.parse(args, parsed, err)) {
+        S.error(shell, args, err);
+        return SYS_ERROR;
+    }
+
+    return Run(shell, parsed);
+}
+
+
+} // namespace shell
+
+#endif /* _SHELL_ARGS_HPP */
@@ -0,0 +1,333 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_basic.hpp
+* @details Shell terminal configured by template arguments
+*
+*   BasicShell<LineCap, HistCap, EchoPolicy, IoPolicy, KeymapPolicy, Prompt>
+*   is a session of shell.c set up from its arguments when it's opened:
+*   the line and the history are limited to LineCap - 1 chars and HistCap
+*   lines, the echo and the prompt are given to the session. The editing,
+*   the bracketed paste, the highlight and the busy state are the ones of
+*   shell.c, reached through shell(); the options are applied at run time
+*   as for any session, nothing is removed from the build.
+*
+*   The input goes from IoPolicy to the session in blocks. The keys the
+*   keymap maps to Key::None are taken out of it on the way, whole escape
+*   sequences included. The answers of the terminal and the bracketed
+*   paste always go through.
+*
+*   using McuShell  = shell::BasicShell<32, 0, shell::EchoOff, UartIo, shell::MinimalKeymap>;
+*   using HostShell = shell::BasicShell<100, 10, shell::EchoOn, shell::FdIo, shell::DefaultKeymap, "host> ">;
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 14:05:37
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_BASIC_HPP
+#define _SHELL_BASIC_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include <unistd.h>
+
+#include "shell.h"
+#include "shell.hpp"
+
+
+namespace shell {
+
+
+/**
+ * Prompt given as template argument, its width is a constant
+ */
+template <std::size_t N>
+struct Prompt
+{
+    char text[N];
+
+    constexpr Prompt(const char (&str)[N])
+    {
+        for (std::size_t i = 0; i < N; i++) text[i] = str[i];
+    }
+};
+
+
+/*** Echo Policies ***/
+struct EchoOn
+{
+    static constexpr bool enabled = true;
+};
+
+struct EchoOff
+{
+    static constexpr bool enabled = false;
+};
+
+
+/*** Editing actions, None drops the key ***/
+enum class Key : uint8_t
+{
+    None,
+    Insert,
+    Tab,
+    Erase,
+    Left,
+    Right,
+    Prev,
+    Next,
+    Return,
+    Enter,
+    Cancel,
+    Clear
+};
+
+
+/*** Keymap Policies ***/
+struct DefaultKeymap
+{
+    static constexpr Key map(int32_t ch)
+    {
+        switch (ch) {
+            case KB_LEFT:   return Key::Left;
+            case KB_RIGHT:  return Key::Right;
+            case KB_UP:     return Key::Prev;
+            case KB_DOWN:   return Key::Next;
+            case KEY_CR:    return Key::Return;
+            case KEY_LF:    return Key::Enter;
+            case KEY_ETX:   return Key::Cancel;
+            case KEY_FF:    return Key::Clear;
+            case KEY_HT:    return Key::Tab;
+            case KEY_DEL:
+            case KEY_BS:    return Key::Erase;
+        }
+
+        return ((ch >= ' ') && (ch < KEY_DEL)) ? Key::Insert : Key::None;
+    }
+};
+
+// Line input only, for the smallest targets
+struct MinimalKeymap
+{
+    static constexpr Key map(int32_t ch)
+    {
+        switch (ch) {
+            case KEY_LF:    return Key::Enter;
+            case KEY_DEL:
+            case KEY_BS:    return Key::Erase;
+        }
+
+        return ((ch >= ' ') && (ch < KEY_DEL)) ? Key::Insert : Key::None;
+    }
+};
+
+
+/*** I/O Policies ***/
+struct StdioIo
+{
+    FILE    *in;
+    FILE    *out;
+
+    // a char at a time, as shell_io_file
+    int32_t read(uint8_t *buf, std::size_t len)
+    {
+        int32_t ch = fgetc(in);
+
+        clearerr(in);
+        if (!len || (ch == EOF)) return 0;
+
+        buf[0] = static_cast<uint8_t>(ch);
+        return 1;
+    }
+
+    void write(const char *data, std::size_t len) { fwrite(data, 1, len, out); }
+};
+
+struct FdIo
+{
+    int     in;
+    int     out;
+
+    int32_t read(uint8_t *buf, std::size_t len)
+    {
+        ssize_t n = ::read(in, buf, len);
+
+        return (n > 0) ? static_cast<int32_t>(n) : 0;
+    }
+
+    void write(const char *data, std::size_t len)
+    {
+        while (len) {
+            ssize_t n = ::write(out, data, len);
+
+            if (n <= 0) return;
+            data += n;
+            len -= n;
+        }
+    }
+};
+
+// Any shell_io_t backend, the ring of a UART for instance
+struct BackendIo
+{
+    const shell_io_t    *io;
+    void                *ctx;
+
+    int32_t read(uint8_t *buf, std::size_t len)
+    {
+        int32_t n = io->read(ctx, buf, len);
+
+        return (n > 0) ? n : 0;
+    }
+
+    void write(const char *data, std::size_t len)
+    {
+        while (len) {
+            int32_t n = io->write(ctx, reinterpret_cast<const uint8_t *>(data), len);
+
+            if (n < 0) return;
+            data += n;
+            len -= n;
+        }
+    }
+};
+
+
+/**
+ * Session of shell.c set up by the template arguments
+ */
+template <std::size_t LineCap, std::size_t HistCap, typename EchoPolicy, typename IoPolicy,
+          typename KeymapPolicy = DefaultKeymap, Prompt P = "> ">
+class BasicShell
+{
+    static_assert(LineCap > 1, "the line holds at least one char");
+    static_assert(LineCap <= SHELL_BUFFER_LINE_LEN, "the line is held by the session, see SHELL_BUFFER_LINE_LEN");
+    static_assert(HistCap <= SHELL_HISTORY_LINES, "the history is held by the session, see SHELL_HISTORY_LINES");
+
+public:
+    template <typename... A>
+    explicit BasicShell(A &&...args) : io_{std::forward<A>(args)...}
+    {
+        vtInit(&keys_, SHELL_DEFAULT_NROWS, SHELL_DEFAULT_NCOLS);
+
+        shell_.reset(shellOpenIo(&backend_, this, P.text, nullptr));
+        if (shell_) shellSetLimits(shell_.get(), LineCap - 1, HistCap);
+    }
+
+    // the backend of the session points to this object
+    BasicShell(const BasicShell &) = delete;
+    BasicShell &operator=(const BasicShell &) = delete;
+
+    explicit operator bool() const noexcept { return static_cast<bool>(shell_); }
+    IoPolicy &io() { return io_; }
+    vt100_t &vt() { return *shell_.get()->vt; }
+    Shell &shell() { return shell_; }
+
+    void start() { shell_.init(EchoPolicy::enabled); }
+
+    /**
+     * Read up to a complete line or the end of the input. The view is
+     * valid until the next call.
+     */
+    std::optional<std::string_view> readLine() { return shell_.readLine(); }
+
+    void setSize(uint16_t nrows, uint16_t ncols) { shellSetSize(shell_.get(), nrows, ncols); }
+
+private:
+    // what is left of the input once the keymap took its keys out
+    int32_t filter(uint8_t *buf, std::size_t len)
+    {
+        uint8_t raw[SHELL_IN_BUFFER_LEN];
+        std::size_t n, i, out = 0;
+        int32_t ch;
+
+        /* a block taken out whole isn't the end of the input, read on */
+        while (!out) {
+            /* the start of a sequence kept goes out with its end */
+            if (len <= esc_len_) return 0;
+            n = len - esc_len_;
+            if (n > sizeof(raw)) n = sizeof(raw);
+
+            ch = io_.read(raw, n);
+            if (ch <= 0) return 0;
+            n = ch;
+
+            for (i = 0; i < n; i++) {
+                ch = vtProcessChar(&keys_, raw[i]);
+
+                /* inside a sequence, a longer one than known goes as it is */
+                if (ch == EOF) {
+                    if (esc_len_ == sizeof(esc_)) {
+                        for (std::size_t k = 0; k < esc_len_; k++) buf[out++] = esc_[k];
+                        esc_len_ = 0;
+                    }
+                    esc_[esc_len_++] = raw[i];
+                    continue;
+                }
+
+                if (ch == VT_EVT_PASTE_BEGIN) paste_ = true;
+                else if (ch == VT_EVT_PASTE_END) paste_ = false;
+
+                /* the answers and the events aren't keys, a paste is taken whole */
+                if (paste_ || !ch || (ch >= VT_EVT_SIZE) || (KeymapPolicy::map(ch) != Key::None)) {
+                    for (std::size_t k = 0; k < esc_len_; k++) buf[out++] = esc_[k];
+                    buf[out++] = raw[i];
+                }
+                esc_len_ = 0;
+            }
+        }
+
+        return static_cast<int32_t>(out);
+    }
+
+    static int32_t ioRead(void *ctx, uint8_t *buf, std::size_t len)
+    {
+        return static_cast<BasicShell *>(ctx)->filter(buf, len);
+    }
+
+    static int32_t ioWrite(void *ctx, const uint8_t *buf, std::size_t len)
+    {
+        static_cast<BasicShell *>(ctx)->io_.write(reinterpret_cast<const char *>(buf), len);
+
+        return static_cast<int32_t>(len);
+    }
+
+    static constexpr shell_io_t backend_ = { ioRead, ioWrite, nullptr };
+
+    [[no_unique_address]] IoPolicy io_;
+    vt100_t             keys_;                     //!< Parser of the keymap, apart from the one of the session
+    uint8_t             esc_[SHELL_IN_BUFFER_LEN / 2];
+    uint8_t             esc_len_ = 0;
+    bool                paste_ = false;
+    Shell               shell_;
+};
+
+
+} // namespace shell
+
+#endif /* _SHELL_BASIC_HPP */
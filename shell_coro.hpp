@@ -0,0 +1,394 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_coro.hpp
+* @details C++20 coroutine front end of the shell terminal
+*
+*   A session is driven by a reactor instead of a thread blocked in
+*   shellEngine(): an idle console only costs its coroutine frame and
+*   its shellObject_t.
+*
+*   shell::Task console(shellObject_t *pshell, shell::Reactor &reactor, int fd)
+*   {
+*       shell::Console con(pshell, reactor, fd, fd);
+*
+*       while (auto line = co_await con.readLine()) {
+*           co_await con.write("ok\r\n");
+*       }
+*   }
+*
+*   The session is opened on the descriptors with the shell_io_fd
+*   backend, and they must be non-blocking.
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 10:02:11
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_CORO_HPP
+#define _SHELL_CORO_HPP
+
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "shell.h"
+
+
+#ifndef SHELL_CORO_EVENTS
+#define SHELL_CORO_EVENTS               64         //!< Events read by one epoll_wait()
+#endif
+
+
+namespace shell {
+
+
+enum class Event
+{
+    Read,
+    Write
+};
+
+
+/**
+ * Something waiting a descriptor, called by the reactor once it's ready
+ */
+class Waiter
+{
+public:
+    virtual void ready() = 0;
+
+protected:
+    ~Waiter() = default;
+};
+
+
+/**
+ * Reactor interface, a waiter is called once per watch()
+ */
+class Reactor
+{
+public:
+    virtual ~Reactor() = default;
+
+    virtual void watch(int fd, Event ev, Waiter &waiter) = 0;
+    virtual void forget(int fd) = 0;
+};
+
+
+/**
+ * Fire and forget coroutine, the frame is released when it returns
+ */
+struct Task
+{
+    struct promise_type
+    {
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+
+/**
+ * Default reactor on epoll, one shot registrations
+ */
+class EpollReactor : public Reactor
+{
+public:
+    EpollReactor() : epfd_(epoll_create1(EPOLL_CLOEXEC)) {}
+    ~EpollReactor() override { if (epfd_ >= 0) ::close(epfd_); }
+
+    EpollReactor(const EpollReactor &) = delete;
+    EpollReactor &operator=(const EpollReactor &) = delete;
+
+    bool valid() const { return epfd_ >= 0; }
+    std::size_t pending() const { return pending_; }
+
+    void watch(int fd, Event ev, Waiter &waiter) override
+    {
+        if (fd < 0) return;
+        if (static_cast<std::size_t>(fd) >= fds_.size()) fds_.resize(fd + 1);
+
+        Slot &slot = fds_[fd];
+        Waiter *&w = (ev == Event::Read) ? slot.read : slot.write;
+
+        if (w == nullptr) pending_++;
+        w = &waiter;
+
+        arm(fd, slot);
+    }
+
+    void forget(int fd) override
+    {
+        if ((fd < 0) || (static_cast<std::size_t>(fd) >= fds_.size())) return;
+
+        Slot &slot = fds_[fd];
+
+        pending_ -= (slot.read != nullptr) + (slot.write != nullptr);
+        if (slot.registered) epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+        slot = Slot();
+    }
+
+    // Wait the descriptors and call their waiters, return the number called
+    int runOnce(int timeout_ms = -1)
+    {
+        epoll_event events[SHELL_CORO_EVENTS];
+        int n;
+
+        do {
+            n = epoll_wait(epfd_, events, SHELL_CORO_EVENTS, timeout_ms);
+        } while ((n < 0) && (errno == EINTR));
+
+        int called = 0;
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            Slot &slot = fds_[fd];
+            Waiter *rd = nullptr;
+            Waiter *wr = nullptr;
+
+            /* one shot, it's disarmed */
+            slot.armed = 0;
+
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) std::swap(rd, slot.read);
+            if (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) std::swap(wr, slot.write);
+            pending_ -= (rd != nullptr) + (wr != nullptr);
+
+            /* the other direction is still waited */
+            arm(fd, slot);
+
+            if (rd != nullptr) { rd->ready(); called++; }
+            if (wr != nullptr) { wr->ready(); called++; }
+        }
+
+        return called;
+    }
+
+    // Run until nothing is waited
+    void run()
+    {
+        while (pending_ && (runOnce() >= 0)) {}
+    }
+
+private:
+    struct Slot
+    {
+        Waiter      *read = nullptr;
+        Waiter      *write = nullptr;
+        uint32_t    armed = 0;
+        bool        registered = false;
+    };
+
+    void arm(int fd, Slot &slot)
+    {
+        epoll_event ev{};
+        uint32_t mask = (slot.read ? uint32_t(EPOLLIN) : 0u) | (slot.write ? uint32_t(EPOLLOUT) : 0u);
+
+        if (!mask || (mask == slot.armed)) return;
+
+        ev.events = mask | EPOLLONESHOT;
+        ev.data.fd = fd;
+
+        if (slot.registered) {
+            epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &ev);
+        }
+        else {
+            epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev);
+            slot.registered = true;
+        }
+        slot.armed = mask;
+    }
+
+    int                 epfd_;
+    std::size_t         pending_ = 0;
+    std::vector<Slot>   fds_;               //!< Indexed by descriptor, no allocation per wait
+};
+
+
+/**
+ * Awaitable session
+ */
+class Console
+{
+public:
+    Console(shellObject_t *pshell, Reactor &reactor, int in_fd, int out_fd)
+        : pshell_(pshell), reactor_(reactor), in_fd_(in_fd), out_fd_(out_fd) {}
+
+    Console(const Console &) = delete;
+    Console &operator=(const Console &) = delete;
+
+    shellObject_t *get() const { return pshell_; }
+    bool closed() const { return closed_; }
+
+    /**
+     * Complete line, valid until the next readLine(), nullopt once the
+     * input is closed
+     */
+    class LineAwaiter : private Waiter
+    {
+    public:
+        explicit LineAwaiter(Console &con) : con_(con) {}
+
+        bool await_ready() { return poll(); }
+
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            handle_ = h;
+            con_.reactor_.watch(con_.in_fd_, Event::Read, *this);
+        }
+
+        std::optional<std::string_view> await_resume() const
+        {
+            if (line_ == nullptr) return std::nullopt;
+            return std::string_view(line_);
+        }
+
+    private:
+        bool poll()
+        {
+            line_ = con_.engine();
+            return (line_ != nullptr) || con_.closed_;
+        }
+
+        void ready() override
+        {
+            /* a partial line, wait more */
+            if (!poll()) con_.reactor_.watch(con_.in_fd_, Event::Read, *this);
+            else handle_.resume();
+        }
+
+        Console                 &con_;
+        char                    *line_ = nullptr;
+        std::coroutine_handle<> handle_;
+    };
+
+    /**
+     * Write after the pending shell output, true once all is written
+     */
+    class WriteAwaiter : private Waiter
+    {
+    public:
+        WriteAwaiter(Console &con, std::string_view data) : con_(con), data_(data) {}
+
+        bool await_ready() { return flush(); }
+
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            handle_ = h;
+            con_.reactor_.watch(con_.out_fd_, Event::Write, *this);
+        }
+
+        bool await_resume() const { return data_.empty(); }
+
+    private:
+        // false while the descriptor is full
+        bool flush()
+        {
+            /* the shell output goes first */
+            while (con_.pshell_->out_len) {
+                uint16_t len = con_.pshell_->out_len;
+
+                if (shellFlush(con_.pshell_) != SYS_EOK) {
+                    con_.closed_ = true;
+                    return true;
+                }
+                if (con_.pshell_->out_len == len) return false;
+            }
+
+            while (!data_.empty()) {
+                ssize_t n = ::write(con_.out_fd_, data_.data(), data_.size());
+
+                if (n > 0) {
+                    data_.remove_prefix(n);
+                }
+                else if ((n < 0) && (errno == EINTR)) {
+                    continue;
+                }
+                else if ((n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+                    return false;
+                }
+                else {
+                    con_.closed_ = true;
+                    return true;
+                }
+            }
+
+            return true;
+        }
+
+        void ready() override
+        {
+            if (!flush()) con_.reactor_.watch(con_.out_fd_, Event::Write, *this);
+            else handle_.resume();
+        }
+
+        Console                 &con_;
+        std::string_view        data_;
+        std::coroutine_handle<> handle_;
+    };
+
+    LineAwaiter readLine() { return LineAwaiter(*this); }
+    WriteAwaiter write(std::string_view data) { return WriteAwaiter(*this, data); }
+
+private:
+    // run the engine until a line or the end of the input
+    char *engine()
+    {
+        for (;;) {
+            uint8_t state = pshell_->state;
+            bool reading = (state == SHELL_STATE_READY) || (state == SHELL_STATE_BUSY) ||
+                           (state == SHELL_STATE_PAGER) || (state == SHELL_STATE_XFER);
+            char *line = shellEngine(pshell_);
+
+            if (line != nullptr) return line;
+
+            if (reading) {
+                /* nothing more to read, or the peer is gone */
+                closed_ = pshell_->eof;
+                return nullptr;
+            }
+        }
+    }
+
+    shellObject_t       *pshell_;
+    Reactor             &reactor_;
+    int                 in_fd_;
+    int                 out_fd_;
+    bool                closed_ = false;
+};
+
+
+} // namespace shell
+
+#endif /* _SHELL_CORO_HPP */
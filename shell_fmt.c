@@ -0,0 +1,509 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_fmt.c
+* @details Formatter of shellPrintf(), a subset of printf without heap
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 02:26:51
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shell_fmt.h"
+
+
+
+
+
+#define FMT_LEFT                        0x01       //!< '-'
+#define FMT_ZERO                        0x02       //!< '0'
+#define FMT_PLUS                        0x04       //!< '+'
+#define FMT_SPACE                       0x08       //!< ' '
+#define FMT_ALT                         0x10       //!< '#'
+
+#define FMT_LEN_INT                     0
+#define FMT_LEN_CHAR                    1          //!< hh
+#define FMT_LEN_SHORT                   2          //!< h
+#define FMT_LEN_LONG                    3          //!< l
+#define FMT_LEN_LLONG                   4          //!< ll
+#define FMT_LEN_SIZE                    5          //!< z
+#define FMT_LEN_MAX                     6          //!< j
+#define FMT_LEN_PTRDIFF                 7          //!< t
+#define FMT_LEN_LDOUBLE                 8          //!< L
+
+#define FMT_DIGITS_LEN                  24         //!< Octal of 64 bits, prefix
+#define FMT_FLOAT_LEN                   352        //!< %f of DBL_MAX
+#define FMT_PAD_LEN                     16
+
+
+/**
+ * Conversion being written
+ */
+struct fmt_spec
+{
+    uint8_t             flags;
+    uint8_t             len;
+    int                 width;
+    int                 prec;                      //!< -1 without
+};
+
+/**
+ * Pieces of the output gathered for the writer
+ */
+struct fmt_out
+{
+    shell_fmt_put_t     put;
+    void                *ctx;
+    size_t              len;
+    char                chunk[SHELL_FMT_CHUNK];
+};
+
+/**
+ * Writer of shellVsnprintf()
+ */
+struct fmt_buf
+{
+    char                *buf;
+    size_t              size;
+    size_t              len;
+};
+
+
+
+//Declare Prototype
+static inline void fmt_put(struct fmt_out *out, const char *data, size_t len);
+static void fmt_flush(struct fmt_out *out);
+static void fmt_pad(struct fmt_out *out, char c, int count);
+static int fmt_int(struct fmt_out *out, const struct fmt_spec *spec, char conv, uint64_t value, bool neg);
+static int fmt_text(struct fmt_out *out, const struct fmt_spec *spec, const char *str, size_t len);
+static int fmt_str(struct fmt_out *out, const struct fmt_spec *spec, const char *str);
+static int fmt_float(struct fmt_out *out, const struct fmt_spec *spec, char conv, va_list *args);
+static void fmt_buf_put(void *ctx, const char *data, size_t len);
+
+
+
+static const char fmt_spaces[FMT_PAD_LEN + 1] = "                ";
+static const char fmt_zeros[FMT_PAD_LEN + 1] = "0000000000000000";
+
+/* two decimal digits at a time */
+static const char fmt_dec[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+// the writer is called once the chunk is full, a larger piece goes as it is
+static inline void fmt_put(struct fmt_out *out, const char *data, size_t len)
+{
+    if (len > sizeof(out->chunk) - out->len) {
+        fmt_flush(out);
+
+        if (len > sizeof(out->chunk)) {
+            out->put(out->ctx, data, len);
+            return;
+        }
+    }
+
+    memcpy(&out->chunk[out->len], data, len);
+    out->len += len;
+}
+
+
+static void fmt_flush(struct fmt_out *out)
+{
+    if (out->len) out->put(out->ctx, out->chunk, out->len);
+    out->len = 0;
+}
+
+
+//*****************************************************************************
+static void fmt_pad(struct fmt_out *out, char c, int count)
+{
+    const char *pad = (c == '0') ? fmt_zeros : fmt_spaces;
+
+    for (; count > 0; count -= FMT_PAD_LEN) {
+        fmt_put(out, pad, (count < FMT_PAD_LEN) ? count : FMT_PAD_LEN);
+    }
+}
+
+
+//*****************************************************************************
+// integer of d i u o x X p, the digits from the end of a buffer
+static int fmt_int(struct fmt_out *out, const struct fmt_spec *spec, char conv, uint64_t value, bool neg)
+{
+    char digits[FMT_DIGITS_LEN];
+    char *end = &digits[sizeof(digits)];
+    char *at = end;
+    const char *hex = (conv == 'X') ? "0123456789ABCDEF" : "0123456789abcdef";
+    char prefix[2];
+    int nprefix = 0, ndigits, zeros = 0, pad, total;
+
+    if ((conv == 'x') || (conv == 'X') || (conv == 'p')) {
+        for (; value; value >>= 4) *--at = hex[value & 0xF];
+    }
+    else if (conv == 'o') {
+        for (; value; value >>= 3) *--at = '0' + (value & 7);
+    }
+    else {
+        for (; value >= 100; value /= 100) {
+            at -= 2;
+            memcpy(at, &fmt_dec[(value % 100) * 2], 2);
+        }
+        if (value >= 10) {
+            at -= 2;
+            memcpy(at, &fmt_dec[value * 2], 2);
+        }
+        else if (value) {
+            *--at = '0' + value;
+        }
+    }
+
+    /* 0 has a digit, but with a precision of 0 */
+    if ((at == end) && (spec->prec != 0)) *--at = '0';
+    ndigits = end - at;
+
+    if (neg) prefix[nprefix++] = '-';
+    else if (spec->flags & FMT_PLUS) prefix[nprefix++] = '+';
+    else if (spec->flags & FMT_SPACE) prefix[nprefix++] = ' ';
+
+    if (((spec->flags & FMT_ALT) && ((conv == 'x') || (conv == 'X')) && ndigits && (*at != '0')) || (conv == 'p')) {
+        prefix[nprefix++] = '0';
+        prefix[nprefix++] = (conv == 'X') ? 'X' : 'x';
+    }
+    else if ((spec->flags & FMT_ALT) && (conv == 'o') && ((at == end) || (*at != '0'))) {
+        *--at = '0';
+        ndigits++;
+    }
+
+    if (spec->prec > ndigits) zeros = spec->prec - ndigits;
+
+    total = nprefix + zeros + ndigits;
+    pad = (spec->width > total) ? spec->width - total : 0;
+
+    /* the zero flag fills the width, unless there's a precision */
+    if ((spec->flags & FMT_ZERO) && !(spec->flags & FMT_LEFT) && (spec->prec < 0)) {
+        zeros += pad;
+        pad = 0;
+    }
+
+    if (!(spec->flags & FMT_LEFT)) fmt_pad(out, ' ', pad);
+    if (nprefix) fmt_put(out, prefix, nprefix);
+    fmt_pad(out, '0', zeros);
+    if (ndigits) fmt_put(out, at, ndigits);
+    if (spec->flags & FMT_LEFT) fmt_pad(out, ' ', pad);
+
+    return total + pad;
+}
+
+
+//*****************************************************************************
+static int fmt_text(struct fmt_out *out, const struct fmt_spec *spec, const char *str, size_t len)
+{
+    int pad = ((size_t) spec->width > len) ? spec->width - (int) len : 0;
+
+    if (!(spec->flags & FMT_LEFT)) fmt_pad(out, ' ', pad);
+    if (len) fmt_put(out, str, len);
+    if (spec->flags & FMT_LEFT) fmt_pad(out, ' ', pad);
+
+    return len + pad;
+}
+
+
+//*****************************************************************************
+// %s, up to the precision
+static int fmt_str(struct fmt_out *out, const struct fmt_spec *spec, const char *str)
+{
+    const char *end;
+
+    if (str == NULL) str = "(null)";
+    if (spec->prec < 0) return fmt_text(out, spec, str, strlen(str));
+
+    end = (const char *) memchr(str, 0, spec->prec);
+
+    return fmt_text(out, spec, str, (end != NULL) ? (size_t) (end - str) : (size_t) spec->prec);
+}
+
+
+//*****************************************************************************
+// the floating point numbers are left to snprintf(), rare on a console
+static int fmt_float(struct fmt_out *out, const struct fmt_spec *spec, char conv, va_list *args)
+{
+    char text[FMT_FLOAT_LEN];
+    char fmt[16];
+    char *at = fmt;
+    int len;
+
+    *at++ = '%';
+    if (spec->flags & FMT_LEFT) *at++ = '-';
+    if (spec->flags & FMT_ZERO) *at++ = '0';
+    if (spec->flags & FMT_PLUS) *at++ = '+';
+    if (spec->flags & FMT_SPACE) *at++ = ' ';
+    if (spec->flags & FMT_ALT) *at++ = '#';
+    *at++ = '*';
+    *at++ = '.';
+    *at++ = '*';
+    if (spec->len == FMT_LEN_LDOUBLE) *at++ = 'L';
+    *at++ = conv;
+    *at = 0;
+
+    if (spec->len == FMT_LEN_LDOUBLE) len = snprintf(text, sizeof(text), fmt, spec->width, spec->prec, va_arg(*args, long double));
+    else len = snprintf(text, sizeof(text), fmt, spec->width, spec->prec, va_arg(*args, double));
+
+    if (len <= 0) return 0;
+    if ((size_t) len >= sizeof(text)) len = sizeof(text) - 1;
+
+    fmt_put(out, text, len);
+
+    return len;
+}
+
+
+//*****************************************************************************
+static void fmt_buf_put(void *ctx, const char *data, size_t len)
+{
+    struct fmt_buf *out = (struct fmt_buf *) ctx;
+
+    if (out->len < out->size) {
+        memcpy(&out->buf[out->len], data, (len < out->size - out->len) ? len : out->size - out->len);
+    }
+    out->len += len;
+}
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+//*****************************************************************************
+// Format to the writer, return the number of chars written
+size_t shellFormat(shell_fmt_put_t put, void *ctx, const char *fmt, va_list args)
+{
+    struct fmt_out chunk;
+    struct fmt_out *out = &chunk;
+    struct fmt_spec spec;
+    const char *run;
+    size_t total = 0;
+    int64_t value;
+    uint64_t uvalue;
+    char conv, c;
+    va_list ap;
+
+    chunk.put = put;
+    chunk.ctx = ctx;
+    chunk.len = 0;
+    va_copy(ap, args);
+
+    while (*fmt) {
+        /* the text up to the next conversion in one piece */
+        for (run = fmt; *fmt && (*fmt != '%'); fmt++);
+        if (fmt != run) {
+            fmt_put(out, run, fmt - run);
+            total += fmt - run;
+        }
+        if (!*fmt) break;
+
+        run = fmt++;
+        spec.flags = 0;
+        spec.len = FMT_LEN_INT;
+        spec.width = 0;
+        spec.prec = -1;
+
+        for (;; fmt++) {
+            if (*fmt == '-') spec.flags |= FMT_LEFT;
+            else if (*fmt == '0') spec.flags |= FMT_ZERO;
+            else if (*fmt == '+') spec.flags |= FMT_PLUS;
+            else if (*fmt == ' ') spec.flags |= FMT_SPACE;
+            else if (*fmt == '#') spec.flags |= FMT_ALT;
+            else break;
+        }
+
+        if (*fmt == '*') {
+            spec.width = va_arg(ap, int);
+            if (spec.width < 0) {
+                spec.flags |= FMT_LEFT;
+                spec.width = -spec.width;
+            }
+            fmt++;
+        }
+        else {
+            for (; (*fmt >= '0') && (*fmt <= '9'); fmt++) spec.width = spec.width * 10 + (*fmt - '0');
+        }
+
+        if (*fmt == '.') {
+            fmt++;
+            if (*fmt == '*') {
+                spec.prec = va_arg(ap, int);
+                if (spec.prec < 0) spec.prec = -1;
+                fmt++;
+            }
+            else {
+                for (spec.prec = 0; (*fmt >= '0') && (*fmt <= '9'); fmt++) spec.prec = spec.prec * 10 + (*fmt - '0');
+            }
+        }
+
+        switch (*fmt) {
+            case 'h':
+                spec.len = (*++fmt == 'h') ? (fmt++, FMT_LEN_CHAR) : FMT_LEN_SHORT;
+                break;
+            case 'l':
+                spec.len = (*++fmt == 'l') ? (fmt++, FMT_LEN_LLONG) : FMT_LEN_LONG;
+                break;
+            case 'z':
+                spec.len = FMT_LEN_SIZE;
+                fmt++;
+                break;
+            case 'j':
+                spec.len = FMT_LEN_MAX;
+                fmt++;
+                break;
+            case 't':
+                spec.len = FMT_LEN_PTRDIFF;
+                fmt++;
+                break;
+            case 'L':
+                spec.len = FMT_LEN_LDOUBLE;
+                fmt++;
+                break;
+            default:
+                break;
+        }
+
+        conv = *fmt;
+        if (conv) fmt++;
+
+        switch (conv) {
+            case 'd':
+            case 'i':
+                switch (spec.len) {
+                    case FMT_LEN_CHAR:      value = (signed char) va_arg(ap, int); break;
+                    case FMT_LEN_SHORT:     value = (short) va_arg(ap, int); break;
+                    case FMT_LEN_LONG:      value = va_arg(ap, long); break;
+                    case FMT_LEN_LLONG:     value = va_arg(ap, long long); break;
+                    case FMT_LEN_SIZE:      value = (int64_t) va_arg(ap, size_t); break;
+                    case FMT_LEN_MAX:       value = va_arg(ap, intmax_t); break;
+                    case FMT_LEN_PTRDIFF:   value = va_arg(ap, ptrdiff_t); break;
+                    default:                value = va_arg(ap, int); break;
+                }
+                uvalue = (value < 0) ? -(uint64_t) value : (uint64_t) value;
+                total += fmt_int(out, &spec, conv, uvalue, value < 0);
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                switch (spec.len) {
+                    case FMT_LEN_CHAR:      uvalue = (unsigned char) va_arg(ap, unsigned); break;
+                    case FMT_LEN_SHORT:     uvalue = (unsigned short) va_arg(ap, unsigned); break;
+                    case FMT_LEN_LONG:      uvalue = va_arg(ap, unsigned long); break;
+                    case FMT_LEN_LLONG:     uvalue = va_arg(ap, unsigned long long); break;
+                    case FMT_LEN_SIZE:      uvalue = va_arg(ap, size_t); break;
+                    case FMT_LEN_MAX:       uvalue = va_arg(ap, uintmax_t); break;
+                    case FMT_LEN_PTRDIFF:   uvalue = (uint64_t) va_arg(ap, ptrdiff_t); break;
+                    default:                uvalue = va_arg(ap, unsigned); break;
+                }
+                spec.flags &= ~(FMT_PLUS | FMT_SPACE);
+                total += fmt_int(out, &spec, conv, uvalue, false);
+                break;
+            case 'p':
+                spec.flags &= ~(FMT_PLUS | FMT_SPACE | FMT_ZERO);
+                total += fmt_int(out, &spec, conv, (uintptr_t) va_arg(ap, void *), false);
+                break;
+            case 'c':
+                c = (char) va_arg(ap, int);
+                total += fmt_text(out, &spec, &c, 1);
+                break;
+            case 's':
+                total += fmt_str(out, &spec, va_arg(ap, const char *));
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                total += fmt_float(out, &spec, conv, &ap);
+                break;
+            case 'n':
+                /* never written, the format can come from outside */
+                (void) va_arg(ap, void *);
+                break;
+            case '%':
+                fmt_put(out, "%", 1);
+                total++;
+                break;
+            default:
+                /* unknown, written as it is */
+                fmt_put(out, run, fmt - run);
+                total += fmt - run;
+                break;
+        }
+    }
+
+    va_end(ap);
+    fmt_flush(out);
+
+    return total;
+}
+
+
+//*****************************************************************************
+// As vsnprintf()
+int shellVsnprintf(char *buf, size_t size, const char *fmt, va_list args)
+{
+    struct fmt_buf out = { buf, size, 0 };
+
+    if (size) out.size--;
+    shellFormat(fmt_buf_put, &out, fmt, args);
+    if (size) buf[(out.len < out.size) ? out.len : out.size] = 0;
+
+    return out.len;
+}
+
+
+int shellSnprintf(char *buf, size_t size, const char *fmt, ...)
+{
+    va_list args;
+    int len;
+
+    va_start(args, fmt);
+    len = shellVsnprintf(buf, size, fmt, args);
+    va_end(args);
+
+    return len;
+}
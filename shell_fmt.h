@@ -0,0 +1,85 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_fmt.h
+* @details Formatter of shellPrintf(), a subset of printf without heap
+*
+*   The text is given to a writer a chunk at a time: the runs of the
+*   format, the numbers and the padding are gathered on the stack, a
+*   larger string goes as it is. No locale is read and nothing is
+*   allocated, the length of the output isn't bounded by a buffer.
+*
+*   Flags "-+ #0", width and precision ('*' too), the lengths hh h l ll
+*   z j t, and d i u o x X c s p %. The floating point conversions f F e
+*   E g G a A are given to snprintf() one at a time. %n writes nothing.
+*
+*   The C++ shell::printf() of shell_fmt.hpp checks the arguments against
+*   the format at compile time.
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 02:26:51
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_FMT_H
+#define _SHELL_FMT_H
+
+
+#include <stdarg.h>
+#include <stddef.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef SHELL_FMT_CHUNK
+#define SHELL_FMT_CHUNK                 64         //!< Output gathered on the stack before the writer
+#endif
+
+#if defined(__GNUC__)
+#define SHELL_FMT_CHECK(f, a)           __attribute__((format(printf, f, a)))  //!< Arguments checked by the compiler
+#else
+#define SHELL_FMT_CHECK(f, a)
+#endif
+
+
+/**
+ * Writer of the formatted text, len is never 0
+ */
+typedef void (*shell_fmt_put_t)(void *ctx, const char *data, size_t len);
+
+
+
+size_t shellFormat(shell_fmt_put_t put, void *ctx, const char *fmt, va_list args);
+int shellVsnprintf(char *buf, size_t size, const char *fmt, va_list args);
+int shellSnprintf(char *buf, size_t size, const char *fmt, ...) SHELL_FMT_CHECK(3, 4);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_FMT_H */
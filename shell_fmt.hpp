@@ -0,0 +1,203 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_fmt.hpp
+* @details Format of shellPrintf() checked at compile time
+*
+*   The format is a literal given to shell::Format, its conversions are
+*   compared with the types of the arguments by the compiler: a missing
+*   argument, one too many, a long given to "%d" or an int to "%s" doesn't
+*   compile. The output is written by shellPrintf(), as in C.
+*
+*   shell::printf(pshell, "%-8s %5u 0x%08x\r\n", name, count, addr);
+*   shell.printf("%s: %d\r\n", name, status);
+*
+*   The conversions are the ones of shell_fmt.h, "%n" is refused.
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 02:41:17
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_FMT_HPP
+#define _SHELL_FMT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "shell.h"
+#include "shell_fmt.h"
+
+
+namespace shell {
+
+
+namespace detail {
+
+/**
+ * Argument taken by a conversion, '*' for a width or a precision
+ */
+struct FmtSlot
+{
+    char                conv;
+    char                len;                       //!< 'H' for hh, 'q' for ll, 0 for none
+};
+
+template <typename T>
+constexpr bool fmtInt(char len)
+{
+    if constexpr (!std::is_integral_v<T>) {
+        return false;
+    }
+    else {
+        switch (len) {
+            case 'l': return sizeof(T) == sizeof(long);
+            case 'q': return sizeof(T) == sizeof(long long);
+            case 'z': return sizeof(T) == sizeof(std::size_t);
+            case 'j': return sizeof(T) == sizeof(intmax_t);
+            case 't': return sizeof(T) == sizeof(std::ptrdiff_t);
+            default:  return sizeof(T) <= sizeof(int);    //promoted to int
+        }
+    }
+}
+
+template <typename T>
+constexpr bool fmtMatch(FmtSlot slot)
+{
+    using U = std::remove_cv_t<T>;
+
+    switch (slot.conv) {
+        case '*':
+        case 'c':
+            return fmtInt<U>(0);
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            return fmtInt<U>(slot.len);
+        case 's':
+            return std::is_same_v<U, const char *> || std::is_same_v<U, char *>;
+        case 'p':
+            return std::is_pointer_v<U> || std::is_null_pointer_v<U>;
+        default:
+            if (slot.len == 'L') return std::is_same_v<U, long double>;
+            return std::is_same_v<U, double> || std::is_same_v<U, float>;
+    }
+}
+
+} // namespace detail
+
+
+/**
+ * Format of arguments of the types Args, built from a literal
+ */
+template <typename... Args>
+class Format
+{
+    static constexpr std::size_t N = sizeof...(Args);
+
+public:
+    consteval Format(const char *fmt) : fmt_(fmt)
+    {
+        std::array<detail::FmtSlot, N + 1> slots{};
+        std::size_t n = 0;
+        const char *at = fmt;
+
+        auto take = [&](char conv, char len) {
+            if (n == N) throw "more conversions than arguments";
+            slots[n++] = { conv, len };
+        };
+
+        while (*at) {
+            if (*at++ != '%') continue;
+
+            while ((*at == '-') || (*at == '+') || (*at == ' ') || (*at == '#') || (*at == '0')) at++;
+
+            if (*at == '*') take(*at++, 0);
+            else while ((*at >= '0') && (*at <= '9')) at++;
+
+            if (*at == '.') {
+                at++;
+                if (*at == '*') take(*at++, 0);
+                else while ((*at >= '0') && (*at <= '9')) at++;
+            }
+
+            char len = 0;
+            if ((at[0] == 'h') && (at[1] == 'h')) { len = 'H'; at += 2; }
+            else if ((at[0] == 'l') && (at[1] == 'l')) { len = 'q'; at += 2; }
+            else if ((*at == 'h') || (*at == 'l') || (*at == 'z') || (*at == 'j') || (*at == 't') || (*at == 'L')) len = *at++;
+
+            switch (char conv = *at++) {
+                case '%':
+                    break;
+                case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c': case 's': case 'p':
+                    if (len == 'L') throw "L is for the floating point conversions";
+                    take(conv, len);
+                    break;
+                case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                    if (len && (len != 'l') && (len != 'L')) throw "bad length of a floating point conversion";
+                    take(conv, len);
+                    break;
+                case 'n':
+                    throw "%n isn't written";
+                default:
+                    throw "unknown conversion";
+            }
+        }
+
+        if (n != N) throw "more arguments than conversions";
+
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            if (!(detail::fmtMatch<Args>(slots[I]) && ...)) throw "an argument doesn't match its conversion";
+        }(std::make_index_sequence<N>());
+    }
+
+    constexpr const char *c_str() const noexcept { return fmt_; }
+
+private:
+    const char          *fmt_;
+};
+
+
+/**
+ * shellPrintf() with the format checked against the arguments
+ */
+template <typename... Args>
+inline void printf(shellObject_t *pshell, Format<std::type_identity_t<Args>...> fmt, Args... args) noexcept
+{
+    /* checked above, the format isn't a literal for shellPrintf() */
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+#endif
+    shellPrintf(pshell, fmt.c_str(), args...);
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+}
+
+
+} // namespace shell
+
+#endif /* _SHELL_FMT_HPP */
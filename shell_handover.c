@@ -0,0 +1,446 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_handover.c
+* @details Session handover to a new process
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 21:48:33
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "shell_handover.h"
+
+
+
+
+
+#define HANDOVER_MAGIC                  0x4F444E48 //!< "HNDO" little endian
+#define HANDOVER_FLUSH_MS               100        //!< Wait of a full terminal
+#define HANDOVER_USER_MAX               (1024 * 1024) //!< Data of the application sent with a session
+
+
+/**
+ * Session state, the sizes must be the same on both sides
+ */
+struct handover_state
+{
+    uint32_t            magic;
+    uint16_t            version;
+    uint16_t            size;                      //!< sizeof(struct handover_state)
+    uint32_t            user_len;                  //!< Data of the application after it
+
+    uint8_t             state;
+    bool                echo;
+    bool                machine;
+    bool                machine_echo;
+    bool                paste;
+    bool                paste_queue;
+    bool                paste_cr;
+    uint16_t            paste_start;
+    uint16_t            paste_tail;
+    uint16_t            line_pos;
+    uint16_t            line_cur;
+    uint32_t            seq;
+    uint16_t            line_max;
+    uint16_t            history_max;
+    char                line[SHELL_BUFFER_LINE_LEN];
+
+    uint16_t            history_current;
+    uint16_t            history_count;
+    char                history[SHELL_HISTORY_LINES][SHELL_HISTORY_CMD_SIZE];
+
+    uint16_t            in_len;                    //!< Input read but not processed
+    uint8_t             in[SHELL_IN_BUFFER_LEN];
+
+    vt100_t             vt;
+};
+
+/**
+ * Received session
+ */
+struct shell_handover
+{
+    struct handover_state st;
+    uint8_t             user[];
+};
+
+
+
+//Declare Prototype
+static s_err_t handover_drain(shellObject_t *pshell, int fd);
+static s_err_t handover_read(int sock, void *buf, size_t len);
+static bool handover_check(struct handover_state *st);
+
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+// what was printed reaches the terminal before the descriptor moves, the
+// queue of the output included
+static s_err_t handover_drain(shellObject_t *pshell, int fd)
+{
+    struct pollfd pfd = { fd, POLLOUT, 0 };
+    uint32_t len;
+
+    while ((len = shellOutputPending(pshell)) != 0) {
+        if (shellFlush(pshell) != SYS_EOK) return SYS_EIO;
+
+        /* full, it's waited a little */
+        if ((shellOutputPending(pshell) == len) && (poll(&pfd, 1, HANDOVER_FLUSH_MS) <= 0)) return SYS_EIO;
+    }
+
+    return SYS_EOK;
+}
+
+
+static s_err_t handover_read(int sock, void *buf, size_t len)
+{
+    uint8_t *dst = (uint8_t *) buf;
+    ssize_t n;
+
+    while (len) {
+        n = recv(sock, dst, len, MSG_WAITALL);
+        if ((n < 0) && (errno == EINTR)) continue;
+        if (n <= 0) return SYS_EIO;
+
+        dst += n;
+        len -= n;
+    }
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// the state comes from another process: the lengths and the indexes are
+// checked before they reach the buffers, the strings are terminated
+static bool handover_check(struct handover_state *st)
+{
+    uint16_t i;
+
+    if ((st->user_len > HANDOVER_USER_MAX) || (st->state > SHELL_STATE_RX_CMD)) return false;
+
+    if (!st->line_max || (st->line_max > sizeof(st->line) - 1) || (st->history_max > SHELL_HISTORY_LINES)) return false;
+
+    if ((st->line_pos >= sizeof(st->line)) || (st->paste_start >= sizeof(st->line)) ||
+        (st->paste_tail >= sizeof(st->line))) {
+        return false;
+    }
+
+    /* while a paste runs the tail is at the end of the line, line_pos is set by its end */
+    if (st->paste) {
+        if ((st->paste_start > st->line_cur) || (st->line_cur + st->paste_tail > sizeof(st->line) - 1)) return false;
+    }
+    else {
+        if (st->line_cur > st->line_pos) return false;
+        st->line[st->line_pos] = 0;
+    }
+    st->line[sizeof(st->line) - 1] = 0;
+
+    if ((st->history_count > SHELL_HISTORY_LINES) || (st->history_current > st->history_count)) return false;
+    for (i = 0; i < SHELL_HISTORY_LINES; i++) st->history[i][SHELL_HISTORY_CMD_SIZE - 1] = 0;
+
+    if (st->in_len > sizeof(st->in)) return false;
+
+    if (!st->vt.nrows || !st->vt.ncols || (st->vt.esc_elems > VT_ESC_ELEM_SIZE)) return false;
+    st->vt.out_buffer[VT_ESC_ELEM_SIZE - 1] = 0;
+
+    return true;
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+//*****************************************************************************
+// Socket of the old process, the new one connects to it
+int shellHandoverListen(const char *path)
+{
+    struct sockaddr_un addr;
+    int sock;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) return -1;
+
+    unlink(path);
+    if (bind(sock, (struct sockaddr *) &addr, sizeof(addr)) || listen(sock, 1)) {
+        close(sock);
+        return -1;
+    }
+
+    return sock;
+}
+
+
+int shellHandoverConnect(const char *path)
+{
+    struct sockaddr_un addr;
+    int sock;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) return -1;
+
+    if (connect(sock, (struct sockaddr *) &addr, sizeof(addr))) {
+        close(sock);
+        return -1;
+    }
+
+    return sock;
+}
+
+
+//*****************************************************************************
+// Send the session and its descriptor, user is the state of the application
+// for this session (a telnet layer for instance). The session isn't closed.
+s_err_t shellHandoverSend(int sock, shellObject_t *pshell, int fd, const void *user, uint32_t user_len)
+{
+    union {
+        struct cmsghdr  hdr;
+        char            buf[CMSG_SPACE(sizeof(int))];
+    } ctrl;
+    struct handover_state st;
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+    struct iovec iov[2];
+    size_t total, sent;
+    ssize_t n;
+    int i;
+
+    if (user_len > HANDOVER_USER_MAX) return SYS_EFULL;
+    if (handover_drain(pshell, fd) != SYS_EOK) return SYS_EIO;
+
+    memset(&st, 0, sizeof(st));
+    st.magic = HANDOVER_MAGIC;
+    st.version = SHELL_HANDOVER_VERSION;
+    st.size = sizeof(st);
+    st.user_len = user_len;
+
+    /* a command running here can't go on there, the new process prompts again */
+    st.state = (pshell->state <= SHELL_STATE_READY) ? pshell->state : SHELL_STATE_RX_CMD;
+    st.echo = pshell->echo;
+    st.machine = pshell->machine;
+    st.machine_echo = pshell->machine_echo;
+    st.paste = pshell->paste;
+    st.paste_queue = pshell->paste_queue;
+    st.paste_cr = pshell->paste_cr;
+    st.paste_start = pshell->paste_start;
+    st.paste_tail = pshell->paste_tail;
+    st.line_pos = pshell->line_pos;
+    st.line_cur = pshell->line_cur;
+    st.seq = pshell->seq;
+    st.line_max = pshell->line_max;
+    st.history_max = pshell->history_max;
+    memcpy(st.line, pshell->line, sizeof(st.line));
+
+    st.history_current = pshell->history_current;
+    st.history_count = pshell->history_count;
+    memcpy(st.history, pshell->history, sizeof(st.history));
+
+    st.in_len = pshell->in_len - pshell->in_pos;
+    memcpy(st.in, &pshell->in_buf[pshell->in_pos], st.in_len);
+
+    st.vt = *pshell->vt;
+
+    /* the descriptor goes with the first byte */
+    memset(&ctrl, 0, sizeof(ctrl));
+    memset(&msg, 0, sizeof(msg));
+    iov[0].iov_base = &st;
+    iov[0].iov_len = sizeof(st);
+    iov[1].iov_base = (void *) user;
+    iov[1].iov_len = user_len;
+    msg.msg_iov = iov;
+    msg.msg_iovlen = user_len ? 2 : 1;
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof(ctrl.buf);
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    do {
+        n = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while ((n < 0) && (errno == EINTR));
+    if (n <= 0) return SYS_EIO;
+
+    /* the rest of a partial send */
+    total = sizeof(st) + user_len;
+    for (sent = n; sent < total; sent += n) {
+        i = (sent < sizeof(st)) ? 0 : 1;
+        if (!i) n = send(sock, (uint8_t *) &st + sent, sizeof(st) - sent, MSG_NOSIGNAL);
+        else n = send(sock, (const uint8_t *) user + (sent - sizeof(st)), total - sent, MSG_NOSIGNAL);
+
+        if ((n < 0) && (errno == EINTR)) n = 0;
+        else if (n <= 0) return SYS_EIO;
+    }
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Next session, *ppho is NULL once the old process closed the socket
+s_err_t shellHandoverRecv(int sock, shell_handover_t **ppho, int *fd)
+{
+    union {
+        struct cmsghdr  hdr;
+        char            buf[CMSG_SPACE(sizeof(int))];
+    } ctrl;
+    struct handover_state st;
+    shell_handover_t *pho;
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+    struct iovec iov;
+    ssize_t n;
+
+    *ppho = NULL;
+    *fd = -1;
+
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base = &st;
+    iov.iov_len = sizeof(st);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof(ctrl.buf);
+
+    do {
+        n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while ((n < 0) && (errno == EINTR));
+
+    if (n == 0) return SYS_EOK;
+    if (n < 0) return SYS_EIO;
+
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_RIGHTS)) {
+            memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+
+    if ((*fd < 0) || (handover_read(sock, (uint8_t *) &st + n, sizeof(st) - n) != SYS_EOK) ||
+        (st.magic != HANDOVER_MAGIC) || (st.version != SHELL_HANDOVER_VERSION) || (st.size != sizeof(st)) ||
+        !handover_check(&st)) {
+        goto fail;
+    }
+
+    pho = (shell_handover_t *) malloc(sizeof(shell_handover_t) + st.user_len);
+    if (pho == NULL) goto fail;
+
+    pho->st = st;
+    if (handover_read(sock, pho->user, st.user_len) != SYS_EOK) {
+        free(pho);
+        goto fail;
+    }
+
+    *ppho = pho;
+    return SYS_EOK;
+
+fail:
+    if (*fd >= 0) close(*fd);
+    *fd = -1;
+
+    return SYS_EIO;
+}
+
+
+const void *shellHandoverUser(shell_handover_t *pho, uint32_t *len)
+{
+    *len = pho->st.user_len;
+
+    return pho->user;
+}
+
+
+//*****************************************************************************
+// Restore a session opened on the received descriptor, before shellInit()
+// or instead of it, and draw the line being edited again
+s_err_t shellHandoverRestore(shellObject_t *pshell, shell_handover_t *pho)
+{
+    struct handover_state *st = &pho->st;
+
+    pshell->state = st->state;
+    pshell->echo = st->echo;
+    pshell->machine = st->machine;
+    pshell->machine_echo = st->machine_echo;
+    pshell->paste = st->paste;
+    pshell->paste_queue = st->paste_queue;
+    pshell->paste_cr = st->paste_cr;
+    pshell->paste_start = st->paste_start;
+    pshell->paste_tail = st->paste_tail;
+    pshell->line_pos = st->line_pos;
+    pshell->line_cur = st->line_cur;
+    pshell->seq = st->seq;
+    pshell->line_max = st->line_max;
+    pshell->history_max = st->history_max;
+    memcpy(pshell->line, st->line, sizeof(pshell->line));
+
+    pshell->history_current = st->history_current;
+    pshell->history_count = st->history_count;
+    memcpy(pshell->history, st->history, sizeof(pshell->history));
+
+    pshell->in_pos = 0;
+    pshell->in_len = st->in_len;
+    memcpy(pshell->in_buf, st->in, st->in_len);
+
+    *pshell->vt = st->vt;
+
+    shellRedraw(pshell);
+
+    return SYS_EOK;
+}
+
+
+void shellHandoverFree(shell_handover_t *pho)
+{
+    free(pho);
+}
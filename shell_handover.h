@@ -0,0 +1,89 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_handover.h
+* @details Session handover to a new process
+*
+*   On an upgrade the old process sends each session, its state and its
+*   connection descriptor (SCM_RIGHTS), over a SOCK_STREAM unix socket
+*   then exits without shellClose(), which would reset the terminal.
+*   The new process opens a session on each descriptor it
+*   receives and restores it, the line being edited is drawn again.
+*
+*   old:  lfd = shellHandoverListen(path); sock = accept(lfd, NULL, NULL);
+*         shellHandoverSend(sock, pshell, fd, NULL, 0); ... close(sock);
+*
+*   new:  sock = shellHandoverConnect(path);
+*         while ((shellHandoverRecv(sock, &pho, &fd) == SYS_EOK) && (pho != NULL)) {
+*             pshell = shellOpenIo(&shell_io_fd, ctx_of(fd), "> ", NULL);
+*             shellHandoverRestore(pshell, pho);
+*             shellHandoverFree(pho);
+*         }
+*
+*   The limits of shellSetLimits() go with the session. What the
+*   application keeps around it doesn't: the keys a BasicShell filters
+*   out are taken again from its arguments, a sequence it had started
+*   to read is lost, as the callbacks and the prompt.
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 21:48:33
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_HANDOVER_H
+#define _SHELL_HANDOVER_H
+
+
+#include <stdint.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define SHELL_HANDOVER_VERSION          2          //!< Both processes use the same
+
+
+typedef struct shell_handover shell_handover_t;    //!< Received session, opaque
+
+
+
+int shellHandoverListen(const char *path);
+int shellHandoverConnect(const char *path);
+
+s_err_t shellHandoverSend(int sock, shellObject_t *pshell, int fd, const void *user, uint32_t user_len);
+s_err_t shellHandoverRecv(int sock, shell_handover_t **ppho, int *fd);
+const void *shellHandoverUser(shell_handover_t *pho, uint32_t *len);
+s_err_t shellHandoverRestore(shellObject_t *pshell, shell_handover_t *pho);
+void shellHandoverFree(shell_handover_t *pho);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_HANDOVER_H */
@@ -0,0 +1,560 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_histfile.c
+* @details Persistent history of the shell terminal
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 20:26:17
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "shell_histfile.h"
+
+
+
+
+
+#define HISTFILE_MAGIC                  0x54534948 //!< "HIST" little endian
+#define HISTFILE_VERSION                1
+#define HISTFILE_HDR_SIZE               64         //!< The records start after it
+#define HISTFILE_RETRY                  1000       //!< Reopens while compactions end
+#define HISTFILE_LINE_MAX               (SHELL_HISTORY_CMD_SIZE - 1) //!< Text of a record, as the history keeps it
+
+#define HISTFILE_COMMITTED              1          //!< Record complete
+#define HISTFILE_VOID                   2          //!< Record moved to the new file
+
+/* flags, len, text padded to 4 bytes, then the size again to check the record is whole */
+#define HISTFILE_REC_SIZE(len)          ((((len) + 4 + 3) & ~3U) + 4)
+
+
+/**
+ * File header
+ */
+struct histfile_hdr
+{
+    uint32_t            magic;
+    uint32_t            version;
+    uint32_t            size;                      //!< Size of the file, fixed
+    atomic_uint         tail;                      //!< End of the reserved records
+    atomic_uint         committed;                 //!< Bytes of the records written
+    atomic_uint         closed;                    //!< Compacted, the users move to the new file
+};
+
+/**
+ * Record
+ */
+struct histfile_rec
+{
+    atomic_ushort       flags;
+    uint16_t            len;
+    char                text[];
+};
+
+/**
+ * Handle, one per session
+ */
+struct shell_histfile
+{
+    char                *path;
+    int                 fd;
+    uint8_t             *map;
+    uint32_t            size;
+    struct histfile_hdr *hdr;                      //!< NULL while the file isn't mapped
+    uint32_t            seen;                      //!< Tail at the last load
+    uint32_t            pending;                   //!< Tail of an append in progress at the last sync
+};
+
+
+
+//Declare Prototype
+static s_err_t histfile_map(shell_histfile_t *phist);
+static void histfile_unmap(shell_histfile_t *phist);
+static s_err_t histfile_reopen(shell_histfile_t *phist);
+static s_err_t histfile_ready(shell_histfile_t *phist);
+static void histfile_wait(struct histfile_hdr *hdr);
+static uint32_t histfile_next(const uint8_t *map, uint32_t pos, uint32_t end);
+static s_err_t histfile_compact(shell_histfile_t *phist, bool wait);
+static uint16_t histfile_load(shell_histfile_t *phist, char lines[][SHELL_HISTORY_CMD_SIZE], uint16_t max);
+static void histfile_push(void *ctx, const char *line);
+static void histfile_sync(void *ctx, shellObject_t *pshell);
+
+
+
+const shell_hist_ops_t shell_hist_file = {
+    histfile_push,
+    histfile_sync,
+};
+
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+// open the file, the first user sizes it and writes the header
+static s_err_t histfile_map(shell_histfile_t *phist)
+{
+    struct histfile_hdr *hdr;
+    struct stat st;
+    uint32_t size;
+    bool init;
+    void *map;
+    int tries;
+    int fd;
+
+    for (tries = 0; tries < HISTFILE_RETRY; tries++) {
+        fd = open(phist->path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (fd < 0) return SYS_EIO;
+
+        /* waits a compaction in progress */
+        flock(fd, LOCK_EX);
+
+        init = !fstat(fd, &st) && (st.st_size < HISTFILE_HDR_SIZE);
+        if (init && ftruncate(fd, SHELL_HISTFILE_SIZE)) {
+            close(fd);
+            return SYS_EIO;
+        }
+        size = init ? SHELL_HISTFILE_SIZE : st.st_size;
+
+        map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            close(fd);
+            return SYS_ENOMEM;
+        }
+        hdr = (struct histfile_hdr *) map;
+
+        if (init) {
+            hdr->magic = HISTFILE_MAGIC;
+            hdr->version = HISTFILE_VERSION;
+            hdr->size = size;
+            atomic_store(&hdr->tail, HISTFILE_HDR_SIZE);
+            atomic_store(&hdr->committed, HISTFILE_HDR_SIZE);
+            atomic_store(&hdr->closed, 0);
+        }
+
+        flock(fd, LOCK_UN);
+
+        if ((hdr->magic != HISTFILE_MAGIC) || (hdr->version != HISTFILE_VERSION) || (hdr->size != size)) {
+            munmap(map, size);
+            close(fd);
+            return SYS_ERROR;
+        }
+
+        if (!atomic_load(&hdr->closed)) {
+            phist->fd = fd;
+            phist->map = (uint8_t *) map;
+            phist->size = size;
+            phist->hdr = hdr;
+            phist->seen = 0;
+            phist->pending = 0;
+            return SYS_EOK;
+        }
+
+        /* compacted, the new file is being renamed */
+        munmap(map, size);
+        close(fd);
+        sched_yield();
+    }
+
+    return SYS_EIO;
+}
+
+
+static void histfile_unmap(shell_histfile_t *phist)
+{
+    if (phist->map != NULL) munmap(phist->map, phist->size);
+    if (phist->fd >= 0) close(phist->fd);
+
+    phist->map = NULL;
+    phist->hdr = NULL;
+    phist->fd = -1;
+}
+
+
+static s_err_t histfile_reopen(shell_histfile_t *phist)
+{
+    histfile_unmap(phist);
+
+    return histfile_map(phist);
+}
+
+
+//*****************************************************************************
+// mapped and not compacted, a remap that failed is tried again here
+static s_err_t histfile_ready(shell_histfile_t *phist)
+{
+    if ((phist->hdr != NULL) && !atomic_load(&phist->hdr->closed)) return SYS_EOK;
+
+    return histfile_reopen(phist);
+}
+
+
+//*****************************************************************************
+// up to the end of the appends in progress, a dead writer is waited once
+static void histfile_wait(struct histfile_hdr *hdr)
+{
+    struct timespec ms = { 0, 1000000 };
+    int i;
+
+    for (i = 0; i < SHELL_HISTFILE_WAIT_MS; i++) {
+        if (atomic_load(&hdr->committed) >= atomic_load(&hdr->tail)) return;
+        nanosleep(&ms, NULL);
+    }
+}
+
+
+//*****************************************************************************
+// first whole record from pos, end if there is none. A writer that died
+// between its reservation and the size at the end of its record left a
+// torn one, the records after it are found again on the 4 bytes boundaries
+static uint32_t histfile_next(const uint8_t *map, uint32_t pos, uint32_t end)
+{
+    struct histfile_rec *rec;
+    uint32_t size;
+
+    for (; pos + HISTFILE_REC_SIZE(0) <= end; pos += 4) {
+        rec = (struct histfile_rec *) &map[pos];
+        if ((atomic_load(&rec->flags) > HISTFILE_VOID) || (rec->len > HISTFILE_LINE_MAX)) continue;
+
+        size = HISTFILE_REC_SIZE(rec->len);
+        if ((pos + size <= end) && !memcmp(&map[pos + size - 4], &size, sizeof(size))) return pos;
+    }
+
+    return end;
+}
+
+
+static void histfile_push(void *ctx, const char *line)
+{
+    shellHistFileAppend((shell_histfile_t *) ctx, line);
+}
+
+
+//*****************************************************************************
+// the newest records before the tail, oldest first, the file is ready
+static uint16_t histfile_load(shell_histfile_t *phist, char lines[][SHELL_HISTORY_CMD_SIZE], uint16_t max)
+{
+    struct histfile_rec *rec;
+    uint32_t end, pos, total = 0;
+    uint16_t count = 0;
+
+    end = atomic_load(&phist->hdr->tail);
+
+    for (pos = histfile_next(phist->map, HISTFILE_HDR_SIZE, end); pos < end;
+         pos = histfile_next(phist->map, pos + HISTFILE_REC_SIZE(rec->len), end)) {
+        rec = (struct histfile_rec *) &phist->map[pos];
+        if (atomic_load_explicit(&rec->flags, memory_order_acquire) == HISTFILE_COMMITTED) total++;
+    }
+
+    for (pos = histfile_next(phist->map, HISTFILE_HDR_SIZE, end); (pos < end) && (count < max);
+         pos = histfile_next(phist->map, pos + HISTFILE_REC_SIZE(rec->len), end)) {
+        rec = (struct histfile_rec *) &phist->map[pos];
+        if (atomic_load_explicit(&rec->flags, memory_order_acquire) != HISTFILE_COMMITTED) continue;
+
+        /* the oldest ones don't fit */
+        if (total > max) {
+            total--;
+            continue;
+        }
+
+        memset(lines[count], 0, SHELL_HISTORY_CMD_SIZE);
+        memcpy(lines[count], rec->text, rec->len);
+        count++;
+    }
+
+    phist->seen = end;
+
+    return count;
+}
+
+
+//*****************************************************************************
+// reload when another session appended. Called by a key, it doesn't wait:
+// an append in progress is left to the next call, a writer still not done
+// then is taken as dead
+static void histfile_sync(void *ctx, shellObject_t *pshell)
+{
+    shell_histfile_t *phist = (shell_histfile_t *) ctx;
+    uint32_t tail;
+
+    /* the history in memory stays until the file can be mapped again */
+    if (histfile_ready(phist) != SYS_EOK) return;
+
+    tail = atomic_load(&phist->hdr->tail);
+    if (tail == phist->seen) return;
+
+    if ((atomic_load(&phist->hdr->committed) < tail) && (tail != phist->pending)) {
+        phist->pending = tail;
+        return;
+    }
+
+    pshell->history_count = histfile_load(phist, pshell->history, pshell->history_max);
+    pshell->history_current = pshell->history_count;
+}
+
+
+
+
+
+
+
+
+
+//*****************************************************************************
+// copy the newest entries in a new file renamed over the old one. The old
+// one is closed first, its users move to the new file. Without the wait an
+// append in progress makes it give up
+static s_err_t histfile_compact(shell_histfile_t *phist, bool wait)
+{
+    struct histfile_hdr *hdr;
+    struct histfile_hdr *nhdr;
+    struct histfile_rec *rec;
+    uint32_t keep;
+    uint32_t end, pos, size, bytes, out;
+    uint8_t *map;
+    char *tmp;
+    int fd;
+
+    if (histfile_ready(phist) != SYS_EOK) return SYS_EIO;
+    hdr = phist->hdr;
+    keep = (uint64_t) (phist->size - HISTFILE_HDR_SIZE) * SHELL_HISTFILE_KEEP / 100;
+
+    /* another user compacts it */
+    if (flock(phist->fd, LOCK_EX | LOCK_NB)) return SYS_EFULL;
+
+    if (atomic_load(&hdr->closed)) {
+        flock(phist->fd, LOCK_UN);
+        return histfile_reopen(phist);
+    }
+
+    if (!wait && (atomic_load(&hdr->committed) < atomic_load(&hdr->tail))) {
+        flock(phist->fd, LOCK_UN);
+        return SYS_EBUSY;
+    }
+
+    atomic_store(&hdr->closed, 1);
+    histfile_wait(hdr);
+    end = atomic_load(&hdr->tail);
+
+    /* size of the records committed */
+    bytes = 0;
+    for (pos = histfile_next(phist->map, HISTFILE_HDR_SIZE, end); pos < end; pos = histfile_next(phist->map, pos + size, end)) {
+        rec = (struct histfile_rec *) &phist->map[pos];
+        size = HISTFILE_REC_SIZE(rec->len);
+        if (atomic_load(&rec->flags) == HISTFILE_COMMITTED) bytes += size;
+    }
+
+    tmp = (char *) malloc(strlen(phist->path) + 8);
+    if (tmp == NULL) goto fail;
+    sprintf(tmp, "%s.XXXXXX", phist->path);
+
+    fd = mkstemp(tmp);
+    if (fd < 0) goto fail_tmp;
+
+    map = MAP_FAILED;
+    if (!ftruncate(fd, phist->size)) {
+        map = (uint8_t *) mmap(NULL, phist->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (map == MAP_FAILED) goto fail_fd;
+
+    /* the oldest records are left out down to the size kept */
+    out = HISTFILE_HDR_SIZE;
+    for (pos = histfile_next(phist->map, HISTFILE_HDR_SIZE, end); pos < end; pos = histfile_next(phist->map, pos + size, end)) {
+        rec = (struct histfile_rec *) &phist->map[pos];
+        size = HISTFILE_REC_SIZE(rec->len);
+        if (atomic_load(&rec->flags) != HISTFILE_COMMITTED) continue;
+
+        if (bytes > keep) {
+            bytes -= size;
+            continue;
+        }
+
+        memcpy(&map[out], rec, size);
+        out += size;
+    }
+    bytes = out - HISTFILE_HDR_SIZE;
+
+    nhdr = (struct histfile_hdr *) map;
+    nhdr->magic = HISTFILE_MAGIC;
+    nhdr->version = HISTFILE_VERSION;
+    nhdr->size = phist->size;
+    atomic_store(&nhdr->tail, HISTFILE_HDR_SIZE + bytes);
+    atomic_store(&nhdr->committed, HISTFILE_HDR_SIZE + bytes);
+    atomic_store(&nhdr->closed, 0);
+
+    munmap(map, phist->size);
+
+    if (fsync(fd) || rename(tmp, phist->path)) goto fail_fd;
+
+    close(fd);
+    free(tmp);
+    flock(phist->fd, LOCK_UN);
+
+    return histfile_reopen(phist);
+
+fail_fd:
+    close(fd);
+    unlink(tmp);
+fail_tmp:
+    free(tmp);
+fail:
+    /* the old file stays in use */
+    atomic_store(&hdr->closed, 0);
+    flock(phist->fd, LOCK_UN);
+
+    return SYS_EIO;
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+shell_histfile_t *shellHistFileOpen(const char *path)
+{
+    shell_histfile_t *phist;
+
+    phist = (shell_histfile_t *) calloc(1, sizeof(shell_histfile_t));
+    if (phist == NULL) return NULL;
+
+    phist->fd = -1;
+    phist->path = strdup(path);
+
+    if ((phist->path == NULL) || (histfile_map(phist) != SYS_EOK)) {
+        free(phist->path);
+        free(phist);
+        return NULL;
+    }
+
+    /* out of the key handler, the time to compact */
+    if (atomic_load(&phist->hdr->tail) > (uint64_t) phist->size * SHELL_HISTFILE_COMPACT / 100) {
+        shellHistFileCompact(phist);
+    }
+
+    return phist;
+}
+
+
+void shellHistFileClose(shell_histfile_t *phist)
+{
+    histfile_unmap(phist);
+    free(phist->path);
+    free(phist);
+}
+
+
+//*****************************************************************************
+// Lock free append, the place is reserved with a compare and swap on the tail.
+// Called on Enter it doesn't wait: the file is compacted past the threshold
+// only if nobody else uses it at this time. Full, the line stays in the
+// history in memory only
+s_err_t shellHistFileAppend(shell_histfile_t *phist, const char *line)
+{
+    struct histfile_rec *rec;
+    uint32_t size, pos;
+    size_t len = strlen(line);
+    int tries;
+
+    if (!len) return SYS_EOK;
+    if (len > HISTFILE_LINE_MAX) len = HISTFILE_LINE_MAX;
+
+    size = HISTFILE_REC_SIZE(len);
+
+    for (tries = 0; tries < HISTFILE_RETRY; tries++) {
+        if (histfile_ready(phist) != SYS_EOK) return SYS_EIO;
+
+        pos = atomic_load(&phist->hdr->tail);
+        do {
+            if (pos + size > phist->size) break;
+        } while (!atomic_compare_exchange_weak(&phist->hdr->tail, &pos, pos + size));
+
+        if (pos + size > phist->size) {
+            if (histfile_compact(phist, false) != SYS_EOK) return SYS_EFULL;
+            continue;
+        }
+
+        rec = (struct histfile_rec *) &phist->map[pos];
+        rec->len = len;
+        memcpy(&phist->map[pos + size - 4], &size, sizeof(size));
+
+        /* a compaction started after its last look at the tail, it goes in the new file */
+        if (atomic_load(&phist->hdr->closed)) {
+            atomic_store_explicit(&rec->flags, HISTFILE_VOID, memory_order_release);
+            atomic_fetch_add(&phist->hdr->committed, size);
+            continue;
+        }
+
+        memcpy(rec->text, line, len);
+        atomic_store_explicit(&rec->flags, HISTFILE_COMMITTED, memory_order_release);
+        atomic_fetch_add(&phist->hdr->committed, size);
+
+        /* the line is in, another try comes with the next one */
+        if (pos + size > (uint64_t) phist->size * SHELL_HISTFILE_COMPACT / 100) {
+            histfile_compact(phist, false);
+        }
+
+        return SYS_EOK;
+    }
+
+    return SYS_EFULL;
+}
+
+
+//*****************************************************************************
+// The newest entries, oldest first, read backward from the tail
+uint16_t shellHistFileLoad(shell_histfile_t *phist, char lines[][SHELL_HISTORY_CMD_SIZE], uint16_t max)
+{
+    if (histfile_ready(phist) != SYS_EOK) return 0;
+
+    /* an append in progress would hide the records before it */
+    histfile_wait(phist->hdr);
+
+    return histfile_load(phist, lines, max);
+}
+
+
+//*****************************************************************************
+// Compact the file, the appends in progress are waited. It may block on the
+// disk: it's called out of the key handler, at the open or from a timer
+s_err_t shellHistFileCompact(shell_histfile_t *phist)
+{
+    return histfile_compact(phist, true);
+}
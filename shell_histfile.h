@@ -0,0 +1,95 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_histfile.h
+* @details Persistent history of the shell terminal
+*
+*   The history is an append-only log mapped in memory and shared by all
+*   the sessions and processes opening the same file. An append reserves
+*   its place with a compare and swap on the tail, so no lock is taken.
+*   The records are read forward from the header, each one checked by the
+*   size at its end: the one of a writer that died half way is skipped.
+*   A file 3/4 full is compacted in a new file, renamed over the old one,
+*   and the other users follow it. An append does it only if that doesn't
+*   wait for another user, the open or shellHistFileCompact() called from
+*   a timer wait for them.
+*
+*   shell_histfile_t *hist = shellHistFileOpen("/var/lib/console/history");
+*   shellSetHistory(pshell, &shell_hist_file, hist);
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 20:26:17
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_HISTFILE_H
+#define _SHELL_HISTFILE_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef SHELL_HISTFILE_SIZE
+#define SHELL_HISTFILE_SIZE             (256 * 1024)  //!< Size of a new file, the cap of the log
+#endif
+
+#ifndef SHELL_HISTFILE_COMPACT
+#define SHELL_HISTFILE_COMPACT          75         //!< Fill in % starting a compaction
+#endif
+
+#ifndef SHELL_HISTFILE_KEEP
+#define SHELL_HISTFILE_KEEP             25         //!< Newest entries kept by a compaction, in %
+#endif
+
+#ifndef SHELL_HISTFILE_WAIT_MS
+#define SHELL_HISTFILE_WAIT_MS          100        //!< Wait of the appends in progress
+#endif
+
+
+typedef struct shell_histfile shell_histfile_t;    //!< Opaque
+
+
+extern const shell_hist_ops_t shell_hist_file;
+
+
+shell_histfile_t *shellHistFileOpen(const char *path);
+void shellHistFileClose(shell_histfile_t *phist);
+s_err_t shellHistFileAppend(shell_histfile_t *phist, const char *line);
+uint16_t shellHistFileLoad(shell_histfile_t *phist, char lines[][SHELL_HISTORY_CMD_SIZE], uint16_t max);
+s_err_t shellHistFileCompact(shell_histfile_t *phist);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_HISTFILE_H */
@@ -0,0 +1,328 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_io.c
+* @details I/O backends of the shell terminal
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 15:31:02
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <string.h>
+
+#include "shell_io.h"
+
+#ifdef SHELL_IO_HAS_FD
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+
+
+
+
+//Declare Prototype
+static int32_t shell_io_file_read(void *ctx, uint8_t *buf, size_t len);
+static int32_t shell_io_file_write(void *ctx, const uint8_t *buf, size_t len);
+static int32_t shell_io_ring_read(void *ctx, uint8_t *buf, size_t len);
+static int32_t shell_io_ring_write(void *ctx, const uint8_t *buf, size_t len);
+
+#ifdef SHELL_IO_HAS_FD
+static int32_t shell_io_winsize(int fd, uint16_t *nrows, uint16_t *ncols);
+static int32_t shell_io_file_winsize(void *ctx, uint16_t *nrows, uint16_t *ncols);
+static int32_t shell_io_fd_read(void *ctx, uint8_t *buf, size_t len);
+static int32_t shell_io_fd_write(void *ctx, const uint8_t *buf, size_t len);
+static int32_t shell_io_fd_winsize(void *ctx, uint16_t *nrows, uint16_t *ncols);
+#endif
+
+
+
+const shell_io_t shell_io_file = {
+    shell_io_file_read,
+    shell_io_file_write,
+#ifdef SHELL_IO_HAS_FD
+    shell_io_file_winsize,
+#else
+    NULL,
+#endif
+};
+
+const shell_io_t shell_io_ring = {
+    shell_io_ring_read,
+    shell_io_ring_write,
+    NULL,
+};
+
+#ifdef SHELL_IO_HAS_FD
+const shell_io_t shell_io_fd = {
+    shell_io_fd_read,
+    shell_io_fd_write,
+    shell_io_fd_winsize,
+};
+#endif
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+// FILE backend, one char per read as fgetc() did
+static int32_t shell_io_file_read(void *ctx, uint8_t *buf, size_t len)
+{
+    shell_io_file_t *file = (shell_io_file_t *) ctx;
+    int ch;
+
+    if (!len || (file->in == NULL)) return 0;
+
+    ch = fgetc(file->in);
+    if (ch == EOF) {
+        ch = feof(file->in) ? -1 : 0;
+        clearerr(file->in);
+        return ch;
+    }
+
+    *buf = ch;
+    return 1;
+}
+
+
+static int32_t shell_io_file_write(void *ctx, const uint8_t *buf, size_t len)
+{
+    shell_io_file_t *file = (shell_io_file_t *) ctx;
+    size_t n;
+
+    n = fwrite(buf, 1, len, file->out);
+    fflush(file->out);
+
+    return (!n && len) ? -1 : (int32_t) n;
+}
+
+
+//*****************************************************************************
+// Ring backend, the input is never closed
+static int32_t shell_io_ring_read(void *ctx, uint8_t *buf, size_t len)
+{
+    shell_io_ring_t *ring = (shell_io_ring_t *) ctx;
+
+    return shellRingRead(ring->rx, buf, len);
+}
+
+
+static int32_t shell_io_ring_write(void *ctx, const uint8_t *buf, size_t len)
+{
+    shell_io_ring_t *ring = (shell_io_ring_t *) ctx;
+
+    return shellRingWrite(ring->tx, buf, len);
+}
+
+
+#ifdef SHELL_IO_HAS_FD
+//*****************************************************************************
+static int32_t shell_io_winsize(int fd, uint16_t *nrows, uint16_t *ncols)
+{
+#ifdef TIOCGWINSZ
+    struct winsize ws;
+
+    if ((fd >= 0) && (ioctl(fd, TIOCGWINSZ, &ws) == 0) && ws.ws_row && ws.ws_col) {
+        *nrows = ws.ws_row;
+        *ncols = ws.ws_col;
+        return 0;
+    }
+#endif
+
+    return -1;
+}
+
+
+static int32_t shell_io_file_winsize(void *ctx, uint16_t *nrows, uint16_t *ncols)
+{
+    shell_io_file_t *file = (shell_io_file_t *) ctx;
+
+    return shell_io_winsize(fileno(file->out), nrows, ncols);
+}
+
+
+//*****************************************************************************
+// Descriptor backend, no stdio lock
+static int32_t shell_io_fd_read(void *ctx, uint8_t *buf, size_t len)
+{
+    shell_io_fd_t *fd = (shell_io_fd_t *) ctx;
+    ssize_t n;
+
+    do {
+        n = read(fd->in, buf, len);
+    } while ((n < 0) && (errno == EINTR));
+
+    if (n > 0) return n;
+    if ((n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) return 0;
+
+    return -1;
+}
+
+
+static int32_t shell_io_fd_write(void *ctx, const uint8_t *buf, size_t len)
+{
+    shell_io_fd_t *fd = (shell_io_fd_t *) ctx;
+    ssize_t n;
+
+    do {
+        n = write(fd->out, buf, len);
+    } while ((n < 0) && (errno == EINTR));
+
+    if (n >= 0) return n;
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) return 0;
+
+    return -1;
+}
+
+
+static int32_t shell_io_fd_winsize(void *ctx, uint16_t *nrows, uint16_t *ncols)
+{
+    shell_io_fd_t *fd = (shell_io_fd_t *) ctx;
+
+    return shell_io_winsize(fd->out, nrows, ncols);
+}
+#endif
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+bool shellRingInit(shell_ring_t *ring, uint8_t *buf, uint32_t size)
+{
+    /* the indexes are masked */
+    if (!size || (size & (size - 1))) return false;
+
+    ring->buf = buf;
+    ring->size = size;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->overflow, 0);
+    atomic_init(&ring->high_water, 0);
+
+    return true;
+}
+
+
+//*****************************************************************************
+// Producer side, return the number of bytes written, the rest is counted
+// as overflow
+uint32_t shellRingWrite(shell_ring_t *ring, const uint8_t *data, uint32_t len)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t room = ring->size - (head - tail);
+    uint32_t pos = head & (ring->size - 1);
+    uint32_t first;
+
+    if (len > room) {
+        atomic_fetch_add_explicit(&ring->overflow, len - room, memory_order_relaxed);
+        len = room;
+    }
+
+    /* up to the end of the buffer then from the start */
+    first = ring->size - pos;
+    if (first > len) first = len;
+
+    memcpy(&ring->buf[pos], data, first);
+    memcpy(ring->buf, data + first, len - first);
+
+    shellRingPutCommit(ring, len);
+
+    return len;
+}
+
+
+//*****************************************************************************
+// Consumer side, return the number of bytes read
+uint32_t shellRingRead(shell_ring_t *ring, uint8_t *data, uint32_t len)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t count = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+    uint32_t pos = tail & (ring->size - 1);
+    uint32_t first;
+
+    if (len > count) len = count;
+
+    first = ring->size - pos;
+    if (first > len) first = len;
+
+    memcpy(data, &ring->buf[pos], first);
+    memcpy(data + first, ring->buf, len - first);
+
+    atomic_store_explicit(&ring->tail, tail + len, memory_order_release);
+
+    return len;
+}
+
+
+uint32_t shellRingCount(shell_ring_t *ring)
+{
+    return atomic_load_explicit(&ring->head, memory_order_acquire) -
+           atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+
+//*****************************************************************************
+// Producer side without copy: free bytes in one piece at *ptr, a DMA
+// transfer fills them then shellRingPutCommit() publishes them
+uint32_t shellRingPutSpace(shell_ring_t *ring, uint8_t **ptr)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t room = ring->size - (head - tail);
+    uint32_t pos = head & (ring->size - 1);
+
+    *ptr = &ring->buf[pos];
+
+    return (room < ring->size - pos) ? room : (ring->size - pos);
+}
+
+
+void shellRingPutCommit(shell_ring_t *ring, uint32_t len)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed) + len;
+    uint32_t count = head - atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    atomic_store_explicit(&ring->head, head, memory_order_release);
+
+    /* only the producer writes it */
+    if (count > atomic_load_explicit(&ring->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->high_water, count, memory_order_relaxed);
+    }
+}
+
+
+void shellRingStats(shell_ring_t *ring, uint32_t *overflow, uint32_t *high_water)
+{
+    if (overflow != NULL) *overflow = atomic_load_explicit(&ring->overflow, memory_order_relaxed);
+    if (high_water != NULL) *high_water = atomic_load_explicit(&ring->high_water, memory_order_relaxed);
+}
@@ -0,0 +1,145 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_io.h
+* @details I/O backends of the shell terminal
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 15:31:02
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_IO_H
+#define _SHELL_IO_H
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+#include <atomic>
+typedef std::atomic<uint32_t> shell_atomic_u32_t;
+#else
+#include <stdatomic.h>
+typedef _Atomic uint32_t shell_atomic_u32_t;
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SHELL_IO_HAS_FD                 1          //!< Descriptor backend available
+#endif
+
+
+/**
+ * I/O backend operations
+ *
+ * read returns the number of bytes read, 0 when nothing is available
+ * and a negative value once the input is closed. write returns the number
+ * of bytes taken, it can be less than len, or a negative value on error.
+ */
+struct shell_io
+{
+    int32_t (*read)(void *ctx, uint8_t *buf, size_t len);
+    int32_t (*write)(void *ctx, const uint8_t *buf, size_t len);
+    int32_t (*winsize)(void *ctx, uint16_t *nrows, uint16_t *ncols);  //!< Optional
+};
+typedef struct shell_io shell_io_t;
+
+
+/**
+ * FILE backend context, for compatibility
+ */
+struct shell_io_file
+{
+    FILE                *in;
+    FILE                *out;
+};
+typedef struct shell_io_file shell_io_file_t;
+
+/**
+ * Descriptor backend context
+ */
+struct shell_io_fd
+{
+    int                 in;
+    int                 out;
+};
+typedef struct shell_io_fd shell_io_fd_t;
+
+
+/**
+ * Wait-free single producer, single consumer byte ring, the size is a
+ * power of 2. The producer can be an interrupt or another thread.
+ */
+struct shell_ring
+{
+    uint8_t             *buf;
+    uint32_t            size;
+    shell_atomic_u32_t  head;                       //!< Written by the producer
+    shell_atomic_u32_t  tail;                       //!< Written by the consumer
+    shell_atomic_u32_t  overflow;                   //!< Bytes refused, ring full
+    shell_atomic_u32_t  high_water;                 //!< Most bytes held at once
+};
+typedef struct shell_ring shell_ring_t;
+
+/**
+ * Ring backend context, for UART interrupts and tests
+ */
+struct shell_io_ring
+{
+    shell_ring_t        *rx;
+    shell_ring_t        *tx;
+};
+typedef struct shell_io_ring shell_io_ring_t;
+
+
+
+extern const shell_io_t shell_io_file;
+extern const shell_io_t shell_io_ring;
+#ifdef SHELL_IO_HAS_FD
+extern const shell_io_t shell_io_fd;
+#endif
+
+
+bool shellRingInit(shell_ring_t *ring, uint8_t *buf, uint32_t size);
+uint32_t shellRingWrite(shell_ring_t *ring, const uint8_t *data, uint32_t len);
+uint32_t shellRingRead(shell_ring_t *ring, uint8_t *data, uint32_t len);
+uint32_t shellRingCount(shell_ring_t *ring);
+uint32_t shellRingPutSpace(shell_ring_t *ring, uint8_t **ptr);
+void shellRingPutCommit(shell_ring_t *ring, uint32_t len);
+void shellRingStats(shell_ring_t *ring, uint32_t *overflow, uint32_t *high_water);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_IO_H */
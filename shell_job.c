@@ -0,0 +1,469 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_job.c
+* @details Commands run on a pool of worker threads
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 09:12:40
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "shell_job.h"
+#include "shell_vars.h"
+
+
+
+/* Job run by the current worker thread */
+static _Thread_local shell_job_t *shell_job_current;
+
+static const char * const shell_job_state_name[] = {
+    "Free", "Queued", "Running", "Done"
+};
+
+
+
+//Declare Prototype
+static void *shell_job_worker(void *arg);
+static shell_job_t *shell_job_next(shell_job_pool_t *pool);
+static void shell_job_drain(shell_job_t *job);
+static void shell_job_finish(shell_job_pool_t *pool, shell_job_t *job);
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+// oldest queued job, the pool is locked
+static shell_job_t *shell_job_next(shell_job_pool_t *pool)
+{
+    shell_job_t *next = NULL;
+    int i;
+
+    for (i = 0; i < SHELL_JOB_MAX; i++) {
+        if ((pool->jobs[i].state == SHELL_JOB_QUEUED) &&
+            ((next == NULL) || (pool->jobs[i].id < next->id))) {
+            next = &pool->jobs[i];
+        }
+    }
+
+    return next;
+}
+
+
+//*****************************************************************************
+static void *shell_job_worker(void *arg)
+{
+    shell_job_pool_t *pool = (shell_job_pool_t *) arg;
+    shell_job_t *job;
+
+    pthread_mutex_lock(&pool->lock);
+
+    while (!pool->stop) {
+        job = shell_job_next(pool);
+        if (job == NULL) {
+            pthread_cond_wait(&pool->cond, &pool->lock);
+            continue;
+        }
+
+        job->state = SHELL_JOB_RUNNING;
+        pthread_mutex_unlock(&pool->lock);
+
+        /* cancelled before it started */
+        if (atomic_load(&job->cancel)) {
+            job->status = SYS_EINT;
+        }
+        else {
+            shell_job_current = job;
+            job->status = job->cmd->func(&job->shell, job->argc, job->argv);
+            shell_job_current = NULL;
+        }
+
+        /* the session reads the end of the output */
+        shellFlush(&job->shell);
+        close(job->io.out);
+
+        pthread_mutex_lock(&pool->lock);
+        job->state = SHELL_JOB_DONE;
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+
+//*****************************************************************************
+// merge the complete lines written by the handler
+static void shell_job_drain(shell_job_t *job)
+{
+    ssize_t nread;
+    size_t len;
+
+    while (!job->eof) {
+        nread = read(job->fd_out, &job->out[job->out_len], sizeof(job->out) - job->out_len);
+        if (nread == 0) job->eof = true;
+        if (nread <= 0) {
+            if ((nread < 0) && (errno == EINTR)) continue;
+            break;
+        }
+
+        job->out_len += nread;
+
+        for (len = job->out_len; len > 0; len--) {
+            if (job->out[len - 1] == '\n') break;
+        }
+
+        /* a line longer than the buffer goes as it is */
+        if (!len && (job->out_len == sizeof(job->out))) len = job->out_len;
+
+        if (len) {
+            shellPrintAsync(job->parent, job->out, len);
+            memmove(job->out, &job->out[len], job->out_len - len);
+            job->out_len -= len;
+        }
+    }
+}
+
+
+//*****************************************************************************
+// report the end of the job and release its slot
+static void shell_job_finish(shell_job_pool_t *pool, shell_job_t *job)
+{
+    shellObject_t *pshell = job->parent;
+    char msg[SHELL_BUFFER_LINE_LEN + 32];
+    int len;
+
+    shellPrintAsync(pshell, job->out, job->out_len);
+    close(job->fd_out);
+
+    if (job->background) {
+        if (job->status == SYS_EOK) {
+            len = snprintf(msg, sizeof(msg), "[%u] Done %s\r\n", job->id, job->cmdline);
+        }
+        else {
+            len = snprintf(msg, sizeof(msg), "[%u] Exit %ld %s\r\n", job->id,
+                           (long) job->status, job->cmdline);
+        }
+        if (len > (int) sizeof(msg) - 1) len = sizeof(msg) - 1;
+        shellPrintAsync(pshell, msg, len);
+    }
+    else {
+        shellSetBusy(pshell, false);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    job->state = SHELL_JOB_FREE;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+shell_job_pool_t *shellJobOpen(uint8_t nworkers)
+{
+    shell_job_pool_t *pool;
+
+    if (!nworkers) nworkers = 1;
+    if (nworkers > SHELL_JOB_WORKERS_MAX) nworkers = SHELL_JOB_WORKERS_MAX;
+
+    pool = (shell_job_pool_t *) malloc(sizeof(shell_job_pool_t));
+    if (pool == NULL) return NULL;
+
+    memset(pool, 0, sizeof(shell_job_pool_t));
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+
+    for (pool->nworkers = 0; pool->nworkers < nworkers; pool->nworkers++) {
+        if (pthread_create(&pool->threads[pool->nworkers], NULL, shell_job_worker, pool)) {
+            shellJobClose(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+
+//*****************************************************************************
+// Stop the workers, the running jobs are cancelled and waited
+s_err_t shellJobClose(shell_job_pool_t *pool)
+{
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    for (i = 0; i < SHELL_JOB_MAX; i++) {
+        atomic_store(&pool->jobs[i].cancel, true);
+    }
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->nworkers; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    for (i = 0; i < SHELL_JOB_MAX; i++) {
+        if (pool->jobs[i].state == SHELL_JOB_QUEUED) {
+            close(pool->jobs[i].io.out);
+        }
+        if (pool->jobs[i].state != SHELL_JOB_FREE) {
+            close(pool->jobs[i].fd_out);
+        }
+    }
+
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Queue the command of the line, a trailing '&' runs it in background.
+// Without '&' the session is busy until shellJobPoll() sees the job done.
+s_err_t shellJobRun(shell_job_pool_t *pool, shellObject_t *pshell, char *line)
+{
+    shell_job_t *job = NULL;
+    bool background = false;
+    char *end;
+    int fds[2];
+    int i;
+
+    /* '&' suffix */
+    end = line + strlen(line);
+    while ((end > line) && ((end[-1] == ' ') || (end[-1] == '\t'))) end--;
+    if ((end > line) && (end[-1] == '&')) {
+        background = true;
+        end--;
+        while ((end > line) && ((end[-1] == ' ') || (end[-1] == '\t'))) end--;
+    }
+    *end = 0;
+
+    pthread_mutex_lock(&pool->lock);
+
+    for (i = 0; i < SHELL_JOB_MAX; i++) {
+        if (pool->jobs[i].state == SHELL_JOB_FREE) {
+            job = &pool->jobs[i];
+            break;
+        }
+    }
+
+    if (job == NULL) {
+        pthread_mutex_unlock(&pool->lock);
+        shellPrintf(pshell, "jobs: no free slot\r\n");
+        return SYS_EFULL;
+    }
+
+#if SHELL_CFG_VARS
+    /* expanded here, the job doesn't see the variables */
+    if (shellVarsExpand(pshell, line, job->cmdline, sizeof(job->cmdline)) < 0) {
+        pthread_mutex_unlock(&pool->lock);
+        shellPrintf(pshell, "jobs: line too long once expanded\r\n");
+        return SYS_ERROR;
+    }
+#else
+    strncpy(job->cmdline, line, sizeof(job->cmdline) - 1);
+    job->cmdline[sizeof(job->cmdline) - 1] = 0;
+#endif
+    memcpy(job->line, job->cmdline, sizeof(job->line));
+
+    job->argc = shellParseArgs(job->line, job->argv, SHELL_MAX_ARGS);
+    if (!job->argc) {
+        pthread_mutex_unlock(&pool->lock);
+        return SYS_EOK;
+    }
+
+    if (!strcmp(job->argv[0], "jobs")) {
+        pthread_mutex_unlock(&pool->lock);
+        shellJobList(pool, pshell);
+        return SYS_EOK;
+    }
+
+    job->cmd = shellFindCommand(pshell, job->argv[0]);
+    if (job->cmd == NULL) {
+        pthread_mutex_unlock(&pool->lock);
+        shellPrintf(pshell, "%s: command not found\r\n", job->cmdline);
+        return SYS_ENOSYS;
+    }
+
+    if (pipe(fds)) {
+        pthread_mutex_unlock(&pool->lock);
+        return SYS_EIO;
+    }
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+    /* the handler has its own session writing in the pipe, built from
+     * nothing: only what a command needs is taken from the parent */
+    memset(&job->shell, 0, sizeof(job->shell));
+    vtInit(&job->vt, pshell->vt->nrows, pshell->vt->ncols);
+    job->io.in = -1;
+    job->io.out = fds[1];
+    job->shell.cmds = pshell->cmds;
+    job->shell.ncmds = pshell->ncmds;
+    job->shell.prompt = pshell->prompt;
+    job->shell.prompt_len = pshell->prompt_len;
+    job->shell.vt = &job->vt;
+    job->shell.io = &shell_io_fd;
+    job->shell.io_ctx = &job->io;
+    job->shell.state = SHELL_STATE_BUSY;
+#if SHELL_CFG_TRACE
+    /* the ring takes a slot by an atomic add, the worker writes in it */
+    job->shell.trace = pshell->trace;
+    job->shell.trace_on = pshell->trace_on;
+#endif
+
+    job->fd_out = fds[0];
+    job->eof = false;
+    job->out_len = 0;
+    job->status = SYS_EOK;
+    job->parent = pshell;
+    job->background = background;
+    atomic_store(&job->cancel, false);
+
+    if (!++pool->next_id) pool->next_id++;
+    job->id = pool->next_id;
+
+    job->state = SHELL_JOB_QUEUED;
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    if (background) {
+        shellPrintf(pshell, "[%u] %s\r\n", job->id, job->cmdline);
+    }
+    else {
+        shellSetBusy(pshell, true);
+    }
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Call it with shellEngine() from the session thread: the output of the jobs
+// is merged above the edit line and Ctrl-C cancels the foreground job
+void shellJobPoll(shell_job_pool_t *pool, shellObject_t *pshell)
+{
+    bool intr = shellInterrupted(pshell);
+    shell_job_t *job;
+    uint8_t state;
+    int i;
+
+    for (i = 0; i < SHELL_JOB_MAX; i++) {
+        job = &pool->jobs[i];
+
+        pthread_mutex_lock(&pool->lock);
+        state = job->state;
+        if (job->parent != pshell) state = SHELL_JOB_FREE;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (state == SHELL_JOB_FREE) continue;
+
+        /* the handler sees it by shellJobCancelled() or shellInterrupted() */
+        if (intr && !job->background) {
+            atomic_store(&job->cancel, true);
+            job->shell.intr = 1;
+        }
+
+        shell_job_drain(job);
+
+        if ((state == SHELL_JOB_DONE) && job->eof) {
+            shell_job_finish(pool, job);
+        }
+    }
+}
+
+
+//*****************************************************************************
+// "jobs" command
+void shellJobList(shell_job_pool_t *pool, shellObject_t *pshell)
+{
+    shell_job_t *job;
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+
+    for (i = 0; i < SHELL_JOB_MAX; i++) {
+        job = &pool->jobs[i];
+
+        if ((job->state != SHELL_JOB_FREE) && (job->parent == pshell)) {
+            shellPrintf(pshell, "[%u] %-8s %s%s\r\n", job->id,
+                        shell_job_state_name[job->state], job->cmdline,
+                        job->background ? " &" : "");
+        }
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+}
+
+
+//*****************************************************************************
+// Ask a job to stop, the handler polls shellJobCancelled() or shellInterrupted()
+s_err_t shellJobCancel(shell_job_pool_t *pool, uint16_t id)
+{
+    s_err_t err = SYS_ERROR;
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+
+    for (i = 0; i < SHELL_JOB_MAX; i++) {
+        if ((pool->jobs[i].state != SHELL_JOB_FREE) && (pool->jobs[i].id == id)) {
+            atomic_store(&pool->jobs[i].cancel, true);
+            pool->jobs[i].shell.intr = 1;
+            err = SYS_EOK;
+        }
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return err;
+}
+
+
+//*****************************************************************************
+// Called by a handler, true when its job must stop
+bool shellJobCancelled(void)
+{
+    return (shell_job_current != NULL) && atomic_load(&shell_job_current->cancel);
+}
@@ -0,0 +1,128 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_job.h
+* @details Commands run on a pool of worker threads
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 09:12:40
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_JOB_H
+#define _SHELL_JOB_H
+
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef SHELL_JOB_MAX
+#define SHELL_JOB_MAX                   8          //!< Jobs running or queued
+#endif
+
+#ifndef SHELL_JOB_WORKERS_MAX
+#define SHELL_JOB_WORKERS_MAX           8          //!< Max threads of a pool
+#endif
+
+#ifndef SHELL_JOB_OUT_LEN
+#define SHELL_JOB_OUT_LEN               256        //!< Output merged line by line
+#endif
+
+
+#define SHELL_JOB_FREE                  0
+#define SHELL_JOB_QUEUED                1
+#define SHELL_JOB_RUNNING               2
+#define SHELL_JOB_DONE                  3
+
+
+
+/**
+ * Job Structure
+ */
+struct shell_job
+{
+    uint8_t             state;
+    uint16_t            id;                         //!< Number shown by "jobs"
+    bool                background;                 //!< Started with '&'
+    atomic_bool         cancel;                     //!< Ctrl-C asked the job to stop
+    int32_t             status;                     //!< Returned by the handler
+
+    shellObject_t       *parent;                    //!< Session owning the job
+    const shell_cmd_t   *cmd;
+    int32_t             argc;
+    char                *argv[SHELL_MAX_ARGS + 1];
+    char                line[SHELL_BUFFER_LINE_LEN];
+    char                cmdline[SHELL_BUFFER_LINE_LEN]; //!< Line as typed, for "jobs"
+
+    shellObject_t       shell;                      //!< Session given to the handler
+    vt100_t             vt;
+    shell_io_fd_t       io;                         //!< Write side of the handler output
+    int                 fd_out;                     //!< Read side of the handler output
+    bool                eof;
+    uint16_t            out_len;
+    char                out[SHELL_JOB_OUT_LEN];     //!< Partial line not merged yet
+};
+typedef struct shell_job shell_job_t;
+
+
+/**
+ * Worker Pool Structure
+ */
+struct shell_job_pool
+{
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    pthread_t           threads[SHELL_JOB_WORKERS_MAX];
+    uint8_t             nworkers;
+    bool                stop;
+    uint16_t            next_id;
+    shell_job_t         jobs[SHELL_JOB_MAX];
+};
+typedef struct shell_job_pool shell_job_pool_t;
+
+
+
+
+shell_job_pool_t *shellJobOpen(uint8_t nworkers);
+s_err_t shellJobClose(shell_job_pool_t *pool);
+s_err_t shellJobRun(shell_job_pool_t *pool, shellObject_t *pshell, char *line);
+void shellJobPoll(shell_job_pool_t *pool, shellObject_t *pshell);
+void shellJobList(shell_job_pool_t *pool, shellObject_t *pshell);
+s_err_t shellJobCancel(shell_job_pool_t *pool, uint16_t id);
+bool shellJobCancelled(void);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_JOB_H */
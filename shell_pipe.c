@@ -0,0 +1,499 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_pipe.c
+* @details Pipelines of filters on the output of a command
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 01:47:33
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <string.h>
+
+#include "shell_pipe.h"
+#include "shell_args.h"
+
+
+
+
+
+#define PIPE_HEAD_LINES                 10         //!< "head" without argument
+
+#define PIPE_BAR                        "|"
+#define PIPE_TO_FILE                    ">"
+
+
+
+//Declare Prototype
+static inline shell_pipe_t *pipe_of(shellObject_t *pshell);
+static inline bool pipe_token(const char *word);
+static const shell_filter_t *pipe_filter(shell_pipe_t *pipe, const char *name);
+static s_err_t pipe_sink(shell_pipe_t *pipe, const uint8_t *data, uint32_t len);
+static bool pipe_search(const uint8_t *line, uint32_t len, const char *text, uint32_t text_len);
+
+static s_err_t grep_open(shellObject_t *pshell, shell_stage_t *stage);
+static s_err_t grep_line(shell_stage_t *stage, const uint8_t *line, uint32_t len);
+static s_err_t grep_filter(shell_stage_t *stage, const uint8_t *data, uint32_t len);
+static s_err_t head_open(shellObject_t *pshell, shell_stage_t *stage);
+static s_err_t head_line(shell_stage_t *stage, const uint8_t *line, uint32_t len);
+static s_err_t head_filter(shell_stage_t *stage, const uint8_t *data, uint32_t len);
+static s_err_t count_line(shell_stage_t *stage, const uint8_t *line, uint32_t len);
+static s_err_t count_filter(shell_stage_t *stage, const uint8_t *data, uint32_t len);
+
+
+
+static const shell_filter_t pipe_builtin[] = {
+    { "grep", grep_open, grep_filter, "Lines with the text, -v without" },
+    { "head", head_open, head_filter, "First lines, 10 by default" },
+    { "count", NULL, count_filter, "Number of lines" },
+};
+
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+static inline shell_pipe_t *pipe_of(shellObject_t *pshell)
+{
+#if SHELL_CFG_PIPE
+    return pshell->pipe;
+#else
+    (void) pshell;
+
+    return NULL;
+#endif
+}
+
+
+static inline bool pipe_token(const char *word)
+{
+    return !strcmp(word, PIPE_BAR) || !strcmp(word, PIPE_TO_FILE);
+}
+
+
+//*****************************************************************************
+// the filters of the application first, they can replace a built-in one
+static const shell_filter_t *pipe_filter(shell_pipe_t *pipe, const char *name)
+{
+    uint16_t i;
+
+    for (i = 0; i < pipe->nfilters; i++) {
+        if (!strcmp(pipe->filters[i].name, name)) return &pipe->filters[i];
+    }
+
+    for (i = 0; i < sizeof(pipe_builtin) / sizeof(pipe_builtin[0]); i++) {
+        if (!strcmp(pipe_builtin[i].name, name)) return &pipe_builtin[i];
+    }
+
+    return NULL;
+}
+
+
+//*****************************************************************************
+// end of the pipeline, the file or the session past its output buffer
+static s_err_t pipe_sink(shell_pipe_t *pipe, const uint8_t *data, uint32_t len)
+{
+    if (pipe->file != NULL) {
+        return (fwrite(data, 1, len, pipe->file) == len) ? SYS_EOK : SYS_EIO;
+    }
+
+    pipe->active = false;
+    shellWriteDirect(pipe->pshell, data, len);
+    pipe->active = true;
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+static bool pipe_search(const uint8_t *line, uint32_t len, const char *text, uint32_t text_len)
+{
+    const uint8_t *end = line + len;
+    const uint8_t *at;
+
+    if (!text_len) return true;
+
+    while ((uint32_t) (end - line) >= text_len) {
+        at = (const uint8_t *) memchr(line, text[0], end - line - text_len + 1);
+        if (at == NULL) return false;
+        if (!memcmp(at, text, text_len)) return true;
+        line = at + 1;
+    }
+
+    return false;
+}
+
+
+//*****************************************************************************
+// grep [-v] text
+static s_err_t grep_open(shellObject_t *pshell, shell_stage_t *stage)
+{
+    int32_t i = 1;
+
+    if ((stage->argc > i) && !strcmp(stage->argv[i], "-v")) {
+        stage->invert = true;
+        i++;
+    }
+
+    if (stage->argc != i + 1) {
+        shellPrintf(pshell, "grep: usage: grep [-v] text\r\n");
+        return SYS_ERROR;
+    }
+
+    stage->text = stage->argv[i];
+    stage->limit = strlen(stage->text);
+
+    return SYS_EOK;
+}
+
+
+static s_err_t grep_line(shell_stage_t *stage, const uint8_t *line, uint32_t len)
+{
+    if (pipe_search(line, len, stage->text, stage->limit) == stage->invert) return SYS_EOK;
+
+    return shellPipeEmit(stage, line, len);
+}
+
+
+static s_err_t grep_filter(shell_stage_t *stage, const uint8_t *data, uint32_t len)
+{
+    return shellPipeLines(stage, data, len, grep_line);
+}
+
+
+//*****************************************************************************
+// head [lines]
+static s_err_t head_open(shellObject_t *pshell, shell_stage_t *stage)
+{
+    bool bad = (stage->argc > 2);
+
+    stage->limit = PIPE_HEAD_LINES;
+
+    if (stage->argc == 2) {
+        bad = (shellArgsNumber(stage->argv[1], &stage->limit) != SYS_EOK) || (stage->limit < 0);
+    }
+
+    if (bad) {
+        shellPrintf(pshell, "head: usage: head [lines]\r\n");
+        return SYS_ERROR;
+    }
+
+    return SYS_EOK;
+}
+
+
+static s_err_t head_line(shell_stage_t *stage, const uint8_t *line, uint32_t len)
+{
+    if (stage->count >= stage->limit) return SYS_EOK;
+
+    /* the command is told to stop once it's reached */
+    if (++stage->count == stage->limit) shellPipeStop(stage);
+
+    return shellPipeEmit(stage, line, len);
+}
+
+
+static s_err_t head_filter(shell_stage_t *stage, const uint8_t *data, uint32_t len)
+{
+    if (!stage->limit) {
+        shellPipeStop(stage);
+        return SYS_EOK;
+    }
+
+    return shellPipeLines(stage, data, len, head_line);
+}
+
+
+//*****************************************************************************
+// count, written at the end
+static s_err_t count_line(shell_stage_t *stage, const uint8_t *line, uint32_t len)
+{
+    (void) line;
+    (void) len;
+
+    stage->count++;
+
+    return SYS_EOK;
+}
+
+
+static s_err_t count_filter(shell_stage_t *stage, const uint8_t *data, uint32_t len)
+{
+    char text[24];
+    int n;
+
+    shellPipeLines(stage, data, len, count_line);
+    if (data != SHELL_PIPE_END) return SYS_EOK;
+
+    n = snprintf(text, sizeof(text), "%lld\r\n", (long long) stage->count);
+
+    return shellPipeEmit(stage, (const uint8_t *) text, n);
+}
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+//*****************************************************************************
+// Give the pipelines to the session, filters can be NULL for the built-in
+// ones only
+s_err_t shellPipeOpen(shellObject_t *pshell, shell_pipe_t *pipe, const shell_filter_t *filters, uint16_t nfilters)
+{
+#if SHELL_CFG_PIPE
+    if ((pipe == NULL) || ((filters == NULL) && nfilters)) return SYS_ERROR;
+
+    memset(pipe, 0, sizeof(shell_pipe_t));
+    pipe->pshell = pshell;
+    pipe->filters = filters;
+    pipe->nfilters = nfilters;
+    pshell->pipe = pipe;
+
+    return SYS_EOK;
+#else
+    (void) pshell;
+    (void) pipe;
+    (void) filters;
+    (void) nfilters;
+
+    return SYS_ENOSYS;
+#endif
+}
+
+
+void shellPipeClose(shellObject_t *pshell)
+{
+    shellPipeEnd(pshell);
+
+#if SHELL_CFG_PIPE
+    pshell->pipe = NULL;
+#endif
+}
+
+
+//*****************************************************************************
+// Take the "| filter" and "> file" out of the words of a line, the output
+// of the session goes through them until shellPipeEnd(). Nothing is done
+// for a line without them. Called by shellExec().
+s_err_t shellPipeBegin(shellObject_t *pshell, int32_t *argc, char *argv[])
+{
+    shell_pipe_t *pipe = pipe_of(pshell);
+    shell_stage_t *stage;
+    const char *file = NULL;
+    int32_t i, start, cmd;
+
+    if ((pipe == NULL) || pipe->active) return SYS_EOK;
+
+    for (cmd = 0; (cmd < *argc) && !pipe_token(argv[cmd]); cmd++);
+    if (cmd == *argc) return SYS_EOK;
+
+    if (!cmd) {
+        shellPrintf(pshell, "%s: no command before it\r\n", argv[0]);
+        return SYS_ERROR;
+    }
+
+    memset(pipe->stage, 0, sizeof(pipe->stage));
+    pipe->nstages = 0;
+    pipe->stop = false;
+    pipe->err = SYS_EOK;
+
+    for (i = cmd; i < *argc; ) {
+        if (!strcmp(argv[i], PIPE_TO_FILE)) {
+            if (i + 2 != *argc) {
+                shellPrintf(pshell, "%s: one file, at the end\r\n", PIPE_TO_FILE);
+                return SYS_ERROR;
+            }
+            file = argv[i + 1];
+            break;
+        }
+
+        for (start = ++i; (i < *argc) && !pipe_token(argv[i]); i++);
+
+        if (i == start) {
+            shellPrintf(pshell, "%s: no filter after it\r\n", PIPE_BAR);
+            return SYS_ERROR;
+        }
+
+        if (pipe->nstages == SHELL_PIPE_STAGES) {
+            shellPrintf(pshell, "%s: %d filters at most\r\n", PIPE_BAR, SHELL_PIPE_STAGES);
+            return SYS_ERROR;
+        }
+
+        stage = &pipe->stage[pipe->nstages++];
+        stage->pipe = pipe;
+        stage->argc = i - start;
+        stage->argv = &argv[start];
+        stage->filter = pipe_filter(pipe, argv[start]);
+
+        if (stage->filter == NULL) {
+            shellPrintf(pshell, "%s: filter not found\r\n", argv[start]);
+            return SYS_ERROR;
+        }
+    }
+
+    for (i = 0; i < pipe->nstages; i++) {
+        stage = &pipe->stage[i];
+        if ((stage->filter->open != NULL) && (stage->filter->open(pshell, stage) != SYS_EOK)) return SYS_ERROR;
+    }
+
+    if (file != NULL) {
+        pipe->file = fopen(file, "w");
+        if (pipe->file == NULL) {
+            shellPrintf(pshell, "%s: can't be written\r\n", file);
+            return SYS_EIO;
+        }
+        setvbuf(pipe->file, pipe->file_buf, _IOFBF, sizeof(pipe->file_buf));
+    }
+
+    /* what was written before isn't filtered */
+    shellFlush(pshell);
+
+    *argc = cmd;
+    argv[cmd] = NULL;
+    pipe->active = true;
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// The command is done, the filters give what they kept and the file is
+// closed
+s_err_t shellPipeEnd(shellObject_t *pshell)
+{
+    shell_pipe_t *pipe = pipe_of(pshell);
+    s_err_t err;
+    uint8_t i;
+
+    if ((pipe == NULL) || !pipe->active) return SYS_EOK;
+
+    shellFlush(pshell);
+
+    for (i = 0; (i < pipe->nstages) && (pipe->err == SYS_EOK); i++) {
+        pipe->err = pipe->stage[i].filter->func(&pipe->stage[i], SHELL_PIPE_END, 0);
+    }
+
+    pipe->active = false;
+    err = pipe->err;
+
+    if (pipe->file != NULL) {
+        if (fclose(pipe->file) && (err == SYS_EOK)) err = SYS_EIO;
+        pipe->file = NULL;
+    }
+
+    /* the stop or the error was for this command only */
+    if (pipe->stop || (pipe->err != SYS_EOK)) pshell->intr = 0;
+
+    if (err == SYS_EIO) shellPrintf(pshell, "%s: write error\r\n", PIPE_TO_FILE);
+
+    return err;
+}
+
+
+//*****************************************************************************
+// Output of the command, given to the first filter
+s_err_t shellPipeFeed(shell_pipe_t *pipe, const uint8_t *data, uint32_t len)
+{
+    if (pipe->stop || (pipe->err != SYS_EOK) || !len) return pipe->err;
+
+    if (pipe->nstages) pipe->err = pipe->stage[0].filter->func(&pipe->stage[0], data, len);
+    else pipe->err = pipe_sink(pipe, data, len);
+
+    /* nothing goes on, the command can stop */
+    if (pipe->err != SYS_EOK) pipe->pshell->intr = 1;
+
+    return pipe->err;
+}
+
+
+//*****************************************************************************
+// Output of a filter, given to the next one
+s_err_t shellPipeEmit(shell_stage_t *stage, const uint8_t *data, uint32_t len)
+{
+    shell_pipe_t *pipe = stage->pipe;
+    uint8_t next = (stage - pipe->stage) + 1;
+
+    if (!len) return SYS_EOK;
+
+    if (next < pipe->nstages) return pipe->stage[next].filter->func(&pipe->stage[next], data, len);
+
+    return pipe_sink(pipe, data, len);
+}
+
+
+//*****************************************************************************
+// Call func for each line of the chunk. The lines are given where they
+// are, only the one split between two chunks is put together in the
+// stage, cut at SHELL_PIPE_LINE_LEN.
+s_err_t shellPipeLines(shell_stage_t *stage, const uint8_t *data, uint32_t len, shell_line_func_t func)
+{
+    const uint8_t *nl;
+    s_err_t err = SYS_EOK;
+    uint32_t n;
+
+    if (data == SHELL_PIPE_END) {
+        if (stage->carry_len) err = func(stage, stage->carry, stage->carry_len);
+        stage->carry_len = 0;
+        return err;
+    }
+
+    while (len && (err == SYS_EOK)) {
+        nl = (const uint8_t *) memchr(data, '\n', len);
+        n = (nl != NULL) ? (nl - data + 1) : len;
+
+        if (!stage->carry_len && (nl != NULL)) {
+            err = func(stage, data, n);
+        }
+        else {
+            if (n > sizeof(stage->carry) - stage->carry_len) n = sizeof(stage->carry) - stage->carry_len;
+
+            memcpy(&stage->carry[stage->carry_len], data, n);
+            stage->carry_len += n;
+
+            if ((data[n - 1] == '\n') || (stage->carry_len == sizeof(stage->carry))) {
+                err = func(stage, stage->carry, stage->carry_len);
+                stage->carry_len = 0;
+            }
+        }
+
+        data += n;
+        len -= n;
+    }
+
+    return err;
+}
+
+
+//*****************************************************************************
+// The filter wants no more, the command is told by shellInterrupted()
+void shellPipeStop(shell_stage_t *stage)
+{
+    stage->pipe->stop = true;
+    stage->pipe->pshell->intr = 1;
+}
@@ -0,0 +1,166 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_pipe.h
+* @details Pipelines of filters on the output of a command
+*
+*   "dump routes | grep 10.0. | count" runs the command with its output
+*   given to the filters, one after the other, in the session: no process,
+*   no thread. "> file" at the end writes the output in a file instead of
+*   the terminal. The "|" and ">" are words of their own.
+*
+*   Each time the command flushes its output, the chunk goes through all
+*   the filters before it goes on: the memory used is the output buffer,
+*   whatever the size of the output. A filter is given the chunk where it
+*   is and hands on slices of it, a line is only copied when it's split
+*   between two chunks. A filter can stop the stream ("head"), the command
+*   is then told by shellInterrupted().
+*
+*   static shell_pipe_t pipe;
+*   static const shell_filter_t filters[] = {
+*       { "hex", hex_open, hex_filter, "Dump the bytes in hexadecimal" },
+*   };
+*   shellPipeOpen(pshell, &pipe, filters, 1);
+*
+*   "grep [-v] text", "head [lines]" and "count" are built in.
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 01:47:33
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_PIPE_H
+#define _SHELL_PIPE_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef SHELL_PIPE_STAGES
+#define SHELL_PIPE_STAGES               4          //!< Filters of a pipeline
+#endif
+
+#ifndef SHELL_PIPE_LINE_LEN
+#define SHELL_PIPE_LINE_LEN             256        //!< Line split between two chunks, longer ones are cut
+#endif
+
+#ifndef SHELL_PIPE_FILE_BUF
+#define SHELL_PIPE_FILE_BUF             1024       //!< Buffer of the "> file" writer
+#endif
+
+#define SHELL_PIPE_END                  NULL       //!< data of the last call to a filter
+
+
+typedef struct shell_stage shell_stage_t;
+
+/**
+ * Check the arguments of a filter when the pipeline starts. Optional
+ */
+typedef s_err_t (*shell_filter_open_t)(shellObject_t *pshell, shell_stage_t *stage);
+
+/**
+ * Chunk of the stream, SHELL_PIPE_END once it's over. The filter gives
+ * its output to shellPipeEmit().
+ */
+typedef s_err_t (*shell_filter_func_t)(shell_stage_t *stage, const uint8_t *data, uint32_t len);
+
+/**
+ * Line of a chunk with its "\n", the last one can have none
+ */
+typedef s_err_t (*shell_line_func_t)(shell_stage_t *stage, const uint8_t *line, uint32_t len);
+
+/**
+ * Filter of the table
+ */
+struct shell_filter
+{
+    const char          *name;
+    shell_filter_open_t open;
+    shell_filter_func_t func;
+    const char          *help;
+};
+typedef struct shell_filter shell_filter_t;
+
+/**
+ * Filter in a pipeline
+ */
+struct shell_stage
+{
+    const shell_filter_t *filter;
+    struct shell_pipe   *pipe;
+    int32_t             argc;                      //!< Words of the stage, the name first
+    char                **argv;
+    int64_t             count;                     //!< Free for the filter, cleared at start
+    int64_t             limit;
+    const char          *text;
+    bool                invert;
+    void                *ctx;
+    uint16_t            carry_len;
+    uint8_t             carry[SHELL_PIPE_LINE_LEN];    //!< Start of a line, see shellPipeLines()
+};
+
+/**
+ * Pipelines of a session, given by the application to shellPipeOpen()
+ */
+struct shell_pipe
+{
+    shellObject_t       *pshell;
+    const shell_filter_t *filters;                 //!< Of the application, before the built-in ones
+    uint16_t            nfilters;
+    bool                active;                    //!< The output of the session goes in stage[0]
+    bool                stop;                      //!< A filter wants no more
+    s_err_t             err;
+    uint8_t             nstages;
+    shell_stage_t       stage[SHELL_PIPE_STAGES];
+    FILE                *file;                     //!< "> file", NULL for the session
+    char                file_buf[SHELL_PIPE_FILE_BUF];
+};
+typedef struct shell_pipe shell_pipe_t;
+
+
+
+s_err_t shellPipeOpen(shellObject_t *pshell, shell_pipe_t *pipe, const shell_filter_t *filters, uint16_t nfilters);
+void shellPipeClose(shellObject_t *pshell);
+s_err_t shellPipeBegin(shellObject_t *pshell, int32_t *argc, char *argv[]);
+s_err_t shellPipeEnd(shellObject_t *pshell);
+s_err_t shellPipeFeed(shell_pipe_t *pipe, const uint8_t *data, uint32_t len);
+s_err_t shellPipeEmit(shell_stage_t *stage, const uint8_t *data, uint32_t len);
+s_err_t shellPipeLines(shell_stage_t *stage, const uint8_t *data, uint32_t len, shell_line_func_t func);
+void shellPipeStop(shell_stage_t *stage);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_PIPE_H */
@@ -0,0 +1,539 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_scrollback.c
+* @details Scrollback of a session in shared memory, for a reattach
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 00:21:45
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "shell_scrollback.h"
+
+
+
+
+
+#define SB_MAGIC                        0x4B434253 //!< "SBCK" little endian
+#define SB_HDR_SIZE                     64         //!< The ring starts after it
+#define SB_RLE                          0x00       //!< Then the count and the char
+#define SB_RLE_MIN                      4          //!< Shorter runs are left as they are
+
+/* clen and plen, the compressed text, then clen again to read backward */
+#define SB_REC_HEAD                     4
+#define SB_REC_TAIL                     2
+#define SB_REC_MAX                      (SB_REC_HEAD + 3 * SHELL_SCROLLBACK_LINE_LEN + SB_REC_TAIL)
+
+#define SB_TEXT                         0          //!< Parser of the output
+#define SB_ESC                          1
+#define SB_CSI                          2
+
+
+/**
+ * Header in the shared memory, written by the session only
+ */
+struct sb_hdr
+{
+    uint32_t            magic;
+    uint16_t            version;
+    uint16_t            line_len;
+    uint32_t            size;                      //!< Of the ring
+    _Atomic uint64_t    head;                      //!< End of the newest record, never wraps
+    _Atomic uint64_t    tail;                      //!< Start of the oldest one
+    _Atomic uint64_t    lines;
+    _Atomic uint64_t    first;                     //!< Number of the line at the tail
+    _Atomic uint64_t    bytes;
+    _Atomic uint64_t    stored;
+};
+
+/**
+ * Handle, one per session
+ */
+struct shell_scrollback
+{
+    char                *name;
+    struct sb_hdr       *hdr;
+    uint8_t             *ring;
+    size_t              map_len;
+
+    uint8_t             state;                     //!< Parser of the output
+    bool                cr;                        //!< The next char starts the line again
+    bool                aside;                     //!< Between DECSC and DECRC, drawn elsewhere
+    uint16_t            len;
+    char                line[SHELL_SCROLLBACK_LINE_LEN];   //!< Line not ended yet
+    uint8_t             rec[SB_REC_MAX];
+};
+
+
+
+//Declare Prototype
+static int32_t detached_read(void *ctx, uint8_t *buf, size_t len);
+static int32_t detached_write(void *ctx, const uint8_t *buf, size_t len);
+static void sb_get(const shell_scrollback_t *sb, uint64_t off, void *dst, uint32_t len);
+static void sb_put(shell_scrollback_t *sb, uint64_t off, const void *src, uint32_t len);
+static uint16_t sb_rle(const char *text, uint16_t len, uint8_t *out);
+static uint16_t sb_unrle(const uint8_t *data, uint16_t clen, char *out, uint16_t max);
+static void sb_commit(shell_scrollback_t *sb);
+static uint64_t sb_prev(const shell_scrollback_t *sb, uint64_t off);
+
+
+
+const shell_io_t shell_io_detached = {
+    detached_read,
+    detached_write,
+    NULL,
+};
+
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+static int32_t detached_read(void *ctx, uint8_t *buf, size_t len)
+{
+    (void) ctx;
+    (void) buf;
+    (void) len;
+
+    return 0;
+}
+
+
+static int32_t detached_write(void *ctx, const uint8_t *buf, size_t len)
+{
+    (void) ctx;
+    (void) buf;
+
+    return len;
+}
+
+
+//*****************************************************************************
+// bytes of the ring from the offset, across its end
+static void sb_get(const shell_scrollback_t *sb, uint64_t off, void *dst, uint32_t len)
+{
+    uint32_t size = sb->hdr->size;
+    uint32_t pos = off % size;
+    uint32_t n = (len < size - pos) ? len : size - pos;
+
+    memcpy(dst, &sb->ring[pos], n);
+    memcpy((uint8_t *) dst + n, sb->ring, len - n);
+}
+
+
+static void sb_put(shell_scrollback_t *sb, uint64_t off, const void *src, uint32_t len)
+{
+    uint32_t size = sb->hdr->size;
+    uint32_t pos = off % size;
+    uint32_t n = (len < size - pos) ? len : size - pos;
+
+    memcpy(&sb->ring[pos], src, n);
+    memcpy(sb->ring, (const uint8_t *) src + n, len - n);
+}
+
+
+//*****************************************************************************
+// runs of SB_RLE_MIN chars or more become SB_RLE, count, char; a 0 is
+// always a run
+static uint16_t sb_rle(const char *text, uint16_t len, uint8_t *out)
+{
+    uint16_t i = 0, n, run;
+
+    for (n = 0; i < len; i += run) {
+        for (run = 1; (i + run < len) && (run < UINT8_MAX) && (text[i + run] == text[i]); run++);
+
+        if ((run >= SB_RLE_MIN) || (text[i] == SB_RLE)) {
+            out[n++] = SB_RLE;
+            out[n++] = run;
+            out[n++] = text[i];
+        }
+        else {
+            memcpy(&out[n], &text[i], run);
+            n += run;
+        }
+    }
+
+    return n;
+}
+
+
+static uint16_t sb_unrle(const uint8_t *data, uint16_t clen, char *out, uint16_t max)
+{
+    uint16_t i, n = 0;
+    uint8_t run;
+
+    for (i = 0; i < clen; i++) {
+        if ((data[i] == SB_RLE) && (i + 2 < clen)) {
+            for (run = data[i + 1]; run && (n < max); run--) out[n++] = data[i + 2];
+            i += 2;
+        }
+        else if (n < max) {
+            out[n++] = data[i];
+        }
+    }
+
+    return n;
+}
+
+
+//*****************************************************************************
+// the line ends, the oldest ones make room for it
+static void sb_commit(shell_scrollback_t *sb)
+{
+    struct sb_hdr *hdr = sb->hdr;
+    uint64_t head = atomic_load_explicit(&hdr->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&hdr->tail, memory_order_relaxed);
+    uint64_t first = atomic_load_explicit(&hdr->first, memory_order_relaxed);
+    uint16_t clen, size;
+
+    clen = sb_rle(sb->line, sb->len, &sb->rec[SB_REC_HEAD]);
+    size = SB_REC_HEAD + clen + SB_REC_TAIL;
+
+    memcpy(&sb->rec[0], &clen, sizeof(clen));
+    memcpy(&sb->rec[2], &sb->len, sizeof(sb->len));
+    memcpy(&sb->rec[SB_REC_HEAD + clen], &clen, sizeof(clen));
+
+    if (head + size - tail > hdr->size) {
+        while (head + size - tail > hdr->size) {
+            uint16_t old;
+
+            sb_get(sb, tail, &old, sizeof(old));
+            tail += SB_REC_HEAD + old + SB_REC_TAIL;
+            first++;
+        }
+
+        /* the readers see the records go before they're written over */
+        atomic_store_explicit(&hdr->first, first, memory_order_relaxed);
+        atomic_store_explicit(&hdr->tail, tail, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+    }
+
+    sb_put(sb, head, sb->rec, size);
+
+    atomic_store_explicit(&hdr->head, head + size, memory_order_release);
+    atomic_fetch_add_explicit(&hdr->lines, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hdr->bytes, sb->len, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hdr->stored, size, memory_order_relaxed);
+
+    sb->len = 0;
+    sb->cr = false;
+}
+
+
+//*****************************************************************************
+// start of the record ending at off
+static uint64_t sb_prev(const shell_scrollback_t *sb, uint64_t off)
+{
+    uint16_t clen;
+
+    sb_get(sb, off - SB_REC_TAIL, &clen, sizeof(clen));
+
+    return off - SB_REC_TAIL - clen - SB_REC_HEAD;
+}
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+//*****************************************************************************
+// Map the scrollback of this name, go on with its lines if it exists.
+// size is the ring, 0 for SHELL_SCROLLBACK_SIZE
+shell_scrollback_t *shellScrollbackOpen(const char *name, uint32_t size)
+{
+    shell_scrollback_t *sb;
+    struct sb_hdr *hdr;
+    struct stat st;
+    bool keep;
+    void *map;
+    int fd;
+
+    if (!size) size = SHELL_SCROLLBACK_SIZE;
+    if (size < 4 * SB_REC_MAX) return NULL;
+
+    sb = (shell_scrollback_t *) calloc(1, sizeof(shell_scrollback_t));
+    if (sb == NULL) return NULL;
+
+    sb->name = strdup(name);
+    sb->map_len = SB_HDR_SIZE + size;
+
+    fd = shm_open(name, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if ((sb->name == NULL) || (fd < 0)) goto fail;
+
+    keep = !fstat(fd, &st) && ((size_t) st.st_size == sb->map_len);
+    if (!keep && (ftruncate(fd, sb->map_len) < 0)) {
+        close(fd);
+        goto fail;
+    }
+
+    map = mmap(NULL, sb->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) goto fail;
+
+    hdr = (struct sb_hdr *) map;
+    sb->hdr = hdr;
+    sb->ring = (uint8_t *) map + SB_HDR_SIZE;
+
+    /* another layout starts empty */
+    if (!keep || (hdr->magic != SB_MAGIC) || (hdr->version != SHELL_SCROLLBACK_VERSION) ||
+        (hdr->line_len != SHELL_SCROLLBACK_LINE_LEN) || (hdr->size != size)) {
+        memset(hdr, 0, SB_HDR_SIZE);
+        hdr->version = SHELL_SCROLLBACK_VERSION;
+        hdr->line_len = SHELL_SCROLLBACK_LINE_LEN;
+        hdr->size = size;
+        atomic_thread_fence(memory_order_release);
+        hdr->magic = SB_MAGIC;
+    }
+
+    return sb;
+
+fail:
+    free(sb->name);
+    free(sb);
+    return NULL;
+}
+
+
+//*****************************************************************************
+// Unmap it, unlink removes the lines for good
+void shellScrollbackClose(shell_scrollback_t *sb, bool unlink)
+{
+    if (sb == NULL) return;
+
+    munmap(sb->hdr, sb->map_len);
+    if (unlink) shm_unlink(sb->name);
+
+    free(sb->name);
+    free(sb);
+}
+
+
+//*****************************************************************************
+// Output of the session as the terminal gets it: the lines it ends go in
+// the ring, the escape sequences and what is drawn aside are left out
+void shellScrollbackWrite(shell_scrollback_t *sb, const uint8_t *data, size_t len)
+{
+    uint8_t c;
+
+    for (; len; len--) {
+        c = *data++;
+
+        if (sb->state == SB_ESC) {
+            if (c == '[') sb->state = SB_CSI;
+            else sb->state = SB_TEXT;
+
+            if (c == '7') sb->aside = true;
+            else if (c == '8') sb->aside = false;
+            continue;
+        }
+
+        if (sb->state == SB_CSI) {
+            if ((c >= 0x40) && (c <= 0x7E)) sb->state = SB_TEXT;
+            continue;
+        }
+
+        if (c == KEY_ESC) {
+            sb->state = SB_ESC;
+            continue;
+        }
+
+        if (sb->aside) continue;
+
+        switch (c) {
+            case KEY_LF:
+                sb_commit(sb);
+                break;
+            case KEY_CR:
+                sb->cr = true;
+                break;
+            case KEY_BS:
+                if (sb->len) sb->len--;
+                break;
+            default:
+                if ((c < ' ') && (c != KEY_HT)) break;
+
+                /* written over from the start of the row */
+                if (sb->cr) {
+                    sb->len = 0;
+                    sb->cr = false;
+                }
+
+                if (sb->len == sizeof(sb->line)) sb_commit(sb);
+                sb->line[sb->len++] = c;
+                break;
+        }
+    }
+}
+
+
+//*****************************************************************************
+// Line entered after the prompt, its echo isn't in the output kept
+void shellScrollbackLine(shell_scrollback_t *sb, const char *prompt, const char *line, uint16_t len)
+{
+    sb->len = 0;
+    sb->state = SB_TEXT;
+    sb->cr = false;
+
+    shellScrollbackWrite(sb, (const uint8_t *) prompt, strlen(prompt));
+    shellScrollbackWrite(sb, (const uint8_t *) line, len);
+    sb_commit(sb);
+}
+
+
+//*****************************************************************************
+// The last nlines lines, each one ended by CRLF, then the line not ended
+// yet with partial. Without buf, return the bytes needed; otherwise the
+// oldest lines which don't hold in len are left out. From the session
+// thread only.
+uint32_t shellScrollbackRead(shell_scrollback_t *sb, uint32_t nlines, bool partial, uint8_t *buf, uint32_t len)
+{
+    struct sb_hdr *hdr = sb->hdr;
+    uint64_t head = atomic_load_explicit(&hdr->head, memory_order_acquire);
+    uint64_t tail = atomic_load_explicit(&hdr->tail, memory_order_acquire);
+    uint64_t start = head;
+    uint32_t need = partial ? sb->len : 0;
+    uint32_t count, n = 0;
+    uint16_t lens[2];
+
+    for (count = 0; (count < nlines) && (start > tail); count++) {
+        start = sb_prev(sb, start);
+        sb_get(sb, start, lens, sizeof(lens));
+        need += lens[1] + 2;
+    }
+
+    if (buf == NULL) return need;
+
+    /* the oldest ones go first */
+    while (need > len) {
+        if (count) {
+            sb_get(sb, start, lens, sizeof(lens));
+            need -= lens[1] + 2;
+            start += SB_REC_HEAD + lens[0] + SB_REC_TAIL;
+            count--;
+        }
+        else {
+            need = len;
+        }
+    }
+
+    for (; count; count--) {
+        sb_get(sb, start, sb->rec, SB_REC_HEAD);
+        memcpy(lens, sb->rec, sizeof(lens));
+        sb_get(sb, start + SB_REC_HEAD, sb->rec, lens[0]);
+
+        n += sb_unrle(sb->rec, lens[0], (char *) &buf[n], lens[1]);
+        buf[n++] = KEY_CR;
+        buf[n++] = KEY_LF;
+
+        start += SB_REC_HEAD + lens[0] + SB_REC_TAIL;
+    }
+
+    if (partial) {
+        count = (sb->len < len - n) ? sb->len : len - n;
+        memcpy(&buf[n], sb->line, count);
+        n += count;
+    }
+
+    return n;
+}
+
+
+//*****************************************************************************
+// Number of the newest line before the line number before (-1 for any)
+// where text is, copied in line. -1 if none. From any process mapping it:
+// the lines written over meanwhile are left out.
+int64_t shellScrollbackSearch(shell_scrollback_t *sb, const char *text, int64_t before, char *line, size_t len)
+{
+    struct sb_hdr *hdr = sb->hdr;
+    uint64_t off = atomic_load_explicit(&hdr->head, memory_order_acquire);
+    uint64_t number = atomic_load_explicit(&hdr->lines, memory_order_acquire);
+    uint64_t start;
+    uint16_t lens[2];
+    char plain[SHELL_SCROLLBACK_LINE_LEN + 1];
+    uint16_t n;
+
+    while (off > atomic_load_explicit(&hdr->tail, memory_order_acquire)) {
+        start = sb_prev(sb, off);
+        number--;
+
+        /* torn by the writer, what is left is older */
+        if ((start >= off) || (start < atomic_load_explicit(&hdr->tail, memory_order_acquire))) break;
+
+        if ((before >= 0) && (number >= (uint64_t) before)) {
+            off = start;
+            continue;
+        }
+
+        sb_get(sb, start, lens, sizeof(lens));
+        if (lens[0] > sizeof(sb->rec) - SB_REC_HEAD) break;
+        {
+            uint8_t data[SB_REC_MAX];
+
+            sb_get(sb, start + SB_REC_HEAD, data, lens[0]);
+
+            /* written over while it was copied, the older ones too */
+            atomic_thread_fence(memory_order_acquire);
+            if (start < atomic_load_explicit(&hdr->tail, memory_order_relaxed)) break;
+
+            n = sb_unrle(data, lens[0], plain, SHELL_SCROLLBACK_LINE_LEN);
+        }
+        plain[n] = 0;
+
+        if (strstr(plain, text) != NULL) {
+            if ((line != NULL) && len) {
+                strncpy(line, plain, len - 1);
+                line[len - 1] = 0;
+            }
+            return number;
+        }
+
+        off = start;
+    }
+
+    return -1;
+}
+
+
+void shellScrollbackStats(shell_scrollback_t *sb, shell_scrollback_stats_t *stats)
+{
+    struct sb_hdr *hdr = sb->hdr;
+
+    stats->lines = atomic_load_explicit(&hdr->lines, memory_order_relaxed);
+    stats->first = atomic_load_explicit(&hdr->first, memory_order_relaxed);
+    stats->bytes = atomic_load_explicit(&hdr->bytes, memory_order_relaxed);
+    stats->stored = atomic_load_explicit(&hdr->stored, memory_order_relaxed);
+}
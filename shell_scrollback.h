@@ -0,0 +1,113 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_scrollback.h
+* @details Scrollback of a session in shared memory, for a reattach
+*
+*   The output of the session is kept as lines of text in a ring of
+*   shared memory: the escape sequences and what is drawn aside (status
+*   rows) are left out, the line entered is kept after its prompt, runs of
+*   a char are compressed. The ring outlives the connection and the
+*   process, a new one opening the same name goes on with it.
+*
+*   shellDetach() leaves the session running without connection, its
+*   output goes on in the scrollback. shellAttach() gives it a new one:
+*   the screen and the lines before it are written at once, then the
+*   prompt and the line being edited are drawn again.
+*
+*   The lines are searched in the ring as they are, no terminal is
+*   emulated: shellScrollbackSearch() from any process mapping it.
+*
+*   sb = shellScrollbackOpen("/console-ttyS0", 0);
+*   shellSetScrollback(pshell, sb);
+*   ...                                           // the connection drops
+*   shellDetach(pshell);
+*   ...                                           // a client comes back
+*   shellAttach(pshell, &shell_io_fd, &io, 100);
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 00:21:45
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_SCROLLBACK_H
+#define _SHELL_SCROLLBACK_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef SHELL_SCROLLBACK_SIZE
+#define SHELL_SCROLLBACK_SIZE           (256 * 1024)  //!< Ring of a new scrollback
+#endif
+
+#ifndef SHELL_SCROLLBACK_LINE_LEN
+#define SHELL_SCROLLBACK_LINE_LEN       512        //!< Longer lines are cut in several
+#endif
+
+#define SHELL_SCROLLBACK_VERSION        1
+
+
+typedef struct shell_scrollback shell_scrollback_t;   //!< Opaque
+
+
+/**
+ * Counters of a scrollback
+ */
+struct shell_scrollback_stats
+{
+    uint64_t            lines;                     //!< Lines ever written, the next line number
+    uint64_t            first;                     //!< Number of the oldest line kept
+    uint64_t            bytes;                     //!< Text of all the lines
+    uint64_t            stored;                    //!< The same once compressed
+};
+typedef struct shell_scrollback_stats shell_scrollback_stats_t;
+
+
+/* backend of a detached session, the input is empty and the output dropped */
+extern const shell_io_t shell_io_detached;
+
+
+shell_scrollback_t *shellScrollbackOpen(const char *name, uint32_t size);
+void shellScrollbackClose(shell_scrollback_t *sb, bool unlink);
+void shellScrollbackWrite(shell_scrollback_t *sb, const uint8_t *data, size_t len);
+void shellScrollbackLine(shell_scrollback_t *sb, const char *prompt, const char *line, uint16_t len);
+uint32_t shellScrollbackRead(shell_scrollback_t *sb, uint32_t nlines, bool partial, uint8_t *buf, uint32_t len);
+int64_t shellScrollbackSearch(shell_scrollback_t *sb, const char *text, int64_t before, char *line, size_t len);
+void shellScrollbackStats(shell_scrollback_t *sb, shell_scrollback_stats_t *stats);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_SCROLLBACK_H */
@@ -0,0 +1,719 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_server.c
+* @details Console server, one reactor thread per core
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 23:38:27
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE                                /* accept4(), thread affinity */
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+#include "shell_server.h"
+
+
+
+#define SERVER_CACHE_LINE               64         //!< The counters of two shards apart
+
+
+/**
+ * Shard Structure, its sessions are only touched by its thread
+ */
+struct shell_shard
+{
+    _Alignas(SERVER_CACHE_LINE)
+    shell_server_t      *server;
+    uint8_t             id;
+    int16_t             cpu;                       //!< Core it's pinned to, -1 for none
+    bool                running;                   //!< The thread was created
+    pthread_t           thread;
+    int                 epfd;
+    int                 wake;                      //!< eventfd, the inbox or the stop
+    _Atomic(shell_session_t *) inbox;              //!< Sessions given by the other threads
+    shell_session_t     *sessions;
+    uint32_t            count;                     //!< Lines of the current period
+    uint64_t            period_end;                //!< ms
+
+    atomic_uint         nsessions;                 //!< Owned or on the way
+    atomic_uint         rate;
+    _Atomic uint64_t    lines;
+    atomic_uint         moved_in;
+    atomic_uint         moved_out;
+};
+
+
+/**
+ * Server Structure
+ */
+struct shell_server
+{
+    shell_shard_t       shards[SHELL_SERVER_SHARDS_MAX];
+    uint8_t             nshards;
+    const shell_server_ops_t *ops;
+    void                *ctx;
+    int                 lfd;                       //!< Listening socket, -1 without
+    atomic_bool         stop;
+};
+
+
+/* Session whose line is handled by the current thread */
+static _Thread_local shell_session_t *server_current;
+
+
+
+//Declare Prototype
+static uint64_t server_now(void);
+static void server_post(shell_shard_t *shard, shell_session_t *ps);
+static shell_shard_t *server_pick(shell_server_t *srv, shell_shard_t *except, bool by_rate);
+static void server_free(shell_server_t *srv, shell_session_t *ps);
+static void server_drop(shell_shard_t *shard, shell_session_t *ps);
+static void server_give(shell_shard_t *shard, shell_session_t *ps, shell_shard_t *to);
+static void server_watch(shell_shard_t *shard, shell_session_t *ps);
+static void server_input(shell_shard_t *shard, shell_session_t *ps);
+static void server_adopt(shell_shard_t *shard);
+static void server_accept(shell_shard_t *shard);
+static void server_flush(shell_shard_t *shard);
+static void server_balance(shell_shard_t *shard);
+static void *server_thread(void *arg);
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+static uint64_t server_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+//*****************************************************************************
+// give a session to a shard from any thread, the inbox is a lock-free stack
+static void server_post(shell_shard_t *shard, shell_session_t *ps)
+{
+    shell_session_t *head = atomic_load_explicit(&shard->inbox, memory_order_relaxed);
+
+    do {
+        ps->mail = head;
+    } while (!atomic_compare_exchange_weak_explicit(&shard->inbox, &head, ps,
+                                                     memory_order_release, memory_order_relaxed));
+
+    /* only the first one needs to wake it, the counter adds up anyway */
+    if (head == NULL) eventfd_write(shard->wake, 1);
+}
+
+
+//*****************************************************************************
+// least loaded shard: the fewest sessions then the lowest rate, or the
+// opposite when the rate decides
+static shell_shard_t *server_pick(shell_server_t *srv, shell_shard_t *except, bool by_rate)
+{
+    shell_shard_t *best = NULL;
+    uint32_t best_key[2] = { 0, 0 };
+    uint32_t key[2];
+    uint8_t i;
+
+    for (i = 0; i < srv->nshards; i++) {
+        if (&srv->shards[i] == except) continue;
+
+        key[by_rate ? 1 : 0] = atomic_load_explicit(&srv->shards[i].nsessions, memory_order_relaxed);
+        key[by_rate ? 0 : 1] = atomic_load_explicit(&srv->shards[i].rate, memory_order_relaxed);
+
+        if ((best == NULL) || (key[0] < best_key[0]) ||
+            ((key[0] == best_key[0]) && (key[1] < best_key[1]))) {
+            best = &srv->shards[i];
+            best_key[0] = key[0];
+            best_key[1] = key[1];
+        }
+    }
+
+    return best;
+}
+
+
+//*****************************************************************************
+// end of a session, on the thread owning it or once they are stopped
+static void server_free(shell_server_t *srv, shell_session_t *ps)
+{
+    if (ps->shell != NULL) {
+        if (srv->ops->close != NULL) srv->ops->close(ps, srv->ctx);
+        shellClose(ps->shell);
+    }
+
+    close(ps->fd);
+    free(ps->out);
+    free(ps);
+}
+
+
+//*****************************************************************************
+static void server_drop(shell_shard_t *shard, shell_session_t *ps)
+{
+    epoll_ctl(shard->epfd, EPOLL_CTL_DEL, ps->fd, NULL);
+
+    if (ps->prev != NULL) ps->prev->next = ps->next;
+    else shard->sessions = ps->next;
+    if (ps->next != NULL) ps->next->prev = ps->prev;
+
+    atomic_fetch_sub_explicit(&shard->nsessions, 1, memory_order_relaxed);
+
+    server_free(shard->server, ps);
+}
+
+
+//*****************************************************************************
+// the session leaves the shard, its thread doesn't touch it after the post
+static void server_give(shell_shard_t *shard, shell_session_t *ps, shell_shard_t *to)
+{
+    epoll_ctl(shard->epfd, EPOLL_CTL_DEL, ps->fd, NULL);
+
+    if (ps->prev != NULL) ps->prev->next = ps->next;
+    else shard->sessions = ps->next;
+    if (ps->next != NULL) ps->next->prev = ps->prev;
+
+    atomic_fetch_sub_explicit(&shard->nsessions, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard->moved_out, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&to->nsessions, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&to->moved_in, 1, memory_order_relaxed);
+
+    ps->move = SHELL_SERVER_NO_MOVE;
+    server_post(to, ps);
+}
+
+
+//*****************************************************************************
+// the connection is watched for room while output is queued
+static void server_watch(shell_shard_t *shard, shell_session_t *ps)
+{
+    bool wait = shellOutputPending(ps->shell) != 0;
+    struct epoll_event ev;
+
+    if (wait == ps->out_wait) return;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = wait ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    ev.data.ptr = ps;
+    if (epoll_ctl(shard->epfd, EPOLL_CTL_MOD, ps->fd, &ev) == 0) ps->out_wait = wait;
+}
+
+
+//*****************************************************************************
+// run the engine up to the end of the input, each line goes to the handler.
+// Room in the output is an event too, the engine writes the queue.
+static void server_input(shell_shard_t *shard, shell_session_t *ps)
+{
+    shell_server_t *srv = shard->server;
+    uint8_t state;
+    char *line;
+
+    for (;;) {
+        state = ps->shell->state;
+        line = shellEngine(ps->shell);
+
+        if (line != NULL) {
+            ps->count++;
+            ps->lines++;
+            shard->count++;
+            atomic_fetch_add_explicit(&shard->lines, 1, memory_order_relaxed);
+
+            server_current = ps;
+            if (srv->ops->line != NULL) srv->ops->line(ps, line, srv->ctx);
+            else shellExec(ps->shell, line);
+            server_current = NULL;
+
+            /* the next shard prints the prompt */
+            if (ps->move != SHELL_SERVER_NO_MOVE) {
+                server_give(shard, ps, &srv->shards[ps->move]);
+                return;
+            }
+            continue;
+        }
+
+        if (ps->shell->eof) {
+            server_drop(shard, ps);
+            return;
+        }
+
+        /* the input is drained */
+        if ((state == SHELL_STATE_READY) || (state == SHELL_STATE_BUSY) ||
+            (state == SHELL_STATE_PAGER) || (state == SHELL_STATE_XFER)) break;
+    }
+
+    server_watch(shard, ps);
+}
+
+
+//*****************************************************************************
+// take the sessions of the inbox, a new one is started here
+static void server_adopt(shell_shard_t *shard)
+{
+    shell_server_t *srv = shard->server;
+    shell_session_t *ps, *next;
+    struct epoll_event ev;
+    eventfd_t n;
+    uint32_t len;
+
+    eventfd_read(shard->wake, &n);
+
+    ps = atomic_exchange_explicit(&shard->inbox, NULL, memory_order_acquire);
+
+    for (; ps != NULL; ps = next) {
+        next = ps->mail;
+        ps->mail = NULL;
+        ps->shard = shard;
+
+        if (ps->shell == NULL) {
+            len = srv->ops->out_len ? srv->ops->out_len : SHELL_SERVER_OUT_LEN;
+            ps->out = (uint8_t *) malloc(len);
+            ps->shell = shellOpenIo(&shell_io_fd, &ps->io, srv->ops->prompt, NULL);
+            if ((ps->shell == NULL) || (ps->out == NULL) ||
+                (shellSetOutputQueue(ps->shell, ps->out, len, srv->ops->out_policy,
+                                     srv->ops->out_timeout_ms) != SYS_EOK) ||
+                ((srv->ops->open != NULL) && (srv->ops->open(ps, srv->ctx) != SYS_EOK))) {
+                atomic_fetch_sub_explicit(&shard->nsessions, 1, memory_order_relaxed);
+                server_free(srv, ps);
+                continue;
+            }
+            shellInit(ps->shell, srv->ops->echo);
+        }
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = ps;
+        if (epoll_ctl(shard->epfd, EPOLL_CTL_ADD, ps->fd, &ev) < 0) {
+            atomic_fetch_sub_explicit(&shard->nsessions, 1, memory_order_relaxed);
+            server_free(srv, ps);
+            continue;
+        }
+
+        ps->out_wait = false;
+        ps->prev = NULL;
+        ps->next = shard->sessions;
+        if (ps->next != NULL) ps->next->prev = ps;
+        shard->sessions = ps;
+
+        /* input read before the move, or the prompt after the last line */
+        server_input(shard, ps);
+    }
+}
+
+
+//*****************************************************************************
+static void server_accept(shell_shard_t *shard)
+{
+    shell_server_t *srv = shard->server;
+    int fd;
+
+    for (;;) {
+        fd = accept4(srv->lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            /* EAGAIN, another shard took it, or out of descriptors */
+            return;
+        }
+
+        if (shellServerAdd(srv, fd) != SYS_EOK) close(fd);
+    }
+}
+
+
+//*****************************************************************************
+// each period the queued output is written again, a client stalled for the
+// timeout is disconnected there
+static void server_flush(shell_shard_t *shard)
+{
+    shell_session_t *ps, *next;
+
+    for (ps = shard->sessions; ps != NULL; ps = next) {
+        next = ps->next;
+        if (!shellOutputPending(ps->shell)) continue;
+
+        shellFlush(ps->shell);
+        if (ps->shell->eof) server_drop(shard, ps);
+        else server_watch(shard, ps);
+    }
+}
+
+
+//*****************************************************************************
+// end of a period: publish the rate, then hand one session to a lighter
+// shard, a heavy one if it halves the gap or an idle one
+static void server_balance(shell_shard_t *shard)
+{
+    shell_server_t *srv = shard->server;
+    shell_session_t *ps, *pick = NULL;
+    shell_shard_t *to;
+    uint32_t rate = shard->count;
+    uint32_t lower;
+
+    shard->count = 0;
+    atomic_store_explicit(&shard->rate, rate, memory_order_relaxed);
+
+    for (ps = shard->sessions; ps != NULL; ps = ps->next) {
+        ps->rate = ps->count;
+        ps->count = 0;
+    }
+
+    if (srv->nshards < 2) return;
+
+    to = server_pick(srv, shard, true);
+    lower = atomic_load_explicit(&to->rate, memory_order_relaxed);
+
+    if ((rate > lower) && (rate - lower > SHELL_SERVER_MOVE_RATE)) {
+        /* the heaviest which doesn't turn the gap the other way */
+        for (ps = shard->sessions; ps != NULL; ps = ps->next) {
+            if (ps->rate && (ps->rate <= (rate - lower) / 2) &&
+                ((pick == NULL) || (ps->rate > pick->rate))) pick = ps;
+        }
+    }
+
+    if (pick == NULL) {
+        to = server_pick(srv, shard, false);
+        if (atomic_load_explicit(&shard->nsessions, memory_order_relaxed) <=
+            atomic_load_explicit(&to->nsessions, memory_order_relaxed) + SHELL_SERVER_MOVE_SLACK) return;
+
+        for (ps = shard->sessions; ps != NULL; ps = ps->next) {
+            if (!ps->rate) {
+                pick = ps;
+                break;
+            }
+        }
+    }
+
+    if (pick != NULL) server_give(shard, pick, to);
+}
+
+
+//*****************************************************************************
+static void *server_thread(void *arg)
+{
+    shell_shard_t *shard = (shell_shard_t *) arg;
+    shell_server_t *srv = shard->server;
+    struct epoll_event events[SHELL_SERVER_EVENTS];
+    uint64_t now;
+    int i, n;
+
+    shard->period_end = server_now() + SHELL_SERVER_PERIOD_MS;
+
+    while (!atomic_load(&srv->stop)) {
+        now = server_now();
+        if (now >= shard->period_end) {
+            server_flush(shard);
+            server_balance(shard);
+            shard->period_end = now + SHELL_SERVER_PERIOD_MS;
+        }
+
+        n = epoll_wait(shard->epfd, events, SHELL_SERVER_EVENTS, (int) (shard->period_end - now));
+
+        for (i = 0; i < n; i++) {
+            /* a session is seen once by epoll_wait(), it's still ours here */
+            if (events[i].data.ptr == shard) server_adopt(shard);
+            else if (events[i].data.ptr == srv) server_accept(shard);
+            else server_input(shard, (shell_session_t *) events[i].data.ptr);
+        }
+    }
+
+    while (shard->sessions != NULL) server_drop(shard, shard->sessions);
+
+    return NULL;
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+//*****************************************************************************
+// Start the shards, 0 for one per core the process may run on. SIGPIPE is
+// blocked in their threads, a write to a closed connection fails with EPIPE
+// instead.
+shell_server_t *shellServerOpen(uint8_t nshards, const shell_server_ops_t *ops, void *ctx)
+{
+    shell_server_t *srv;
+    shell_shard_t *shard;
+    struct epoll_event ev;
+    pthread_attr_t attr;
+    sigset_t block, old;
+    long ncpus;
+#ifdef __linux__
+    cpu_set_t allowed, cpus;
+    bool pin;
+    int cpu = -1;
+#endif
+    uint8_t i;
+
+    if ((ops == NULL) || (ops->prompt == NULL)) return NULL;
+
+#ifdef __linux__
+    /* the cores the process may use, a cpuset or taskset gives fewer than the online ones */
+    pin = !sched_getaffinity(0, sizeof(allowed), &allowed);
+    ncpus = pin ? CPU_COUNT(&allowed) : sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (ncpus < 1) ncpus = 1;
+    if (!nshards) nshards = (ncpus > SHELL_SERVER_SHARDS_MAX) ? SHELL_SERVER_SHARDS_MAX : ncpus;
+    if (nshards > SHELL_SERVER_SHARDS_MAX) nshards = SHELL_SERVER_SHARDS_MAX;
+
+    srv = (shell_server_t *) aligned_alloc(SERVER_CACHE_LINE, sizeof(shell_server_t));
+    if (srv == NULL) return NULL;
+
+    memset(srv, 0, sizeof(shell_server_t));
+    srv->ops = ops;
+    srv->ctx = ctx;
+    srv->lfd = -1;
+    atomic_init(&srv->stop, false);
+
+    for (i = 0; i < SHELL_SERVER_SHARDS_MAX; i++) {
+        srv->shards[i].epfd = -1;
+        srv->shards[i].wake = -1;
+    }
+
+    sigemptyset(&block);
+    sigaddset(&block, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+
+    for (srv->nshards = 0; srv->nshards < nshards; srv->nshards++) {
+        shard = &srv->shards[srv->nshards];
+        shard->server = srv;
+        shard->id = srv->nshards;
+        shard->cpu = -1;
+
+        shard->epfd = epoll_create1(EPOLL_CLOEXEC);
+        shard->wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if ((shard->epfd < 0) || (shard->wake < 0)) break;
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = shard;
+        if (epoll_ctl(shard->epfd, EPOLL_CTL_ADD, shard->wake, &ev) < 0) break;
+
+        /* a shard per allowed core while there are enough of them */
+        pthread_attr_init(&attr);
+#ifdef __linux__
+        if (pin && (nshards <= ncpus)) {
+            do cpu++; while (!CPU_ISSET(cpu, &allowed));
+
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu, &cpus);
+            if (!pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus)) shard->cpu = cpu;
+        }
+#endif
+        shard->running = !pthread_create(&shard->thread, &attr, server_thread, shard);
+        pthread_attr_destroy(&attr);
+
+        /* the pin was refused, the shard runs on any core, its stats tell it */
+        if (!shard->running && (shard->cpu >= 0)) {
+            shard->cpu = -1;
+            shard->running = !pthread_create(&shard->thread, NULL, server_thread, shard);
+        }
+        if (!shard->running) break;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (srv->nshards < nshards) {
+        /* the shard being set up is cleaned up too */
+        srv->nshards++;
+        shellServerClose(srv);
+        return NULL;
+    }
+
+    return srv;
+}
+
+
+//*****************************************************************************
+// Stop the shards, the sessions are closed
+s_err_t shellServerClose(shell_server_t *srv)
+{
+    shell_session_t *ps, *next;
+    uint8_t i;
+
+    atomic_store(&srv->stop, true);
+
+    for (i = 0; i < srv->nshards; i++) {
+        if (srv->shards[i].running) eventfd_write(srv->shards[i].wake, 1);
+    }
+
+    for (i = 0; i < srv->nshards; i++) {
+        if (srv->shards[i].running) pthread_join(srv->shards[i].thread, NULL);
+    }
+
+    /* the sessions on their way to a shard */
+    for (i = 0; i < srv->nshards; i++) {
+        ps = atomic_exchange(&srv->shards[i].inbox, NULL);
+        for (; ps != NULL; ps = next) {
+            next = ps->mail;
+            server_free(srv, ps);
+        }
+
+        if (srv->shards[i].epfd >= 0) close(srv->shards[i].epfd);
+        if (srv->shards[i].wake >= 0) close(srv->shards[i].wake);
+    }
+
+    free(srv);
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// The shards accept the connections of the socket, each one is woken in
+// turn when EPOLLEXCLUSIVE is there, the first one otherwise
+s_err_t shellServerListen(shell_server_t *srv, int lfd)
+{
+    struct epoll_event ev;
+    uint8_t i;
+    int flags;
+
+    if (srv->lfd >= 0) return SYS_EBUSY;
+
+    flags = fcntl(lfd, F_GETFL);
+    if ((flags < 0) || (fcntl(lfd, F_SETFL, flags | O_NONBLOCK) < 0)) return SYS_EIO;
+
+    srv->lfd = lfd;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.data.ptr = srv;
+#ifdef EPOLLEXCLUSIVE
+    ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+    for (i = 0; i < srv->nshards; i++) {
+        if (epoll_ctl(srv->shards[i].epfd, EPOLL_CTL_ADD, lfd, &ev) < 0) return SYS_EIO;
+    }
+#else
+    (void) i;
+    ev.events = EPOLLIN;
+    if (epoll_ctl(srv->shards[0].epfd, EPOLL_CTL_ADD, lfd, &ev) < 0) return SYS_EIO;
+#endif
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Serve a connected descriptor, from any thread. It's closed with the
+// session.
+s_err_t shellServerAdd(shell_server_t *srv, int fd)
+{
+    shell_session_t *ps;
+    shell_shard_t *to;
+    int flags;
+
+    flags = fcntl(fd, F_GETFL);
+    if ((flags < 0) || (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)) return SYS_EIO;
+
+    ps = (shell_session_t *) malloc(sizeof(shell_session_t));
+    if (ps == NULL) return SYS_ENOMEM;
+
+    memset(ps, 0, sizeof(shell_session_t));
+    ps->fd = fd;
+    ps->io.in = fd;
+    ps->io.out = fd;
+    ps->move = SHELL_SERVER_NO_MOVE;
+
+    /* counted at once, a burst of connections is spread */
+    to = server_pick(srv, NULL, false);
+    atomic_fetch_add_explicit(&to->nsessions, 1, memory_order_relaxed);
+    server_post(to, ps);
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Session of the line being handled, NULL out of a line handler or a
+// command
+shell_session_t *shellServerCurrent(void)
+{
+    return server_current;
+}
+
+
+//*****************************************************************************
+// Move the session to another shard once the line handler returns, only
+// from the thread of its shard
+s_err_t shellServerMove(shell_session_t *ps, uint8_t shard)
+{
+    shell_server_t *srv;
+
+    if (ps == NULL) return SYS_ERROR;
+
+    srv = ps->shard->server;
+    if (shard >= srv->nshards) return SYS_ERROR;
+
+    ps->move = (shard == ps->shard->id) ? SHELL_SERVER_NO_MOVE : shard;
+
+    return SYS_EOK;
+}
+
+
+uint8_t shellServerShards(shell_server_t *srv)
+{
+    return srv->nshards;
+}
+
+
+uint8_t shellServerShardOf(shell_session_t *ps)
+{
+    return ps->shard->id;
+}
+
+
+void shellServerStats(shell_server_t *srv, uint8_t shard, shell_server_stats_t *stats)
+{
+    shell_shard_t *psh = &srv->shards[shard];
+
+    stats->sessions = atomic_load_explicit(&psh->nsessions, memory_order_relaxed);
+    stats->rate = atomic_load_explicit(&psh->rate, memory_order_relaxed);
+    stats->lines = atomic_load_explicit(&psh->lines, memory_order_relaxed);
+    stats->moved_in = atomic_load_explicit(&psh->moved_in, memory_order_relaxed);
+    stats->moved_out = atomic_load_explicit(&psh->moved_out, memory_order_relaxed);
+    stats->cpu = psh->cpu;
+}
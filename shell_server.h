@@ -0,0 +1,177 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_server.h
+* @details Console server, one reactor thread per core
+*
+*   The sessions are split in shards, each one owned by a thread with its
+*   own epoll set: a session is only touched by the thread of its shard,
+*   nothing is locked between the shards. A new connection goes to the
+*   shard with the fewest sessions, then the one with the lowest rate of
+*   lines. The other threads only read the counters of a shard and give
+*   it sessions through its inbox, a lock-free stack woken by an eventfd.
+*
+*   Once per period each shard compares its rate of lines with the least
+*   loaded one: it gives away a heavy session which halves the gap, or an
+*   idle session when it holds too many more of them. A command can move
+*   its own session, shellServerMove(shellServerCurrent(), shard), it goes
+*   once the command returns.
+*
+*   The output of each session goes through a bounded queue, written when
+*   the connection takes it: a client which doesn't read loses its output
+*   as ops->out_policy says, the shard is never blocked by it.
+*
+*   srv = shellServerOpen(0, &ops, ctx);      // a shard per core
+*   shellServerListen(srv, lfd);              // or shellServerAdd(srv, fd)
+*   ...
+*   shellServerClose(srv);
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 23:38:27
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_SERVER_H
+#define _SHELL_SERVER_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef SHELL_SERVER_SHARDS_MAX
+#define SHELL_SERVER_SHARDS_MAX         64         //!< Max reactor threads
+#endif
+
+#ifndef SHELL_SERVER_EVENTS
+#define SHELL_SERVER_EVENTS             64         //!< Events read by one epoll_wait()
+#endif
+
+#ifndef SHELL_SERVER_PERIOD_MS
+#define SHELL_SERVER_PERIOD_MS          1000       //!< Rate of lines measured and balanced
+#endif
+
+#ifndef SHELL_SERVER_MOVE_RATE
+#define SHELL_SERVER_MOVE_RATE          64         //!< Smaller gap of lines per period is left
+#endif
+
+#ifndef SHELL_SERVER_MOVE_SLACK
+#define SHELL_SERVER_MOVE_SLACK         2          //!< More sessions than the least loaded kept
+#endif
+
+#ifndef SHELL_SERVER_OUT_LEN
+#define SHELL_SERVER_OUT_LEN            4096       //!< Output queue of a session without ops->out_len
+#endif
+
+#define SHELL_SERVER_NO_MOVE            0xFF
+
+
+typedef struct shell_server shell_server_t;       //!< Opaque
+typedef struct shell_shard shell_shard_t;         //!< Opaque
+typedef struct shell_session shell_session_t;
+
+
+/**
+ * Session callbacks, all called on the thread of the shard
+ */
+struct shell_server_ops
+{
+    const char  *prompt;
+    bool        echo;
+    /* new session, sets the commands or the backend, != SYS_EOK closes it. Optional */
+    s_err_t     (*open)(shell_session_t *ps, void *ctx);
+    /* complete line, shellExec() without it. Optional */
+    int32_t     (*line)(shell_session_t *ps, char *line, void *ctx);
+    /* before the session is freed. Optional */
+    void        (*close)(shell_session_t *ps, void *ctx);
+    uint32_t    out_len;                           //!< Output queue of each session, 0 for the default
+    uint8_t     out_policy;                        //!< SHELL_OUT_DROP_ASYNC...
+    uint32_t    out_timeout_ms;                    //!< With SHELL_OUT_DISCONNECT, checked each period
+};
+typedef struct shell_server_ops shell_server_ops_t;
+
+
+/**
+ * Session Structure, owned by one shard at a time
+ */
+struct shell_session
+{
+    shellObject_t       *shell;                    //!< NULL until its shard starts it
+    int                 fd;
+    shell_io_fd_t       io;
+    uint8_t             *out;                      //!< Output queue
+    bool                out_wait;                  //!< Waits the connection to take more
+    void                *user;                     //!< Free for the callbacks
+
+    shell_shard_t       *shard;
+    uint8_t             move;                      //!< Shard asked, or SHELL_SERVER_NO_MOVE
+    uint32_t            count;                     //!< Lines of the current period
+    uint32_t            rate;                      //!< Lines of the last period
+    uint64_t            lines;
+
+    shell_session_t     *prev;                     //!< Sessions of the shard
+    shell_session_t     *next;
+    shell_session_t     *mail;                     //!< Inbox of the next shard
+};
+
+
+/**
+ * Counters of a shard, read from any thread
+ */
+struct shell_server_stats
+{
+    uint32_t            sessions;
+    uint32_t            rate;                      //!< Lines of the last period
+    uint64_t            lines;
+    uint32_t            moved_in;
+    uint32_t            moved_out;
+    int16_t             cpu;                       //!< Core the shard is pinned to, -1 when it wasn't
+};
+typedef struct shell_server_stats shell_server_stats_t;
+
+
+
+shell_server_t *shellServerOpen(uint8_t nshards, const shell_server_ops_t *ops, void *ctx);
+s_err_t shellServerClose(shell_server_t *srv);
+s_err_t shellServerListen(shell_server_t *srv, int lfd);
+s_err_t shellServerAdd(shell_server_t *srv, int fd);
+shell_session_t *shellServerCurrent(void);
+s_err_t shellServerMove(shell_session_t *ps, uint8_t shard);
+uint8_t shellServerShards(shell_server_t *srv);
+uint8_t shellServerShardOf(shell_session_t *ps);
+void shellServerStats(shell_server_t *srv, uint8_t shard, shell_server_stats_t *stats);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_SERVER_H */
@@ -0,0 +1,399 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_status.c
+* @details Status line pinned on the top or the bottom of the screen
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 21:04:37
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <stdatomic.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "shell_status.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+
+
+
+
+#ifndef SHELL_STATUS_CLOCK
+#if defined(CLOCK_MONOTONIC)
+#define SHELL_STATUS_CLOCK()            shell_status_clock()
+#else
+#define SHELL_STATUS_CLOCK()            0          //!< Define it with the timer of the target, in ms
+#endif
+#endif
+
+#define STATUS_RETRY                    4          //!< Reads of a field being written, then it waits the next draw
+
+/* DECSC/DECRC, unlike CSI s/u they keep the attributes and the pending wrap */
+#define STATUS_SAVE                     "\0337"
+#define STATUS_RESTORE                  "\0338"
+
+
+
+//Declare Prototype
+#if defined(CLOCK_MONOTONIC)
+static inline uint64_t shell_status_clock(void);
+#endif
+static inline shell_status_t *status_of(shellObject_t *pshell);
+static bool status_read(struct shell_status_field *field, char *text);
+static uint16_t status_row(shellObject_t *pshell, const shell_status_t *status, uint8_t row);
+static void status_draw(shellObject_t *pshell, const shell_status_t *status, const struct shell_status_field *field, const char *text);
+
+
+
+
+
+
+//Private Function
+#if defined(CLOCK_MONOTONIC)
+//*****************************************************************************
+static inline uint64_t shell_status_clock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+#endif
+
+
+//*****************************************************************************
+// NULL without status rows or when they are built out
+static inline shell_status_t *status_of(shellObject_t *pshell)
+{
+#if SHELL_CFG_STATUS
+    return pshell->status;
+#else
+    (void) pshell;
+
+    return NULL;
+#endif
+}
+
+
+//*****************************************************************************
+// copy of the text, false if the writer was in the middle of it
+static bool status_read(struct shell_status_field *field, char *text)
+{
+    uint32_t seq = atomic_load_explicit(&field->seq, memory_order_acquire);
+
+    if (seq & 1) return false;
+
+    memcpy(text, field->text, SHELL_STATUS_FIELD_LEN);
+    atomic_thread_fence(memory_order_acquire);
+
+    return atomic_load_explicit(&field->seq, memory_order_relaxed) == seq;
+}
+
+
+//*****************************************************************************
+// screen row of a status row
+static uint16_t status_row(shellObject_t *pshell, const shell_status_t *status, uint8_t row)
+{
+    if (status->top) return row + 1;
+
+    return pshell->vt->nrows - status->rows + row + 1;
+}
+
+
+//*****************************************************************************
+// the text is padded with blanks to the width and clipped to the screen
+static void status_draw(shellObject_t *pshell, const shell_status_t *status, const struct shell_status_field *field, const char *text)
+{
+    uint16_t ncols = pshell->vt->ncols;
+    uint16_t width = field->width;
+    size_t len = strlen(text);
+
+    if (field->col > ncols) return;
+    if (width > ncols - field->col + 1) width = ncols - field->col + 1;
+    if (len > width) len = width;
+
+    shellPuts(pshell, vtSetCursor(pshell->vt, status_row(pshell, status, field->row), field->col));
+    shellWrite(pshell, text, len);
+    while (len++ < width) shellPutc(' ', pshell);
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+//*****************************************************************************
+// Reserve rows for the status, the screen is cleared and the output
+// scrolls in the other rows from now
+s_err_t shellStatusOpen(shellObject_t *pshell, shell_status_t *status, uint8_t rows, bool top)
+{
+#if SHELL_CFG_STATUS
+    uint8_t i;
+
+    if ((status == NULL) || !rows || (rows >= pshell->vt->nrows)) return SYS_ERROR;
+
+    memset(status, 0, sizeof(shell_status_t));
+    atomic_init(&status->dirty, 0);
+    for (i = 0; i < SHELL_STATUS_FIELDS; i++) atomic_init(&status->field[i].seq, 0);
+
+    status->rows = rows;
+    status->top = top;
+    pshell->status = status;
+
+    pshell->hold++;
+    shellStatusScreen(pshell, true);
+    shellRedraw(pshell);
+    if (!--pshell->hold) shellFlush(pshell);
+
+    return SYS_EOK;
+#else
+    (void) pshell;
+    (void) status;
+    (void) rows;
+    (void) top;
+
+    return SYS_ENOSYS;
+#endif
+}
+
+
+//*****************************************************************************
+// Give the whole screen back to the output, the status rows are erased
+void shellStatusClose(shellObject_t *pshell)
+{
+    shell_status_t *status = status_of(pshell);
+    uint8_t i;
+
+    if (status == NULL) return;
+
+    if (pshell->echo && !pshell->machine) {
+        pshell->hold++;
+        shellPuts(pshell, STATUS_SAVE);
+        shellPuts(pshell, vtSetScrollRegion(pshell->vt, 1, pshell->vt->nrows));
+        for (i = 0; i < status->rows; i++) {
+            shellPuts(pshell, vtSetCursor(pshell->vt, status_row(pshell, status, i), 1));
+            shellPuts(pshell, vtEraseLine(pshell->vt, VT_ERASE_LINE_ALL));
+        }
+        shellPuts(pshell, STATUS_RESTORE);
+        if (!--pshell->hold) shellFlush(pshell);
+    }
+
+#if SHELL_CFG_STATUS
+    pshell->status = NULL;
+#endif
+}
+
+
+//*****************************************************************************
+// Place a field, the row is counted from the first status row
+s_err_t shellStatusField(shellObject_t *pshell, uint8_t idx, uint8_t row, uint16_t col, uint16_t width)
+{
+    shell_status_t *status = status_of(pshell);
+    struct shell_status_field *field;
+
+    if (status == NULL) return SYS_ENOSYS;
+    if ((idx >= SHELL_STATUS_FIELDS) || (row >= status->rows) || !col) return SYS_ERROR;
+
+    field = &status->field[idx];
+    field->row = row;
+    field->col = col;
+    field->width = width;
+    field->shown[0] = '\0';
+
+    atomic_fetch_or_explicit(&status->dirty, 1U << idx, memory_order_release);
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Set the text of a field, callable from any thread but one writer per
+// field. Nothing is written here: the sets between two draws only leave
+// their last text.
+void shellStatusSet(shellObject_t *pshell, uint8_t idx, const char *text)
+{
+    shell_status_t *status = status_of(pshell);
+    struct shell_status_field *field;
+    uint32_t seq;
+
+    if ((status == NULL) || (idx >= SHELL_STATUS_FIELDS)) return;
+
+    field = &status->field[idx];
+    seq = atomic_load_explicit(&field->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&field->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    strncpy(field->text, text, SHELL_STATUS_FIELD_LEN - 1);
+    field->text[SHELL_STATUS_FIELD_LEN - 1] = '\0';
+
+    atomic_store_explicit(&field->seq, seq + 2, memory_order_release);
+    atomic_fetch_or_explicit(&status->dirty, 1U << idx, memory_order_release);
+}
+
+
+void shellStatusPrintf(shellObject_t *pshell, uint8_t idx, const char *fmt, ...)
+{
+    char text[SHELL_STATUS_FIELD_LEN];
+    va_list args;
+
+    va_start(args, fmt);
+    shellVsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    shellStatusSet(pshell, idx, text);
+}
+
+
+//*****************************************************************************
+// Draw the fields changed since the last draw, at most once per period
+// unless forced. Called by the session thread, shellEngine() calls it on
+// each pass and an idle application calls it from its timer.
+void shellStatusPoll(shellObject_t *pshell, bool force)
+{
+    shell_status_t *status = status_of(pshell);
+    char text[SHELL_STATUS_FIELD_LEN];
+    bool drawn = false;
+    uint32_t dirty;
+    uint64_t now;
+    uint8_t i;
+
+    /* nothing goes in the middle of a transfer */
+    if ((status == NULL) || !pshell->echo || pshell->machine || (pshell->state == SHELL_STATE_XFER)) return;
+
+    now = SHELL_STATUS_CLOCK();
+
+    if (!force) {
+        if (!atomic_load_explicit(&status->dirty, memory_order_relaxed)) return;
+        if (now - status->last_ms < SHELL_STATUS_PERIOD_MS) return;
+    }
+
+    dirty = atomic_exchange_explicit(&status->dirty, 0, memory_order_acquire);
+    status->last_ms = now;
+
+    for (i = 0; i < SHELL_STATUS_FIELDS; i++) {
+        struct shell_status_field *field = &status->field[i];
+        uint8_t retry = STATUS_RETRY;
+
+        if (!field->width) continue;
+        if (!force && !(dirty & (1U << i))) continue;
+
+        while (!status_read(field, text) && --retry) {}
+        if (!retry) {
+            atomic_fetch_or_explicit(&status->dirty, 1U << i, memory_order_relaxed);
+            continue;
+        }
+
+        /* set again to the same text */
+        if (!force && !strcmp(text, field->shown)) continue;
+
+        if (!drawn) {
+            pshell->hold++;
+            shellPuts(pshell, STATUS_SAVE);
+            shellPrintf(pshell, "\033[%cm", SHELL_STATUS_ATTR);
+            drawn = true;
+        }
+
+        status_draw(pshell, status, field, text);
+        memcpy(field->shown, text, sizeof(field->shown));
+    }
+
+    if (drawn) {
+        shellPuts(pshell, STATUS_RESTORE);
+        if (!--pshell->hold) shellFlush(pshell);
+    }
+}
+
+
+//*****************************************************************************
+// Set the scroll region again and draw all the status rows, after a
+// resize or a clear. With home the screen is cleared and the cursor goes
+// on the first row of the region, else it stays where it is.
+void shellStatusScreen(shellObject_t *pshell, bool home)
+{
+    shell_status_t *status = status_of(pshell);
+    uint16_t nrows = pshell->vt->nrows;
+    uint16_t first, last;
+    uint8_t i;
+
+    /* nothing goes in the middle of a transfer */
+    if ((status == NULL) || !pshell->echo || pshell->machine || (pshell->state == SHELL_STATE_XFER)) return;
+
+    /* too small a screen, the status rows wait a bigger one */
+    if (status->rows >= nrows) return;
+
+    first = status->top ? status->rows + 1 : 1;
+    last = status->top ? nrows : nrows - status->rows;
+
+    pshell->hold++;
+
+    if (home) {
+        shellPuts(pshell, vtSetCursor(pshell->vt, 1, 1));
+        shellPuts(pshell, vtEraseScreen(pshell->vt, VT_ERASE_SCREEN_ALL));
+    }
+    else {
+        shellPuts(pshell, STATUS_SAVE);
+    }
+
+    /* the region moves the cursor home */
+    shellPuts(pshell, vtSetScrollRegion(pshell->vt, first, last));
+
+    if (home) shellPuts(pshell, vtSetCursor(pshell->vt, first, 1));
+    else shellPuts(pshell, STATUS_RESTORE);
+
+    shellPuts(pshell, STATUS_SAVE);
+    shellPrintf(pshell, "\033[%cm", SHELL_STATUS_ATTR);
+    for (i = 0; i < status->rows; i++) {
+        shellPuts(pshell, vtSetCursor(pshell->vt, status_row(pshell, status, i), 1));
+        shellPuts(pshell, vtEraseLine(pshell->vt, VT_ERASE_LINE_ALL));
+    }
+    shellPuts(pshell, STATUS_RESTORE);
+
+    shellStatusPoll(pshell, true);
+
+    if (!--pshell->hold) shellFlush(pshell);
+}
+
+
+//*****************************************************************************
+// Rows left to the output and the prompt
+uint16_t shellStatusRows(shellObject_t *pshell)
+{
+    shell_status_t *status = status_of(pshell);
+    uint16_t nrows = pshell->vt->nrows;
+
+    if ((status == NULL) || (status->rows >= nrows)) return nrows;
+
+    return nrows - status->rows;
+}
@@ -0,0 +1,121 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_status.h
+* @details Status line pinned on the top or the bottom of the screen
+*
+*   Built with SHELL_CFG_STATUS set, shellStatusOpen() reserves rows of
+*   the screen with a scroll region: the output and the prompt scroll in
+*   the other rows. The rows hold fields (clock, link state, alarm
+*   count...) set by the application as often as it likes, from any
+*   thread, with shellStatusSet(). The session draws them from its own
+*   thread, shellEngine() or shellStatusPoll(), at most once per
+*   SHELL_STATUS_PERIOD_MS: only the fields whose text changed are drawn,
+*   between a save and a restore of the cursor, so the line being edited
+*   is left as it is.
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 21:04:37
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_STATUS_H
+#define _SHELL_STATUS_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef SHELL_STATUS_FIELDS
+#define SHELL_STATUS_FIELDS             8          //!< Fields of the status rows, 32 at most
+#endif
+
+#ifndef SHELL_STATUS_FIELD_LEN
+#define SHELL_STATUS_FIELD_LEN          32         //!< Text of a field + null terminator
+#endif
+
+#ifndef SHELL_STATUS_PERIOD_MS
+#define SHELL_STATUS_PERIOD_MS          100        //!< Shortest time between two draws
+#endif
+
+#ifndef SHELL_STATUS_ATTR
+#define SHELL_STATUS_ATTR               VT_MODE_ATTR_REVERSED  //!< Attribute of the status rows
+#endif
+
+#if (SHELL_STATUS_FIELDS > 32)
+#error "SHELL_STATUS_FIELDS must be 32 at most"
+#endif
+
+
+/**
+ * Status field
+ */
+struct shell_status_field
+{
+    shell_atomic_u32_t  seq;                       //!< Odd while the text is written
+    uint8_t             row;                       //!< Row in the status rows, from 0
+    uint16_t            col;                       //!< First column, from 1
+    uint16_t            width;                     //!< Columns, 0 for an unused field
+    char                text[SHELL_STATUS_FIELD_LEN];  //!< Set by the application
+    char                shown[SHELL_STATUS_FIELD_LEN]; //!< Last drawn, session only
+};
+
+/**
+ * Status rows, given by the application to shellStatusOpen()
+ */
+struct shell_status
+{
+    uint8_t             rows;                      //!< Reserved rows
+    bool                top;                       //!< On the top of the screen, else the bottom
+    shell_atomic_u32_t  dirty;                     //!< One bit per field set since the last draw
+    uint64_t            last_ms;                   //!< Time of the last draw
+    struct shell_status_field field[SHELL_STATUS_FIELDS];
+};
+typedef struct shell_status shell_status_t;
+
+
+
+s_err_t shellStatusOpen(shellObject_t *pshell, shell_status_t *status, uint8_t rows, bool top);
+void shellStatusClose(shellObject_t *pshell);
+s_err_t shellStatusField(shellObject_t *pshell, uint8_t idx, uint8_t row, uint16_t col, uint16_t width);
+void shellStatusSet(shellObject_t *pshell, uint8_t idx, const char *text);
+void shellStatusPrintf(shellObject_t *pshell, uint8_t idx, const char *fmt, ...) SHELL_FMT_CHECK(3, 4);
+void shellStatusPoll(shellObject_t *pshell, bool force);
+void shellStatusScreen(shellObject_t *pshell, bool home);
+uint16_t shellStatusRows(shellObject_t *pshell);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_STATUS_H */
@@ -0,0 +1,237 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_trace.c
+* @details Event trace of the shell terminal
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 19:12:50
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "shell_trace.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+
+
+
+
+#ifndef SHELL_TRACE_CLOCK
+#if defined(CLOCK_MONOTONIC)
+#define SHELL_TRACE_CLOCK()             shell_trace_clock()
+#else
+#define SHELL_TRACE_CLOCK()             0          //!< Define it with the timer of the target
+#endif
+#endif
+
+#if (SHELL_TRACE_LEN & (SHELL_TRACE_LEN - 1))
+#error "SHELL_TRACE_LEN must be a power of 2"
+#endif
+
+
+/**
+ * Trace ring, written by the session and its jobs without lock
+ */
+struct shell_trace
+{
+    atomic_uint_fast32_t head;                     //!< Next position, never wrapped
+    shell_trace_rec_t   rec[SHELL_TRACE_LEN];
+};
+
+
+
+//Declare Prototype
+#if defined(CLOCK_MONOTONIC)
+static inline uint64_t shell_trace_clock(void);
+#endif
+
+
+
+
+
+
+//Private Function
+#if defined(CLOCK_MONOTONIC)
+//*****************************************************************************
+static inline uint64_t shell_trace_clock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+//*****************************************************************************
+// One record, a slot is taken with a single atomic add
+void shellTraceRecord(shell_trace_t *ptrace, uint8_t event, uint8_t kind, uint32_t arg)
+{
+    uint32_t pos = atomic_fetch_add_explicit(&ptrace->head, 1, memory_order_relaxed);
+    shell_trace_rec_t *rec = &ptrace->rec[pos & (SHELL_TRACE_LEN - 1)];
+
+    rec->ts = SHELL_TRACE_CLOCK();
+    rec->arg = arg;
+    rec->event = event;
+    rec->kind = kind;
+    rec->seq = pos;
+}
+
+
+//*****************************************************************************
+// The ring is allocated the first time, it's kept when the trace stops
+s_err_t shellTraceEnable(shellObject_t *pshell, bool on)
+{
+#if SHELL_CFG_TRACE
+    if (on && (pshell->trace == NULL)) {
+        pshell->trace = (shell_trace_t *) calloc(1, sizeof(shell_trace_t));
+        if (pshell->trace == NULL) return SYS_ENOMEM;
+    }
+
+    pshell->trace_on = on;
+
+    return SYS_EOK;
+#else
+    (void) pshell;
+    (void) on;
+
+    return SYS_ENOSYS;
+#endif
+}
+
+
+void shellTraceClear(shellObject_t *pshell)
+{
+#if SHELL_CFG_TRACE
+    if (pshell->trace != NULL) atomic_store(&pshell->trace->head, 0);
+#else
+    (void) pshell;
+#endif
+}
+
+
+//*****************************************************************************
+// Write the ring oldest first, records being written meanwhile can be torn
+s_err_t shellTraceDump(shellObject_t *pshell, const char *path)
+{
+#if SHELL_CFG_TRACE
+    shell_trace_file_t hdr;
+    uint32_t head, first, pos;
+    FILE *file;
+
+    if (pshell->trace == NULL) return SYS_ERROR;
+
+    head = atomic_load(&pshell->trace->head);
+    first = (head > SHELL_TRACE_LEN) ? (head - SHELL_TRACE_LEN) : 0;
+
+    hdr.magic = SHELL_TRACE_MAGIC;
+    hdr.version = SHELL_TRACE_VERSION;
+    hdr.rec_size = sizeof(shell_trace_rec_t);
+    hdr.count = head - first;
+    hdr.lost = first;
+
+    file = fopen(path, "wb");
+    if (file == NULL) return SYS_EIO;
+
+    fwrite(&hdr, sizeof(hdr), 1, file);
+
+    /* up to the end of the buffer then from the start */
+    pos = first & (SHELL_TRACE_LEN - 1);
+    if (pos + hdr.count > SHELL_TRACE_LEN) {
+        fwrite(&pshell->trace->rec[pos], sizeof(shell_trace_rec_t), SHELL_TRACE_LEN - pos, file);
+        fwrite(pshell->trace->rec, sizeof(shell_trace_rec_t), pos + hdr.count - SHELL_TRACE_LEN, file);
+    }
+    else {
+        fwrite(&pshell->trace->rec[pos], sizeof(shell_trace_rec_t), hdr.count, file);
+    }
+
+    if (fclose(file)) return SYS_EIO;
+
+    return SYS_EOK;
+#else
+    (void) pshell;
+    (void) path;
+
+    return SYS_ENOSYS;
+#endif
+}
+
+
+void shellTraceClose(shellObject_t *pshell)
+{
+#if SHELL_CFG_TRACE
+    pshell->trace_on = false;
+    free(pshell->trace);
+    pshell->trace = NULL;
+#else
+    (void) pshell;
+#endif
+}
+
+
+//*****************************************************************************
+// Command handler for the table: trace on|off|clear|dump <file>
+int32_t shellTraceCmd(shellObject_t *pshell, int32_t argc, char *argv[])
+{
+    s_err_t err;
+
+    if ((argc == 2) && !strcmp(argv[1], "on")) {
+        err = shellTraceEnable(pshell, true);
+    }
+    else if ((argc == 2) && !strcmp(argv[1], "off")) {
+        err = shellTraceEnable(pshell, false);
+    }
+    else if ((argc == 2) && !strcmp(argv[1], "clear")) {
+        shellTraceClear(pshell);
+        err = SYS_EOK;
+    }
+    else if ((argc == 3) && !strcmp(argv[1], "dump")) {
+        err = shellTraceDump(pshell, argv[2]);
+    }
+    else {
+        shellPrintf(pshell, "usage: %s on|off|clear|dump <file>\r\n", argv[0]);
+        return SYS_ERROR;
+    }
+
+    if (err == SYS_ENOSYS) shellPrintf(pshell, "%s: built without SHELL_CFG_TRACE\r\n", argv[0]);
+    else if (err != SYS_EOK) shellPrintf(pshell, "%s: failed (%d)\r\n", argv[0], err);
+
+    return err;
+}
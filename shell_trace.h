@@ -0,0 +1,134 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_trace.h
+* @details Event trace of the shell terminal
+*
+*   Built with SHELL_CFG_TRACE set, the session records its phases (read,
+*   keys, redraws, history, commands, output flush) as 16 bytes timestamped
+*   records in a ring. Without it the tracepoints are empty. The ring is
+*   written to a file by shellTraceDump() and read back by
+*   tools/shell_trace_dump.
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 19:12:50
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_TRACE_H
+#define _SHELL_TRACE_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef SHELL_TRACE_LEN
+#define SHELL_TRACE_LEN                 4096       //!< Records of the ring, a power of 2
+#endif
+
+#define SHELL_TRACE_MAGIC               0x52544853 //!< "SHTR" little endian
+#define SHELL_TRACE_VERSION             1
+
+
+/**
+ * Events
+ */
+#define SHELL_TRACE_READ                1          //!< shell_read(), arg: line length at the end
+#define SHELL_TRACE_KEY                 2          //!< Key out of vtProcessChar(), arg: key
+#define SHELL_TRACE_REDRAW              3          //!< Line drawn again, arg: line length
+#define SHELL_TRACE_REFLOW              4          //!< Line reflowed, arg: new columns
+#define SHELL_TRACE_HISTORY             5          //!< Recall or push, arg: history index
+#define SHELL_TRACE_EXEC                6          //!< Command dispatch, arg: status at the end
+#define SHELL_TRACE_FLUSH               7          //!< Output to the backend, arg: bytes
+
+#define SHELL_TRACE_BEGIN_KIND          0
+#define SHELL_TRACE_END_KIND            1
+#define SHELL_TRACE_MARK_KIND           2
+
+
+/**
+ * Trace record
+ */
+struct shell_trace_rec
+{
+    uint64_t            ts;                        //!< Monotonic time in ns
+    uint32_t            arg;
+    uint8_t             event;
+    uint8_t             kind;                      //!< Begin, end or mark
+    uint16_t            seq;                       //!< Low bits of the ring position
+};
+typedef struct shell_trace_rec shell_trace_rec_t;
+
+/**
+ * Header of a dump file, followed by count records, oldest first
+ */
+struct shell_trace_file
+{
+    uint32_t            magic;
+    uint16_t            version;
+    uint16_t            rec_size;
+    uint32_t            count;
+    uint32_t            lost;                      //!< Overwritten before the dump
+};
+typedef struct shell_trace_file shell_trace_file_t;
+
+typedef struct shell_trace shell_trace_t;          //!< Ring, opaque
+
+
+#if SHELL_CFG_TRACE
+#define SHELL_TRACE(pshell, ev, kind, arg)                                        \
+    do {                                                                         \
+        if ((pshell)->trace_on) shellTraceRecord((pshell)->trace, (ev), (kind), (arg)); \
+    } while (0)
+#else
+#define SHELL_TRACE(pshell, ev, kind, arg)  do { } while (0)
+#endif
+
+#define SHELL_TRACE_BEGIN(pshell, ev, arg)  SHELL_TRACE(pshell, ev, SHELL_TRACE_BEGIN_KIND, arg)
+#define SHELL_TRACE_END(pshell, ev, arg)    SHELL_TRACE(pshell, ev, SHELL_TRACE_END_KIND, arg)
+#define SHELL_TRACE_MARK(pshell, ev, arg)   SHELL_TRACE(pshell, ev, SHELL_TRACE_MARK_KIND, arg)
+
+
+
+void shellTraceRecord(shell_trace_t *ptrace, uint8_t event, uint8_t kind, uint32_t arg);
+s_err_t shellTraceEnable(shellObject_t *pshell, bool on);
+void shellTraceClear(shellObject_t *pshell);
+s_err_t shellTraceDump(shellObject_t *pshell, const char *path);
+void shellTraceClose(shellObject_t *pshell);
+int32_t shellTraceCmd(shellObject_t *pshell, int32_t argc, char *argv[]);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_TRACE_H */
@@ -0,0 +1,370 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_vars.c
+* @details Variables of the shell and their expansion in the lines
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 01:12:08
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <string.h>
+
+#include "shell_vars.h"
+
+
+
+
+
+#define VARS_FNV_BASIS                  2166136261u
+#define VARS_FNV_PRIME                  16777619u
+
+
+
+//Declare Prototype
+static inline shell_vars_t *vars_of(shellObject_t *pshell);
+static inline bool vars_name_char(char c, bool first);
+static inline uint32_t vars_hash(uint32_t hash, char c);
+static struct shell_var *vars_find(shell_vars_t *vars, const char *name, size_t len, uint32_t hash);
+static inline char *vars_value(shell_vars_t *vars, const struct shell_var *var);
+static void vars_compact(shell_vars_t *vars, const char **keep);
+
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+static inline shell_vars_t *vars_of(shellObject_t *pshell)
+{
+#if SHELL_CFG_VARS
+    return pshell->vars;
+#else
+    (void) pshell;
+
+    return NULL;
+#endif
+}
+
+
+//*****************************************************************************
+// [A-Za-z_][A-Za-z0-9_]*
+static inline bool vars_name_char(char c, bool first)
+{
+    if (((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || (c == '_')) return true;
+
+    return !first && (c >= '0') && (c <= '9');
+}
+
+
+//*****************************************************************************
+// FNV-1a, a char at a time while the name is read
+static inline uint32_t vars_hash(uint32_t hash, char c)
+{
+    return (hash ^ (uint8_t) c) * VARS_FNV_PRIME;
+}
+
+
+//*****************************************************************************
+// slot of the name, or the free slot where it goes. The table is never
+// more than half full, the probe ends.
+static struct shell_var *vars_find(shell_vars_t *vars, const char *name, size_t len, uint32_t hash)
+{
+    uint32_t i = hash & (SHELL_VARS_SLOTS - 1);
+    struct shell_var *var;
+
+    for (;; i = (i + 1) & (SHELL_VARS_SLOTS - 1)) {
+        var = &vars->slot[i];
+
+        if (!var->name_len) return var;
+        if ((var->hash == hash) && (var->name_len == len) && !memcmp(&vars->arena[var->off], name, len)) return var;
+    }
+}
+
+
+static inline char *vars_value(shell_vars_t *vars, const struct shell_var *var)
+{
+    return &vars->arena[var->off + var->name_len + 1];
+}
+
+
+//*****************************************************************************
+// move the blocks down over the ones left, keep follows the block it
+// points in
+static void vars_compact(shell_vars_t *vars, const char **keep)
+{
+    uint16_t order[SHELL_VARS_MAX];
+    struct shell_var *var;
+    uint16_t count = 0, used = 0, size, i, j;
+    uintptr_t at = (uintptr_t) *keep;
+
+    /* by offset, then each block goes down without overwriting the next */
+    for (i = 0; i < SHELL_VARS_SLOTS; i++) {
+        if (!vars->slot[i].name_len) continue;
+
+        for (j = count++; j && (vars->slot[order[j - 1]].off > vars->slot[i].off); j--) order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    for (i = 0; i < count; i++) {
+        var = &vars->slot[order[i]];
+        size = var->name_len + 1 + var->len + 1;
+
+        if ((at >= (uintptr_t) &vars->arena[var->off]) && (at < (uintptr_t) &vars->arena[var->off + var->room])) {
+            *keep -= var->off - used;
+        }
+
+        memmove(&vars->arena[used], &vars->arena[var->off], size);
+        var->off = used;
+        var->room = size;
+        used += size;
+    }
+
+    vars->used = used;
+}
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+//*****************************************************************************
+// Give the variables to the session, they're all cleared
+s_err_t shellVarsOpen(shellObject_t *pshell, shell_vars_t *vars)
+{
+#if SHELL_CFG_VARS
+    if (vars == NULL) return SYS_ERROR;
+
+    memset(vars, 0, sizeof(shell_vars_t));
+    pshell->vars = vars;
+
+    return SYS_EOK;
+#else
+    (void) pshell;
+    (void) vars;
+
+    return SYS_ENOSYS;
+#endif
+}
+
+
+void shellVarsClose(shellObject_t *pshell)
+{
+#if SHELL_CFG_VARS
+    pshell->vars = NULL;
+#else
+    (void) pshell;
+#endif
+}
+
+
+//*****************************************************************************
+// Set a variable, NULL value to unset it. The name is kept for good, the
+// value is copied.
+s_err_t shellVarsSet(shellObject_t *pshell, const char *name, const char *value)
+{
+    shell_vars_t *vars = vars_of(pshell);
+    struct shell_var *var;
+    uint32_t hash = VARS_FNV_BASIS;
+    size_t len, vlen, need;
+    char *dst;
+
+    if (vars == NULL) return SYS_ENOSYS;
+
+    for (len = 0; name[len]; len++) {
+        if (!vars_name_char(name[len], !len)) return SYS_ERROR;
+        hash = vars_hash(hash, name[len]);
+    }
+    if (!len || (len >= SHELL_VARS_NAME_LEN)) return SYS_ERROR;
+
+    var = vars_find(vars, name, len, hash);
+    vlen = (value != NULL) ? strlen(value) : 0;
+    need = len + 1 + vlen + 1;
+
+    if (!var->name_len) {
+        if (value == NULL) return SYS_EOK;
+        if (vars->count == SHELL_VARS_MAX) return SYS_EFULL;
+    }
+    else {
+        /* the name is taken from its block, it can move */
+        name = NULL;
+    }
+
+    if (need > var->room) {
+        if (need > sizeof(vars->arena) - vars->used) vars_compact(vars, &value);
+        if (need > sizeof(vars->arena) - vars->used) return SYS_ENOMEM;
+
+        dst = &vars->arena[vars->used];
+        memcpy(dst, (name != NULL) ? name : &vars->arena[var->off], len + 1);
+
+        if (!var->name_len) {
+            var->hash = hash;
+            var->name_len = len;
+            vars->count++;
+        }
+
+        var->off = vars->used;
+        var->room = need;
+        vars->used += need;
+    }
+
+    dst = vars_value(vars, var);
+    if (vlen) memmove(dst, value, vlen);
+    dst[vlen] = 0;
+    var->len = vlen;
+    var->set = (value != NULL);
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Value of a variable, NULL if it's not set. It's valid until the next
+// shellVarsSet()
+const char *shellVarsGet(shellObject_t *pshell, const char *name)
+{
+    shell_vars_t *vars = vars_of(pshell);
+    const struct shell_var *var;
+    uint32_t hash = VARS_FNV_BASIS;
+    size_t len;
+
+    if (vars == NULL) return NULL;
+
+    for (len = 0; name[len]; len++) hash = vars_hash(hash, name[len]);
+    if (!len || (len >= SHELL_VARS_NAME_LEN)) return NULL;
+
+    var = vars_find(vars, name, len, hash);
+
+    return var->set ? vars_value(vars, var) : NULL;
+}
+
+
+//*****************************************************************************
+// Copy the line with the variables replaced by their value, return its
+// length, or -1 if it doesn't hold in size. Without variables the line is
+// copied as it is.
+int32_t shellVarsExpand(shellObject_t *pshell, const char *line, char *out, size_t size)
+{
+    shell_vars_t *vars = vars_of(pshell);
+    const struct shell_var *var;
+    const char *name;
+    uint32_t hash;
+    size_t n = 0, len;
+    bool brace;
+
+    while (*line) {
+        if ((vars != NULL) && (line[0] == '$')) {
+            brace = (line[1] == '{');
+            name = &line[1 + brace];
+
+            for (len = 0, hash = VARS_FNV_BASIS; vars_name_char(name[len], !len); len++) {
+                hash = vars_hash(hash, name[len]);
+            }
+
+            /* not a name, the '$' is kept */
+            if (len && (!brace || (name[len] == '}'))) {
+                var = (len < SHELL_VARS_NAME_LEN) ? vars_find(vars, name, len, hash) : NULL;
+
+                if ((var != NULL) && var->set) {
+                    if (n + var->len >= size) return -1;
+                    memcpy(&out[n], vars_value(vars, var), var->len);
+                    n += var->len;
+                }
+
+                line = &name[len + brace];
+                continue;
+            }
+        }
+        else if ((vars != NULL) && (line[0] == '\\') && (line[1] == '$')) {
+            line++;
+        }
+
+        if (n + 1 >= size) return -1;
+        out[n++] = *line++;
+    }
+
+    if (n >= size) return -1;
+    out[n] = 0;
+
+    return n;
+}
+
+
+//*****************************************************************************
+// Built-in "set": the list without argument, "set NAME" unsets it,
+// "set NAME value..." sets it, the words joined by a blank
+int32_t shellVarsCmd(shellObject_t *pshell, int32_t argc, char *argv[])
+{
+    shell_vars_t *vars = vars_of(pshell);
+    const struct shell_var *var;
+    char value[SHELL_VARS_LINE_LEN];
+    size_t n = 0, len;
+    s_err_t err;
+    int32_t i;
+
+    if (vars == NULL) {
+        shellPrintf(pshell, "%s: no variables\r\n", argv[0]);
+        return SYS_ENOSYS;
+    }
+
+    if (argc < 2) {
+        for (i = 0; i < SHELL_VARS_SLOTS; i++) {
+            var = &vars->slot[i];
+            if (var->set) shellPrintf(pshell, "%s=%s\r\n", &vars->arena[var->off], vars_value(vars, var));
+        }
+        return SYS_EOK;
+    }
+
+    for (i = 2; i < argc; i++) {
+        len = strlen(argv[i]);
+        if (n + len + 1 > sizeof(value)) break;
+
+        memcpy(&value[n], argv[i], len);
+        n += len;
+        value[n++] = ' ';
+    }
+    if (n) value[n - 1] = 0;
+
+    err = shellVarsSet(pshell, argv[1], (argc > 2) ? value : NULL);
+
+    switch (err) {
+        case SYS_EOK:
+            break;
+        case SYS_EFULL:
+            shellPrintf(pshell, "%s: too many variables\r\n", argv[0]);
+            break;
+        case SYS_ENOMEM:
+            shellPrintf(pshell, "%s: no room for the value\r\n", argv[0]);
+            break;
+        default:
+            shellPrintf(pshell, "%s: %s: bad name\r\n", argv[0], argv[1]);
+            break;
+    }
+
+    return err;
+}
@@ -0,0 +1,134 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_vars.h
+* @details Variables of the shell and their expansion in the lines
+*
+*   "set NAME value" sets a variable, "$NAME" or "${NAME}" in a line is
+*   replaced by its value before the command is found, "\$" is a '$'. A
+*   variable not set is empty.
+*
+*   The names are interned once in an arena with their value, an open
+*   addressed table of their hash finds them: no allocation, one probe
+*   most of the time. The expansion is one pass over the line, the hash
+*   of a name is computed while it's read. A value which no longer holds
+*   in its place moves to the end of the arena, which is compacted when
+*   it's full.
+*
+*   static shell_vars_t vars;
+*   shellVarsOpen(pshell, &vars);
+*   shellVarsSet(pshell, "dev", "0x48");
+*   shellExecBatch(pshell, "i2c read $dev 0\n"
+*                          "i2c write ${dev} 1 0xFF\n");
+*
+*   A table can be given to several sessions of the same thread only.
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 01:12:08
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_VARS_H
+#define _SHELL_VARS_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef SHELL_VARS_MAX
+#define SHELL_VARS_MAX                  32         //!< Names interned, a power of 2
+#endif
+
+#ifndef SHELL_VARS_ARENA
+#define SHELL_VARS_ARENA                1024       //!< Bytes of the names and the values
+#endif
+
+#ifndef SHELL_VARS_NAME_LEN
+#define SHELL_VARS_NAME_LEN             32         //!< Name + null terminator
+#endif
+
+#ifndef SHELL_VARS_LINE_LEN
+#define SHELL_VARS_LINE_LEN             (2 * SHELL_BUFFER_LINE_LEN)    //!< Line once expanded
+#endif
+
+#define SHELL_VARS_SLOTS                (2 * SHELL_VARS_MAX)   //!< Half used at most
+
+#if (SHELL_VARS_MAX & (SHELL_VARS_MAX - 1))
+#error "SHELL_VARS_MAX must be a power of 2"
+#endif
+
+#if (SHELL_VARS_ARENA > 0xFFFF)
+#error "SHELL_VARS_ARENA must be 65535 at most"
+#endif
+
+
+/**
+ * Interned name, its block in the arena is the name then the value, each
+ * one null terminated
+ */
+struct shell_var
+{
+    uint32_t            hash;
+    uint16_t            off;                       //!< Block in the arena
+    uint16_t            room;                      //!< Bytes of the block
+    uint16_t            len;                       //!< Of the value
+    uint8_t             name_len;                  //!< 0 for a free slot
+    bool                set;
+};
+
+/**
+ * Variables, given by the application to shellVarsOpen()
+ */
+struct shell_vars
+{
+    uint16_t            count;                     //!< Names interned
+    uint16_t            used;                      //!< Bytes of the arena
+    struct shell_var    slot[SHELL_VARS_SLOTS];
+    char                arena[SHELL_VARS_ARENA];
+};
+typedef struct shell_vars shell_vars_t;
+
+
+
+s_err_t shellVarsOpen(shellObject_t *pshell, shell_vars_t *vars);
+void shellVarsClose(shellObject_t *pshell);
+s_err_t shellVarsSet(shellObject_t *pshell, const char *name, const char *value);
+const char *shellVarsGet(shellObject_t *pshell, const char *name);
+int32_t shellVarsExpand(shellObject_t *pshell, const char *line, char *out, size_t size);
+int32_t shellVarsCmd(shellObject_t *pshell, int32_t argc, char *argv[]);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_VARS_H */
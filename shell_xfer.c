@@ -0,0 +1,293 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_xfer.c
+* @details Binary transfer through the console
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 21:52:06
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+
+#include "shell_xfer.h"
+
+
+
+#define XFER_WAIT                       0          //!< Waits SOH, EOT or CAN
+#define XFER_HEAD                       1          //!< seq and len
+#define XFER_BODY                       2          //!< payload and crc
+
+#define XFER_HEAD_LEN                   3
+
+
+
+//Declare Prototype
+static void xfer_answer(shellObject_t *pshell, uint8_t byte);
+static void xfer_end(shellObject_t *pshell, shell_xfer_t *xfer, s_err_t status);
+static void xfer_frame(shellObject_t *pshell, shell_xfer_t *xfer);
+static void xfer_read_raw(shellObject_t *pshell, void *ctx);
+static void xfer_read_framed(shellObject_t *pshell, void *ctx);
+
+
+/* CRC-16/XMODEM, a nibble at a time */
+static const uint16_t xfer_crc_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+
+
+
+//Private Function
+//*****************************************************************************
+// one byte to the sender, without waiting the end of the engine pass
+static void xfer_answer(shellObject_t *pshell, uint8_t byte)
+{
+    shellPutc(byte, pshell);
+    shellFlush(pshell);
+}
+
+
+//*****************************************************************************
+// last call of the handler, the line editor gets the input back
+static void xfer_end(shellObject_t *pshell, shell_xfer_t *xfer, s_err_t status)
+{
+    xfer->status = status;
+    shellSetRaw(pshell, NULL, NULL);
+
+    xfer->func(pshell, xfer->ctx, NULL, status);
+}
+
+
+//*****************************************************************************
+// a whole frame is in the buffer
+static void xfer_frame(shellObject_t *pshell, shell_xfer_t *xfer)
+{
+    uint16_t crc = shellXferCrc(0, xfer->buf, XFER_HEAD_LEN + xfer->len);
+    uint8_t *tail = &xfer->buf[XFER_HEAD_LEN + xfer->len];
+    uint8_t seq = xfer->buf[0];
+
+    xfer->step = XFER_WAIT;
+
+    if (crc != ((tail[0] << 8) | tail[1])) {
+        xfer->naks++;
+        if (++xfer->bad >= SHELL_XFER_RETRY) {
+            xfer_answer(pshell, SHELL_XFER_CAN);
+            xfer_end(pshell, xfer, SYS_EIO);
+            return;
+        }
+        xfer_answer(pshell, SHELL_XFER_NAK);
+        return;
+    }
+
+    xfer->bad = 0;
+
+    /* our ACK was lost, the frame is already given */
+    if (seq == (uint8_t) (xfer->seq - 1)) {
+        xfer_answer(pshell, SHELL_XFER_ACK);
+        return;
+    }
+
+    if (seq != xfer->seq) {
+        xfer_answer(pshell, SHELL_XFER_CAN);
+        xfer_end(pshell, xfer, SYS_ERROR);
+        return;
+    }
+
+    if (xfer->len && (xfer->func(pshell, xfer->ctx, &xfer->buf[XFER_HEAD_LEN], xfer->len) < 0)) {
+        xfer_answer(pshell, SHELL_XFER_CAN);
+        xfer_end(pshell, xfer, SYS_ERROR);
+        return;
+    }
+
+    xfer->count += xfer->len;
+    xfer->seq++;
+    xfer_answer(pshell, SHELL_XFER_ACK);
+}
+
+
+//*****************************************************************************
+// raw mode, the bytes go to the handler as they are read
+static void xfer_read_raw(shellObject_t *pshell, void *ctx)
+{
+    shell_xfer_t *xfer = (shell_xfer_t *) ctx;
+    uint32_t want;
+    int32_t n;
+
+    while (xfer->left) {
+        want = (xfer->left < sizeof(xfer->buf)) ? xfer->left : sizeof(xfer->buf);
+
+        n = shellRead(pshell, xfer->buf, want);
+        if (n < 0) {
+            xfer_end(pshell, xfer, SYS_EIO);
+            return;
+        }
+        if (!n) return;
+
+        xfer->left -= n;
+
+        /* once aborted the rest is read and dropped, it isn't typed in */
+        if (xfer->status != SYS_EOK) continue;
+
+        if (xfer->func(pshell, xfer->ctx, xfer->buf, n) < 0) xfer->status = SYS_ERROR;
+        else xfer->count += n;
+    }
+
+    xfer_end(pshell, xfer, xfer->status);
+}
+
+
+//*****************************************************************************
+// framed mode, a frame is read in at most three reads once in the buffer
+static void xfer_read_framed(shellObject_t *pshell, void *ctx)
+{
+    shell_xfer_t *xfer = (shell_xfer_t *) ctx;
+    uint8_t byte;
+    int32_t n;
+
+    for (;;) {
+        switch (xfer->step) {
+            case XFER_WAIT:
+                n = shellRead(pshell, &byte, 1);
+                if (n <= 0) break;
+
+                if (byte == SHELL_XFER_SOH) {
+                    xfer->step = XFER_HEAD;
+                    xfer->pos = 0;
+                }
+                else if (byte == SHELL_XFER_EOT) {
+                    xfer_answer(pshell, SHELL_XFER_ACK);
+                    xfer_end(pshell, xfer, SYS_EOK);
+                    return;
+                }
+                else if (byte == SHELL_XFER_CAN) {
+                    xfer_end(pshell, xfer, SYS_EINT);
+                    return;
+                }
+                /* else noise between the frames */
+                continue;
+            case XFER_HEAD:
+                n = shellRead(pshell, &xfer->buf[xfer->pos], XFER_HEAD_LEN - xfer->pos);
+                if (n <= 0) break;
+
+                xfer->pos += n;
+                if (xfer->pos < XFER_HEAD_LEN) continue;
+
+                xfer->len = xfer->buf[1] | (xfer->buf[2] << 8);
+                if (xfer->len > SHELL_XFER_FRAME_LEN) {
+                    /* a broken length, the payload is skipped as noise */
+                    xfer->step = XFER_WAIT;
+                    xfer->naks++;
+                    xfer_answer(pshell, SHELL_XFER_NAK);
+                    continue;
+                }
+                xfer->step = XFER_BODY;
+                continue;
+            default:
+                n = shellRead(pshell, &xfer->buf[xfer->pos], XFER_HEAD_LEN + xfer->len + 2 - xfer->pos);
+                if (n <= 0) break;
+
+                xfer->pos += n;
+                if (xfer->pos == XFER_HEAD_LEN + xfer->len + 2) {
+                    xfer_frame(pshell, xfer);
+                    if (pshell->state != SHELL_STATE_XFER) return;
+                }
+                continue;
+        }
+
+        /* nothing more to read now, or the input is closed */
+        if (n < 0) xfer_end(pshell, xfer, SYS_EIO);
+        return;
+    }
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+//*****************************************************************************
+// Enter the transfer state from a command, size is the byte count of a
+// raw transfer. The input is read by shellEngine() once the command
+// returned.
+s_err_t shellXferStart(shellObject_t *pshell, shell_xfer_t *xfer, uint8_t mode, uint32_t size,
+                       shell_xfer_func_t func, void *ctx)
+{
+    s_err_t err;
+
+    if ((xfer == NULL) || (func == NULL) || (mode > SHELL_XFER_FRAMED)) return SYS_ERROR;
+
+    /* the answers would break the records */
+    if ((mode == SHELL_XFER_FRAMED) && pshell->machine) return SYS_ENOSYS;
+
+    memset(xfer, 0, sizeof(shell_xfer_t));
+    xfer->func = func;
+    xfer->ctx = ctx;
+    xfer->mode = mode;
+    xfer->left = size;
+    xfer->status = SYS_EOK;
+
+    err = shellSetRaw(pshell, (mode == SHELL_XFER_RAW) ? xfer_read_raw : xfer_read_framed, xfer);
+    if (err != SYS_EOK) return err;
+
+    if (mode == SHELL_XFER_FRAMED) xfer_answer(pshell, SHELL_XFER_READY);
+
+    return SYS_EOK;
+}
+
+
+//*****************************************************************************
+// Give up the transfer, on a timeout of the application
+void shellXferAbort(shellObject_t *pshell)
+{
+    shell_xfer_t *xfer;
+
+    if ((pshell->state != SHELL_STATE_XFER) ||
+        ((pshell->raw != xfer_read_raw) && (pshell->raw != xfer_read_framed))) return;
+
+    xfer = (shell_xfer_t *) pshell->raw_ctx;
+
+    if (xfer->mode == SHELL_XFER_FRAMED) xfer_answer(pshell, SHELL_XFER_CAN);
+    xfer_end(pshell, xfer, SYS_ETIMEOUT);
+}
+
+
+//*****************************************************************************
+// CRC-16/XMODEM, start with 0
+uint16_t shellXferCrc(uint16_t crc, const uint8_t *data, uint32_t len)
+{
+    while (len--) {
+        crc = (crc << 4) ^ xfer_crc_table[(crc >> 12) ^ (*data >> 4)];
+        crc = (crc << 4) ^ xfer_crc_table[(crc >> 12) ^ (*data & 0x0F)];
+        data++;
+    }
+
+    return crc;
+}
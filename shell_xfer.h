@@ -0,0 +1,129 @@
+/*****************************************************************//**
+* @file
+* @brief H File shell_xfer.h
+* @details Binary transfer through the console
+*
+*   A command enters the transfer state with shellXferStart(): the line
+*   editor and the VT parser stop and the input goes to the handler in
+*   chunks as big as the reads, up to SHELL_XFER_FRAME_LEN. Once the
+*   transfer ends the handler is called with NULL data and the prompt
+*   comes again.
+*
+*   Raw mode: the next size bytes are given as they come, nothing is
+*   answered. The link must not lose nor change a byte.
+*
+*   Framed mode: the shell sends 'C' and waits frames, each one answered
+*   by ACK, or NAK to have it sent again:
+*
+*       SOH seq len_lo len_hi payload[len] crc_hi crc_lo
+*
+*   seq starts at 0 and counts the frames, a frame sent again after a lost
+*   ACK is answered without being given twice. The CRC is the CRC-16/XMODEM
+*   of seq, len and payload. EOT ends the transfer, answered by ACK. CAN
+*   from the sender aborts it, CAN from the shell means it gave up.
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 21:52:06
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _SHELL_XFER_H
+#define _SHELL_XFER_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef SHELL_XFER_FRAME_LEN
+#define SHELL_XFER_FRAME_LEN            1024       //!< Largest payload of a frame, and raw chunk
+#endif
+
+#ifndef SHELL_XFER_RETRY
+#define SHELL_XFER_RETRY                10         //!< Bad frames in a row before giving up
+#endif
+
+#define SHELL_XFER_RAW                  0
+#define SHELL_XFER_FRAMED               1
+
+#define SHELL_XFER_SOH                  0x01       //!< Start of a frame
+#define SHELL_XFER_EOT                  0x04       //!< End of the transfer
+#define SHELL_XFER_ACK                  0x06
+#define SHELL_XFER_NAK                  0x15
+#define SHELL_XFER_CAN                  0x18       //!< Abort
+#define SHELL_XFER_READY                'C'        //!< Sent by the shell, the frames can come
+
+#if (SHELL_XFER_FRAME_LEN > 0xFFFF)
+#error "SHELL_XFER_FRAME_LEN must hold in 16 bits"
+#endif
+
+
+/**
+ * Transfer handler, returns < 0 to abort. It's called once more at the
+ * end with NULL data and len set to SYS_EOK or the error.
+ */
+typedef int32_t (*shell_xfer_func_t)(shellObject_t *pshell, void *ctx, const uint8_t *data, uint32_t len);
+
+/**
+ * Transfer, given by the command to shellXferStart() and kept until the end
+ */
+struct shell_xfer
+{
+    shell_xfer_func_t   func;
+    void                *ctx;
+    uint8_t             mode;
+    uint8_t             step;                      //!< Part of the frame being read
+    uint8_t             seq;                       //!< Next frame expected
+    uint8_t             bad;                       //!< Bad frames in a row
+    uint16_t            len;                       //!< Payload of the frame
+    uint16_t            pos;                       //!< Bytes of the frame read
+    uint32_t            left;                      //!< Raw bytes to come
+    uint32_t            count;                     //!< Bytes given to the handler
+    uint32_t            naks;                      //!< Frames asked again
+    s_err_t             status;
+    uint8_t             buf[SHELL_XFER_FRAME_LEN + 5]; //!< seq, len, payload, crc
+};
+typedef struct shell_xfer shell_xfer_t;
+
+
+
+s_err_t shellXferStart(shellObject_t *pshell, shell_xfer_t *xfer, uint8_t mode, uint32_t size,
+                       shell_xfer_func_t func, void *ctx);
+void shellXferAbort(shellObject_t *pshell);
+uint16_t shellXferCrc(uint16_t crc, const uint8_t *data, uint32_t len);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_XFER_H */
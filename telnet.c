@@ -0,0 +1,324 @@
+/***************************************************************************//**
+* @file
+* @brief C File telnet.c
+* @details Telnet layer of the shell terminal
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 17:04:38
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <string.h>
+
+#include "telnet.h"
+
+
+
+
+
+#define TELNET_ST_DATA                  0
+#define TELNET_ST_CR                    1          //!< CR read, NUL or LF may follow
+#define TELNET_ST_IAC                   2
+#define TELNET_ST_OPT                   3          //!< Option of a WILL, WONT, DO or DONT
+#define TELNET_ST_SB                    4
+#define TELNET_ST_SB_IAC                5
+
+#define TELNET_BIT(opt)                 (((opt) < 32) ? (1UL << (opt)) : 0)
+
+#define TELNET_LOCAL_OPTS               (TELNET_BIT(TELNET_OPT_ECHO) | TELNET_BIT(TELNET_OPT_SGA))
+#define TELNET_REMOTE_OPTS              (TELNET_BIT(TELNET_OPT_SGA) | TELNET_BIT(TELNET_OPT_NAWS))
+
+
+
+//Declare Prototype
+static void telnet_send(telnet_t *ptn, uint8_t verb, uint8_t opt);
+static void telnet_option(telnet_t *ptn, uint8_t verb, uint8_t opt);
+static void telnet_subneg(telnet_t *ptn);
+static int32_t telnet_read(void *ctx, uint8_t *buf, size_t len);
+static int32_t telnet_write(void *ctx, const uint8_t *buf, size_t len);
+static int32_t telnet_winsize(void *ctx, uint16_t *nrows, uint16_t *ncols);
+
+
+
+const shell_io_t shell_io_telnet = {
+    telnet_read,
+    telnet_write,
+    telnet_winsize,
+};
+
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+static void telnet_send(telnet_t *ptn, uint8_t verb, uint8_t opt)
+{
+    uint8_t cmd[3] = { TELNET_IAC, verb, opt };
+
+    ptn->io->write(ptn->io_ctx, cmd, sizeof(cmd));
+}
+
+
+//*****************************************************************************
+// Answer a WILL, WONT, DO or DONT, a reply to our own request isn't answered
+static void telnet_option(telnet_t *ptn, uint8_t verb, uint8_t opt)
+{
+    bool local = (verb == TELNET_DO) || (verb == TELNET_DONT);
+    bool enable = (verb == TELNET_DO) || (verb == TELNET_WILL);
+    uint32_t *on = local ? &ptn->local : &ptn->remote;
+    uint32_t *asked = local ? &ptn->local_asked : &ptn->remote_asked;
+    uint32_t supported = local ? TELNET_LOCAL_OPTS : TELNET_REMOTE_OPTS;
+    uint32_t bit = TELNET_BIT(opt);
+
+    if (*asked & bit) {
+        *asked &= ~bit;
+        if (enable) *on |= bit;
+        else *on &= ~bit;
+        return;
+    }
+
+    if (enable) {
+        if (!(bit & supported)) {
+            telnet_send(ptn, local ? TELNET_WONT : TELNET_DONT, opt);
+        }
+        else if (!(*on & bit)) {
+            *on |= bit;
+            telnet_send(ptn, local ? TELNET_WILL : TELNET_DO, opt);
+        }
+    }
+    else if (*on & bit) {
+        *on &= ~bit;
+        telnet_send(ptn, local ? TELNET_WONT : TELNET_DONT, opt);
+    }
+}
+
+
+//*****************************************************************************
+// Window size, width then height on 16 bits
+static void telnet_subneg(telnet_t *ptn)
+{
+    uint16_t nrows, ncols;
+
+    if ((ptn->sb_len < 5) || (ptn->sb[0] != TELNET_OPT_NAWS)) return;
+
+    ncols = (ptn->sb[1] << 8) | ptn->sb[2];
+    nrows = (ptn->sb[3] << 8) | ptn->sb[4];
+    if (!nrows || !ncols) return;
+
+    ptn->nrows = nrows;
+    ptn->ncols = ncols;
+
+    if (ptn->shell != NULL) shellSetSize(ptn->shell, nrows, ncols);
+}
+
+
+//*****************************************************************************
+// Read from the connection and strip the commands in place
+static int32_t telnet_read(void *ctx, uint8_t *buf, size_t len)
+{
+    telnet_t *ptn = (telnet_t *) ctx;
+    int32_t n, i, out;
+    uint8_t ch;
+
+    do {
+        n = ptn->io->read(ptn->io_ctx, buf, len);
+        if (n <= 0) return n;
+
+        out = 0;
+        for (i = 0; i < n; i++) {
+            ch = buf[i];
+
+            switch (ptn->state) {
+                case TELNET_ST_CR:
+                    /* CR NUL and CR LF are both the end of line of the terminal */
+                    ptn->state = TELNET_ST_DATA;
+                    if ((ch == KEY_NUL) || (ch == KEY_LF)) {
+                        buf[out++] = KEY_LF;
+                        break;
+                    }
+                    /* fall through */
+                case TELNET_ST_DATA:
+                    if (ch == TELNET_IAC) {
+                        ptn->state = TELNET_ST_IAC;
+                    }
+                    else {
+                        if (ch == KEY_CR) ptn->state = TELNET_ST_CR;
+                        buf[out++] = ch;
+                    }
+                    break;
+                case TELNET_ST_IAC:
+                    ptn->state = TELNET_ST_DATA;
+
+                    switch (ch) {
+                        case TELNET_IAC:
+                            buf[out++] = ch;
+                            break;
+                        case TELNET_WILL:
+                        case TELNET_WONT:
+                        case TELNET_DO:
+                        case TELNET_DONT:
+                            ptn->verb = ch;
+                            ptn->state = TELNET_ST_OPT;
+                            break;
+                        case TELNET_SB:
+                            ptn->sb_len = 0;
+                            ptn->state = TELNET_ST_SB;
+                            break;
+                        case TELNET_IP:
+                            buf[out++] = KEY_ETX;
+                            break;
+                        default:
+                            /* NOP, GA, AYT... */
+                            break;
+                    }
+                    break;
+                case TELNET_ST_OPT:
+                    telnet_option(ptn, ptn->verb, ch);
+                    ptn->state = TELNET_ST_DATA;
+                    break;
+                case TELNET_ST_SB:
+                    if (ch == TELNET_IAC) ptn->state = TELNET_ST_SB_IAC;
+                    else if (ptn->sb_len < TELNET_SB_LEN) ptn->sb[ptn->sb_len++] = ch;
+                    break;
+                case TELNET_ST_SB_IAC:
+                    if (ch == TELNET_IAC) {
+                        if (ptn->sb_len < TELNET_SB_LEN) ptn->sb[ptn->sb_len++] = ch;
+                        ptn->state = TELNET_ST_SB;
+                    }
+                    else {
+                        if (ch == TELNET_SE) telnet_subneg(ptn);
+                        ptn->state = TELNET_ST_DATA;
+                    }
+                    break;
+                default:
+                    ptn->state = TELNET_ST_DATA;
+            }
+        }
+    } while (!out);
+
+    return out;
+}
+
+
+//*****************************************************************************
+// Write the data with 0xFF doubled, a block is written at once up to each 0xFF
+static int32_t telnet_write(void *ctx, const uint8_t *buf, size_t len)
+{
+    static const uint8_t iac = TELNET_IAC;
+    telnet_t *ptn = (telnet_t *) ctx;
+    const uint8_t *next;
+    size_t done = 0;
+    size_t chunk;
+    int32_t n;
+
+    if (ptn->iac_pending) {
+        n = ptn->io->write(ptn->io_ctx, &iac, 1);
+        if (n <= 0) return n;
+        ptn->iac_pending = false;
+    }
+
+    while (done < len) {
+        next = (const uint8_t *) memchr(&buf[done], TELNET_IAC, len - done);
+        chunk = (next == NULL) ? (len - done) : (size_t) (next - &buf[done]) + 1;
+
+        n = ptn->io->write(ptn->io_ctx, &buf[done], chunk);
+        if (n < 0) return done ? (int32_t) done : n;
+
+        done += n;
+        if ((size_t) n < chunk) break;
+
+        if (next != NULL) {
+            /* the 0xFF is taken, its escape is written on the next call if needed */
+            if (ptn->io->write(ptn->io_ctx, &iac, 1) <= 0) {
+                ptn->iac_pending = true;
+                break;
+            }
+        }
+    }
+
+    return done;
+}
+
+
+static int32_t telnet_winsize(void *ctx, uint16_t *nrows, uint16_t *ncols)
+{
+    telnet_t *ptn = (telnet_t *) ctx;
+
+    if (!ptn->nrows) return -1;
+
+    *nrows = ptn->nrows;
+    *ncols = ptn->ncols;
+
+    return 0;
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+void telnetInit(telnet_t *ptn, const shell_io_t *io, void *ctx)
+{
+    memset(ptn, 0, sizeof(*ptn));
+
+    ptn->io = io;
+    ptn->io_ctx = ctx;
+    ptn->state = TELNET_ST_DATA;
+}
+
+
+//*****************************************************************************
+// Session resized by the NAWS updates
+void telnetAttach(telnet_t *ptn, shellObject_t *pshell)
+{
+    ptn->shell = pshell;
+
+    if ((pshell != NULL) && ptn->nrows) shellSetSize(pshell, ptn->nrows, ptn->ncols);
+}
+
+
+//*****************************************************************************
+// Ask for character at a time mode, the echo by the server and the window size
+s_err_t telnetNegotiate(telnet_t *ptn)
+{
+    static const uint8_t opts[] = {
+        TELNET_IAC, TELNET_WILL, TELNET_OPT_ECHO,
+        TELNET_IAC, TELNET_WILL, TELNET_OPT_SGA,
+        TELNET_IAC, TELNET_DO, TELNET_OPT_SGA,
+        TELNET_IAC, TELNET_DO, TELNET_OPT_NAWS,
+    };
+
+    ptn->local_asked |= TELNET_LOCAL_OPTS;
+    ptn->remote_asked |= TELNET_REMOTE_OPTS;
+
+    if (ptn->io->write(ptn->io_ctx, opts, sizeof(opts)) != sizeof(opts)) return SYS_EIO;
+
+    return SYS_EOK;
+}
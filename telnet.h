@@ -0,0 +1,119 @@
+/*****************************************************************//**
+* @file
+* @brief H File telnet.h
+* @details Telnet layer of the shell terminal
+*
+*   Put in front of another backend, it strips and answers the telnet
+*   commands before the VT parser sees them. The client is asked for
+*   character at a time mode with the echo done by the shell (WILL ECHO,
+*   WILL SGA) and for its window size (DO NAWS).
+*
+*   telnet_t tn;
+*   shell_io_fd_t fd = { sock, sock };
+*
+*   telnetInit(&tn, &shell_io_fd, &fd);
+*   pshell = shellOpenIo(&shell_io_telnet, &tn, "> ", NULL);
+*   telnetAttach(&tn, pshell);
+*   telnetNegotiate(&tn);
+*   shellInit(pshell, true);
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 17:04:38
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _TELNET_H
+#define _TELNET_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "shell.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define TELNET_IAC                      255        //!< Interpret as command
+#define TELNET_DONT                     254
+#define TELNET_DO                       253
+#define TELNET_WONT                     252
+#define TELNET_WILL                     251
+#define TELNET_SB                       250        //!< Sub negotiation begin
+#define TELNET_IP                       244        //!< Interrupt process
+#define TELNET_SE                       240        //!< Sub negotiation end
+
+#define TELNET_OPT_ECHO                 1
+#define TELNET_OPT_SGA                  3          //!< Suppress go ahead
+#define TELNET_OPT_NAWS                 31         //!< Window size
+
+#ifndef TELNET_SB_LEN
+#define TELNET_SB_LEN                   8          //!< Longest sub negotiation kept
+#endif
+
+
+/**
+ * Telnet Structure
+ */
+struct telnet
+{
+    const shell_io_t    *io;                       //!< Backend of the connection
+    void                *io_ctx;
+    shellObject_t       *shell;                    //!< Session resized by NAWS, can be NULL
+
+    uint8_t             state;                     //!< Parser state
+    uint8_t             verb;                      //!< WILL, WONT, DO or DONT being read
+    uint8_t             sb[TELNET_SB_LEN];         //!< Sub negotiation data
+    uint8_t             sb_len;
+    bool                iac_pending;               //!< Escaped 0xFF not written yet
+
+    uint32_t            local;                     //!< Options enabled on our side
+    uint32_t            local_asked;               //!< WILL sent, answer awaited
+    uint32_t            remote;                    //!< Options enabled on the client
+    uint32_t            remote_asked;              //!< DO sent, answer awaited
+
+    uint16_t            nrows;                     //!< Last NAWS size, 0 if none
+    uint16_t            ncols;
+};
+typedef struct telnet telnet_t;
+
+
+
+extern const shell_io_t shell_io_telnet;
+
+
+void telnetInit(telnet_t *ptn, const shell_io_t *io, void *ctx);
+void telnetAttach(telnet_t *ptn, shellObject_t *pshell);
+s_err_t telnetNegotiate(telnet_t *ptn);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TELNET_H */
@@ -0,0 +1,262 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_fmt_bench.c
+* @details Time of the built-in formatter against vsnprintf()
+*
+*   shell_fmt_bench [-n calls]
+*
+*   Lines of the kind a console prints (a status, registers, routes,
+*   counters, a hex dump, a float) are formatted by snprintf() and by
+*   shellSnprintf() into a buffer, then written to a session by
+*   vsnprintf() and shellWrite(), as shellPrintf() used to, and by
+*   shellPrintf(). The backend of the session only keeps a hash of the
+*   bytes. Each line reports the ns per call and checks that both give
+*   the same bytes.
+*
+*   Exit status: 0 passed, 1 the outputs differ.
+*
+*   cc -O2 -I.. -o shell_fmt_bench shell_fmt_bench.c ../shell.c ../shell_fmt.c ../shell_io.c ../vt100.c
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 02:58:09
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "shell.h"
+#include "shell_fmt.h"
+
+
+
+
+
+#define BENCH_LINE_LEN                  256
+#define BENCH_FNV_BASIS                 2166136261u
+#define BENCH_FNV_PRIME                 16777619u
+
+
+typedef int (*bench_snprintf_t)(char *buf, size_t size, const char *fmt, ...);
+typedef void (*bench_printf_t)(shellObject_t *pshell, const char *fmt, ...);
+
+/**
+ * Line printed by a case, with the formatter given
+ */
+struct bench_case
+{
+    const char          *name;
+    int                 (*line)(bench_snprintf_t f, char *buf, size_t size);
+    void                (*print)(bench_printf_t f, shellObject_t *pshell);
+};
+
+
+/* read at each call, the compiler can't fold the formats */
+static volatile int bench_status = -5;
+static volatile unsigned bench_reg = 0x40020014u;
+static volatile unsigned bench_count = 1234;
+static volatile unsigned long long bench_rx = 98765432101ULL;
+static volatile unsigned char bench_bytes[8] = { 0xde, 0xad, 0xbe, 0xef, 0x00, 0x11, 0x7f, 0x80 };
+static volatile double bench_temp = 36.625;
+static const char *volatile bench_name = "gpio";
+static const char *volatile bench_text = "link up, 1000 Mb/s full duplex, flow control rx/tx";
+
+static uint32_t bench_hash = BENCH_FNV_BASIS;
+
+
+
+#define BENCH_CASE(id, ...) \
+static int id##_line(bench_snprintf_t f, char *buf, size_t size) { return f(buf, size, __VA_ARGS__); } \
+static void id##_print(bench_printf_t f, shellObject_t *pshell) { f(pshell, __VA_ARGS__); }
+
+BENCH_CASE(status, "%s: %d\r\n", bench_name, bench_status)
+BENCH_CASE(reg, "%-12s 0x%08x %5u\r\n", bench_name, bench_reg, bench_count)
+BENCH_CASE(route, "%u.%u.%u.%u/%u via eth%d\r\n", bench_bytes[0], bench_bytes[1], bench_bytes[2], bench_bytes[3], 24u, bench_status + 6)
+BENCH_CASE(counters, "%-8s rx %llu tx %llu err %u\r\n", bench_name, bench_rx, bench_rx / 3, bench_count)
+BENCH_CASE(dump, "%04x: %02x %02x %02x %02x %02x %02x %02x %02x\r\n", bench_count,
+           bench_bytes[0], bench_bytes[1], bench_bytes[2], bench_bytes[3],
+           bench_bytes[4], bench_bytes[5], bench_bytes[6], bench_bytes[7])
+BENCH_CASE(text, "%s: %s\r\n", bench_name, bench_text)
+BENCH_CASE(temp, "%-8s %6.2f C\r\n", bench_name, bench_temp)
+
+#define BENCH_ENTRY(id)                 { #id, id##_line, id##_print }
+
+
+static const struct bench_case bench_cases[] = {
+    BENCH_ENTRY(status),
+    BENCH_ENTRY(reg),
+    BENCH_ENTRY(route),
+    BENCH_ENTRY(counters),
+    BENCH_ENTRY(dump),
+    BENCH_ENTRY(text),
+    BENCH_ENTRY(temp),
+};
+
+
+
+//Declare Prototype
+static int32_t bench_io_write(void *ctx, const uint8_t *buf, size_t len);
+static int32_t bench_io_read(void *ctx, uint8_t *buf, size_t len);
+static void bench_printf(shellObject_t *pshell, const char *fmt, ...);
+static double bench_now(void);
+
+
+static const shell_io_t bench_io = {
+    bench_io_read,
+    bench_io_write,
+    NULL,
+};
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+// the bytes are only hashed
+static int32_t bench_io_write(void *ctx, const uint8_t *buf, size_t len)
+{
+    size_t i;
+
+    (void) ctx;
+
+    for (i = 0; i < len; i++) bench_hash = (bench_hash ^ buf[i]) * BENCH_FNV_PRIME;
+
+    return len;
+}
+
+
+static int32_t bench_io_read(void *ctx, uint8_t *buf, size_t len)
+{
+    (void) ctx;
+    (void) buf;
+    (void) len;
+
+    return 0;
+}
+
+
+//*****************************************************************************
+// shellPrintf() as it was, vsnprintf() then the bytes
+static void bench_printf(shellObject_t *pshell, const char *fmt, ...)
+{
+    char text[BENCH_LINE_LEN];
+    va_list args;
+    int len;
+
+    va_start(args, fmt);
+    len = vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    if (len > 0) shellWrite(pshell, text, ((size_t) len < sizeof(text)) ? (size_t) len : sizeof(text) - 1);
+}
+
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+int main(int argc, char *argv[])
+{
+    char ref[BENCH_LINE_LEN], out[BENCH_LINE_LEN];
+    shellObject_t *pshell;
+    uint32_t calls = 200000;
+    uint32_t hash_libc, hash_shell;
+    double t0, ns[4];
+    int status = 0;
+    bool same;
+    uint32_t i;
+    size_t c;
+    int opt;
+
+    for (opt = 1; opt < argc; opt++) {
+        if (!strcmp(argv[opt], "-n") && (opt + 1 < argc)) calls = strtoul(argv[++opt], NULL, 0);
+        else {
+            fprintf(stderr, "usage: %s [-n calls]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!calls) calls = 1;
+
+    pshell = shellOpenIo(&bench_io, NULL, "$ ", NULL);
+    if (pshell == NULL) return 2;
+
+    printf("%-10s %10s %10s %6s %10s %10s %6s  %s\n", "line", "snprintf", "shell", "gain",
+           "vsnprintf", "shellPrintf", "gain", "output");
+
+    for (c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+        const struct bench_case *bc = &bench_cases[c];
+
+        bc->line(snprintf, ref, sizeof(ref));
+        bc->line(shellSnprintf, out, sizeof(out));
+        same = !strcmp(ref, out);
+
+        t0 = bench_now();
+        for (i = 0; i < calls; i++) bc->line(snprintf, ref, sizeof(ref));
+        ns[0] = (bench_now() - t0) * 1e9 / calls;
+
+        t0 = bench_now();
+        for (i = 0; i < calls; i++) bc->line(shellSnprintf, out, sizeof(out));
+        ns[1] = (bench_now() - t0) * 1e9 / calls;
+
+        bench_hash = BENCH_FNV_BASIS;
+        t0 = bench_now();
+        for (i = 0; i < calls; i++) bc->print(bench_printf, pshell);
+        ns[2] = (bench_now() - t0) * 1e9 / calls;
+        hash_libc = bench_hash;
+
+        bench_hash = BENCH_FNV_BASIS;
+        t0 = bench_now();
+        for (i = 0; i < calls; i++) bc->print(shellPrintf, pshell);
+        ns[3] = (bench_now() - t0) * 1e9 / calls;
+        hash_shell = bench_hash;
+
+        same = same && (hash_libc == hash_shell);
+        if (!same) status = 1;
+
+        printf("%-10s %10.1f %10.1f %5.2fx %10.1f %10.1f %5.2fx  %s\n", bc->name, ns[0], ns[1], ns[0] / ns[1],
+               ns[2], ns[3], ns[2] / ns[3], same ? "same" : "DIFFERENT");
+        if (!same) printf("  snprintf [%s]\n  shell    [%s]\n", ref, out);
+    }
+
+    shellClose(pshell);
+
+    return status;
+}
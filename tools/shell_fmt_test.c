@@ -0,0 +1,133 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_fmt_test.c
+* @details Corner cases of the built-in formatter against vsnprintf()
+*
+*   shell_fmt_test
+*
+*   Each format is given to vsnprintf() and shellVsnprintf() with the same
+*   arguments, the bytes and the length returned must be the same: the
+*   flags and precisions which change the output of a zero first, then
+*   their neighbours and a buffer too short.
+*
+*   Exit status: 0 passed, 1 a format differs.
+*
+*   cc -I.. -o shell_fmt_test shell_fmt_test.c ../shell_fmt.c
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 04:12:37
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shell_fmt.h"
+
+
+
+
+
+#define TEST_LINE_LEN                   64
+
+
+
+//Declare Prototype
+static int test_fmt(size_t size, const char *fmt, ...);
+
+
+static int test_failed;
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+// the formats aren't checked by the compiler here, a few are odd on purpose
+static int test_fmt(size_t size, const char *fmt, ...)
+{
+    char ref[TEST_LINE_LEN];
+    char out[TEST_LINE_LEN];
+    va_list args;
+    int nref, nout;
+    bool same;
+
+    memset(ref, '#', sizeof(ref));
+    memset(out, '#', sizeof(out));
+
+    va_start(args, fmt);
+    nref = vsnprintf(ref, size, fmt, args);
+    va_end(args);
+
+    va_start(args, fmt);
+    nout = shellVsnprintf(out, size, fmt, args);
+    va_end(args);
+
+    same = (nref == nout) && !memcmp(ref, out, sizeof(ref));
+    printf("%-4s %-10s %2zu [%s]\n", same ? "ok" : "FAIL", fmt, size, ref);
+    if (!same) {
+        printf("     shell         [%.*s] %d, want %d\n", (int) sizeof(out) - 1, out, nout, nref);
+        test_failed++;
+    }
+
+    return same ? 0 : 1;
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+int main(void)
+{
+    /* a zero, the cases first seen wrong */
+    test_fmt(TEST_LINE_LEN, "%#o", 0);
+    test_fmt(TEST_LINE_LEN, "%.0d", 0);
+    test_fmt(TEST_LINE_LEN, "%-08x|", 0x2a);
+
+    test_fmt(TEST_LINE_LEN, "%#o", 8);
+    test_fmt(TEST_LINE_LEN, "%#.0o", 0);
+    test_fmt(TEST_LINE_LEN, "%#x", 0);
+    test_fmt(TEST_LINE_LEN, "%#x", 0x2a);
+    test_fmt(TEST_LINE_LEN, "%.0u", 0u);
+    test_fmt(TEST_LINE_LEN, "%5.0d|", 0);
+    test_fmt(TEST_LINE_LEN, "%.0d", 7);
+    test_fmt(TEST_LINE_LEN, "%-08d|", -5);
+    test_fmt(TEST_LINE_LEN, "%08x", 0x2a);
+    test_fmt(TEST_LINE_LEN, "%08.3d", 7);
+    test_fmt(TEST_LINE_LEN, "%+.0d", 0);
+
+    /* cut, the length is the one of the whole output */
+    test_fmt(4, "%-08x|", 0x2a);
+    test_fmt(1, "%#o", 0);
+
+    return test_failed ? 1 : 0;
+}
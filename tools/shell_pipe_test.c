@@ -0,0 +1,212 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_pipe_test.c
+* @details Lines of a stream cut in chunks, as shellPipeLines() gives them
+*
+*   shell_pipe_test
+*
+*   A text is given to shellPipeLines() whole, then cut at each place in
+*   two chunks, then a byte at a time: the filter must see the same lines
+*   each time, the ones split across the chunks included. A line longer
+*   than SHELL_PIPE_LINE_LEN is cut at that length, an error of the filter
+*   stops the chunk.
+*
+*   Exit status: 0 passed, 1 the lines differ.
+*
+*   cc -I.. -DSHELL_CFG_PIPE=1 -o shell_pipe_test shell_pipe_test.c ../shell_pipe.c ../shell_args.c ../shell.c ../shell_fmt.c ../shell_io.c ../vt100.c
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 04:41:52
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shell.h"
+#include "shell_pipe.h"
+
+
+
+
+
+#define TEST_OUT_LEN                    1024
+#define TEST_STOP_AFTER                 2          //!< Lines taken by the failing filter
+
+
+/**
+ * Lines seen by the filter, each one between brackets
+ */
+struct test_lines
+{
+    char                text[TEST_OUT_LEN];
+    size_t              len;
+};
+
+
+
+//Declare Prototype
+static s_err_t test_line(shell_stage_t *stage, const uint8_t *line, uint32_t len);
+static s_err_t test_line_fail(shell_stage_t *stage, const uint8_t *line, uint32_t len);
+static void test_feed(shell_stage_t *stage, const char *text, size_t len, size_t chunk, size_t first,
+                      shell_line_func_t func);
+static bool test_check(const char *name, const struct test_lines *got, const struct test_lines *want);
+
+
+static int test_failed;
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+static s_err_t test_line(shell_stage_t *stage, const uint8_t *line, uint32_t len)
+{
+    struct test_lines *out = (struct test_lines *) stage->ctx;
+
+    if (out->len + len + 2 > sizeof(out->text)) return SYS_EFULL;
+
+    out->text[out->len++] = '[';
+    memcpy(&out->text[out->len], line, len);
+    out->len += len;
+    out->text[out->len++] = ']';
+
+    return SYS_EOK;
+}
+
+
+static s_err_t test_line_fail(shell_stage_t *stage, const uint8_t *line, uint32_t len)
+{
+    if (++stage->count > TEST_STOP_AFTER) return SYS_ERROR;
+
+    return test_line(stage, line, len);
+}
+
+
+//*****************************************************************************
+// a first chunk of first bytes, then chunks of chunk bytes, then the end
+static void test_feed(shell_stage_t *stage, const char *text, size_t len, size_t chunk, size_t first,
+                      shell_line_func_t func)
+{
+    size_t n;
+
+    stage->carry_len = 0;
+    stage->count = 0;
+
+    n = (first < len) ? first : len;
+    if (n) shellPipeLines(stage, (const uint8_t *) text, n, func);
+
+    for (; n < len; n += chunk) {
+        shellPipeLines(stage, (const uint8_t *) &text[n], (len - n < chunk) ? (len - n) : chunk, func);
+    }
+
+    shellPipeLines(stage, SHELL_PIPE_END, 0, func);
+}
+
+
+static bool test_check(const char *name, const struct test_lines *got, const struct test_lines *want)
+{
+    bool same = (got->len == want->len) && !memcmp(got->text, want->text, got->len);
+
+    if (!same) {
+        printf("FAIL %s\n     got  %.*s\n     want %.*s\n", name, (int) got->len, got->text,
+               (int) want->len, want->text);
+        test_failed++;
+    }
+
+    return same;
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+int main(void)
+{
+    static const char text[] = "one\r\ntwo\n\nthree four\nlast without end";
+    static const char lines[] = "[one\r\n][two\n][\n][three four\n][last without end]";
+    static char line[SHELL_PIPE_LINE_LEN + 40];
+    static struct test_lines want, got;
+    shell_stage_t stage;
+    char name[64];
+    size_t len = sizeof(text) - 1;
+    size_t i;
+    bool ok;
+
+    memset(&stage, 0, sizeof(stage));
+    stage.ctx = &want;
+    test_feed(&stage, text, len, len, len, test_line);
+
+    got.len = sizeof(lines) - 1;
+    memcpy(got.text, lines, got.len);
+    printf("%-4s whole\n", test_check("whole", &want, &got) ? "ok" : "FAIL");
+
+    /* cut in two at each place */
+    stage.ctx = &got;
+    for (ok = true, i = 1; i < len; i++) {
+        got.len = 0;
+        test_feed(&stage, text, len, len, i, test_line);
+        snprintf(name, sizeof(name), "cut at %zu", i);
+        ok &= test_check(name, &got, &want);
+    }
+    printf("%-4s cut in two at each place\n", ok ? "ok" : "FAIL");
+
+    got.len = 0;
+    test_feed(&stage, text, len, 1, 1, test_line);
+    printf("%-4s a byte at a time\n", test_check("a byte at a time", &got, &want) ? "ok" : "FAIL");
+
+    got.len = 0;
+    test_feed(&stage, text, len, 3, 5, test_line);
+    printf("%-4s chunks of 3 bytes\n", test_check("chunks of 3 bytes", &got, &want) ? "ok" : "FAIL");
+
+    /* longer than the carry, cut at its size once it's split */
+    memset(line, 'x', sizeof(line));
+    line[sizeof(line) - 1] = '\n';
+    want.len = 0;
+    stage.ctx = &want;
+    test_line(&stage, (const uint8_t *) line, SHELL_PIPE_LINE_LEN);
+    test_line(&stage, (const uint8_t *) &line[SHELL_PIPE_LINE_LEN], sizeof(line) - SHELL_PIPE_LINE_LEN);
+    got.len = 0;
+    stage.ctx = &got;
+    test_feed(&stage, line, sizeof(line), 7, 1, test_line);
+    printf("%-4s a line longer than the carry\n", test_check("a line longer than the carry", &got, &want) ? "ok" : "FAIL");
+
+    /* the filter fails at the third line, the rest of the chunk isn't given */
+    got.len = 0;
+    stage.carry_len = 0;
+    stage.count = 0;
+    ok = (shellPipeLines(&stage, (const uint8_t *) "a\nb\nc\nd\n", 8, test_line_fail) == SYS_ERROR) &&
+         (stage.count == TEST_STOP_AFTER + 1) && (got.len == 8) && !memcmp(got.text, "[a\n][b\n]", 8);
+    printf("%-4s an error of the filter stops the chunk\n", ok ? "ok" : "FAIL");
+    if (!ok) test_failed++;
+
+    return test_failed ? 1 : 0;
+}
@@ -0,0 +1,317 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_server_bench.c
+* @details Lines per second of the console server against its shards
+*
+*   shell_server_bench [-s sessions] [-l lines] [-w work] [-b batch] [-c shards]
+*
+*   The sessions are connected through socket pairs, client threads send
+*   batches of "prov" lines to them as a provisioning burst would and read
+*   the answers. Each "prov" spends work rounds of a hash before it
+*   answers. The same run is done with 1, 2, 4... shards up to -c, the
+*   number of cores by default, with as many client threads: the rate of
+*   lines, the speedup against one shard, the efficiency per shard and
+*   how the sessions were spread.
+*
+*   cc -O2 -I.. -o shell_server_bench shell_server_bench.c ../shell_server.c ../shell.c ../shell_fmt.c ../shell_io.c ../vt100.c -lpthread
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 23:52:40
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "shell_server.h"
+
+
+
+
+
+#define BENCH_SESSIONS_MAX              4096
+#define BENCH_LINE                      "prov\n"
+#define BENCH_MARK                      '#'        //!< One per answer, never echoed
+
+
+/**
+ * Client thread, the sessions i with i % nclients == id
+ */
+struct bench_client
+{
+    pthread_t           thread;
+    uint32_t            id;
+    uint32_t            nclients;
+    int                 failed;
+};
+
+
+static uint32_t bench_sessions = 64;
+static uint32_t bench_lines = 2000;
+static uint32_t bench_work = 20000;
+static uint32_t bench_batch = 16;
+
+static int bench_fd[BENCH_SESSIONS_MAX];        //!< Client side of each session
+
+
+
+//Declare Prototype
+static int32_t bench_cmd_prov(shellObject_t *pshell, int32_t argc, char *argv[]);
+static s_err_t bench_open(shell_session_t *ps, void *ctx);
+static double bench_now(void);
+static int bench_wait(int fd, uint32_t marks);
+static void *bench_client(void *arg);
+static int bench_run(uint8_t nshards, double *rate, double base);
+
+
+static const shell_cmd_t bench_cmds[] = {
+    { "prov", bench_cmd_prov, "Provision a unit", NULL },
+};
+
+static const shell_server_ops_t bench_ops = {
+    "$ ",
+    false,
+    bench_open,
+    NULL,
+    NULL,
+    0,
+    0,
+    0,
+};
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+// a provisioning step: work rounds of a hash then the answer
+static int32_t bench_cmd_prov(shellObject_t *pshell, int32_t argc, char *argv[])
+{
+    uint32_t hash = 2166136261u;
+    uint32_t i;
+
+    (void) argc;
+    (void) argv;
+
+    for (i = 0; i < bench_work; i++) {
+        hash = (hash ^ (i & 0xFF)) * 16777619u;
+    }
+
+    shellPrintf(pshell, "%c%08x\r\n", BENCH_MARK, hash);
+
+    return 0;
+}
+
+
+static s_err_t bench_open(shell_session_t *ps, void *ctx)
+{
+    (void) ctx;
+
+    return shellSetCommands(ps->shell, bench_cmds, sizeof(bench_cmds) / sizeof(bench_cmds[0]));
+}
+
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+//*****************************************************************************
+// read the answers of the batch
+static int bench_wait(int fd, uint32_t marks)
+{
+    char buf[1024];
+    ssize_t n, i;
+
+    while (marks) {
+        n = read(fd, buf, sizeof(buf));
+        if (n <= 0) return -1;
+
+        for (i = 0; i < n; i++) {
+            if (buf[i] == BENCH_MARK) marks--;
+        }
+    }
+
+    return 0;
+}
+
+
+//*****************************************************************************
+// a batch to each session then its answers, up to the count of lines
+static void *bench_client(void *arg)
+{
+    struct bench_client *client = (struct bench_client *) arg;
+    char batch[sizeof(BENCH_LINE) * 256];
+    size_t len;
+    uint32_t done, n, s, i;
+
+    for (i = 0; i < bench_batch; i++) {
+        memcpy(&batch[i * (sizeof(BENCH_LINE) - 1)], BENCH_LINE, sizeof(BENCH_LINE) - 1);
+    }
+
+    for (done = 0; done < bench_lines; done += n) {
+        n = (bench_lines - done < bench_batch) ? (bench_lines - done) : bench_batch;
+        len = (sizeof(BENCH_LINE) - 1) * n;
+
+        for (s = client->id; s < bench_sessions; s += client->nclients) {
+            if (write(bench_fd[s], batch, len) != (ssize_t) len) client->failed = 1;
+        }
+
+        for (s = client->id; s < bench_sessions; s += client->nclients) {
+            if (bench_wait(bench_fd[s], n) < 0) client->failed = 1;
+        }
+
+        if (client->failed) break;
+    }
+
+    return NULL;
+}
+
+
+//*****************************************************************************
+static int bench_run(uint8_t nshards, double *rate, double base)
+{
+    struct bench_client clients[SHELL_SERVER_SHARDS_MAX];
+    shell_server_stats_t stats;
+    shell_server_t *srv;
+    uint32_t lo = UINT32_MAX, hi = 0, moves = 0;
+    uint32_t i;
+    int sv[2];
+    int failed = 0;
+    double t0, t;
+
+    srv = shellServerOpen(nshards, &bench_ops, NULL);
+    if (srv == NULL) {
+        fprintf(stderr, "shellServerOpen failed\n");
+        return -1;
+    }
+
+    for (i = 0; i < bench_sessions; i++) {
+        if ((socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) || (shellServerAdd(srv, sv[1]) != SYS_EOK)) {
+            fprintf(stderr, "session %u failed\n", i);
+            shellServerClose(srv);
+            return -1;
+        }
+        bench_fd[i] = sv[0];
+    }
+
+    t0 = bench_now();
+
+    for (i = 0; i < nshards; i++) {
+        clients[i].id = i;
+        clients[i].nclients = nshards;
+        clients[i].failed = 0;
+        pthread_create(&clients[i].thread, NULL, bench_client, &clients[i]);
+    }
+    for (i = 0; i < nshards; i++) {
+        pthread_join(clients[i].thread, NULL);
+        failed |= clients[i].failed;
+    }
+
+    t = bench_now() - t0;
+
+    for (i = 0; i < nshards; i++) {
+        shellServerStats(srv, i, &stats);
+        if (stats.sessions < lo) lo = stats.sessions;
+        if (stats.sessions > hi) hi = stats.sessions;
+        moves += stats.moved_out;
+    }
+
+    for (i = 0; i < bench_sessions; i++) close(bench_fd[i]);
+    shellServerClose(srv);
+
+    if (failed) {
+        fprintf(stderr, "%u shards: a session failed\n", nshards);
+        return -1;
+    }
+
+    *rate = (double) bench_sessions * bench_lines / t;
+    if (base <= 0) base = *rate;
+
+    printf("%6u %12.0f %8.2fx %9.0f%% %7u-%-5u %6u\n", nshards, *rate, *rate / base,
+           100.0 * *rate / base / nshards, lo, hi, moves);
+
+    return 0;
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+int main(int argc, char *argv[])
+{
+    long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t max_shards = (ncpus > 0) ? ncpus : 1;
+    double rate, base = 0;
+    uint32_t n;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:l:w:b:c:")) != -1) {
+        switch (opt) {
+            case 's': bench_sessions = strtoul(optarg, NULL, 0); break;
+            case 'l': bench_lines = strtoul(optarg, NULL, 0); break;
+            case 'w': bench_work = strtoul(optarg, NULL, 0); break;
+            case 'b': bench_batch = strtoul(optarg, NULL, 0); break;
+            case 'c': max_shards = strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-s sessions] [-l lines] [-w work] [-b batch] [-c shards]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (!bench_sessions || (bench_sessions > BENCH_SESSIONS_MAX) || !bench_lines ||
+        !bench_batch || (bench_batch > 256) || !max_shards) {
+        fprintf(stderr, "bad arguments\n");
+        return 1;
+    }
+    if (max_shards > SHELL_SERVER_SHARDS_MAX) max_shards = SHELL_SERVER_SHARDS_MAX;
+
+    printf("%u sessions, %u lines each by batches of %u, %u work rounds per line, %ld cores\n\n",
+           bench_sessions, bench_lines, bench_batch, bench_work, ncpus);
+    printf("%6s %12s %9s %10s %13s %6s\n", "shards", "lines/s", "speedup", "per shard", "sessions", "moves");
+
+    for (n = 1; ; n = (n * 2 > max_shards) ? max_shards : n * 2) {
+        if (bench_run(n, &rate, base) < 0) return 1;
+        if (base <= 0) base = rate;
+        if (n == max_shards) break;
+    }
+
+    return 0;
+}
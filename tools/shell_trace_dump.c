@@ -0,0 +1,292 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_trace_dump.c
+* @details Analyzer of the shell trace dumps
+*
+*   shell_trace_dump [-q] <file>
+*
+*   Prints the timeline of a file written by shellTraceDump(), the spans
+*   indented by nesting, then the latency of each phase: inclusive and
+*   exclusive (without the nested phases) totals, percentiles and the
+*   slowest spans.
+*
+*   cc -O2 -I.. -o shell_trace_dump shell_trace_dump.c
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 19:40:05
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shell_trace.h"
+
+
+
+
+
+#define DUMP_EVENTS                     8
+#define DUMP_DEPTH                      32
+#define DUMP_SLOWEST                    5
+
+
+/**
+ * Open span
+ */
+struct dump_span
+{
+    uint8_t             event;
+    uint64_t            start;
+    uint64_t            child;                     //!< Time of the nested spans
+};
+
+/**
+ * Phase statistics
+ */
+struct dump_phase
+{
+    uint64_t            *dur;                      //!< Inclusive durations
+    uint32_t            count;
+    uint32_t            size;
+    uint32_t            marks;
+    uint64_t            total;
+    uint64_t            excl;
+};
+
+/**
+ * Slow span
+ */
+struct dump_slow
+{
+    uint64_t            dur;
+    uint64_t            at;
+    uint8_t             event;
+    uint32_t            arg;
+};
+
+
+static const char *dump_names[DUMP_EVENTS] = {
+    "?", "read", "key", "redraw", "reflow", "history", "exec", "flush",
+};
+
+static struct dump_phase phases[DUMP_EVENTS];
+static struct dump_slow slowest[DUMP_SLOWEST];
+
+
+
+//Declare Prototype
+static const char *dump_name(uint8_t event);
+static void dump_add(uint8_t event, uint64_t dur, uint64_t excl, uint64_t at, uint32_t arg);
+static int dump_cmp(const void *a, const void *b);
+static void dump_stats(uint64_t span);
+
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+static const char *dump_name(uint8_t event)
+{
+    return (event < DUMP_EVENTS) ? dump_names[event] : dump_names[0];
+}
+
+
+//*****************************************************************************
+// one closed span
+static void dump_add(uint8_t event, uint64_t dur, uint64_t excl, uint64_t at, uint32_t arg)
+{
+    struct dump_phase *ph = &phases[event];
+    int i;
+
+    if (ph->count == ph->size) {
+        ph->size = ph->size ? ph->size * 2 : 256;
+        ph->dur = (uint64_t *) realloc(ph->dur, ph->size * sizeof(uint64_t));
+        if (ph->dur == NULL) exit(EXIT_FAILURE);
+    }
+
+    ph->dur[ph->count++] = dur;
+    ph->total += dur;
+    ph->excl += excl;
+
+    /* kept sorted, the slowest first */
+    for (i = DUMP_SLOWEST - 1; (i >= 0) && (slowest[i].dur < dur); i--) {
+        if (i < DUMP_SLOWEST - 1) slowest[i + 1] = slowest[i];
+    }
+    if (i < DUMP_SLOWEST - 1) {
+        slowest[i + 1].dur = dur;
+        slowest[i + 1].at = at;
+        slowest[i + 1].event = event;
+        slowest[i + 1].arg = arg;
+    }
+}
+
+
+static int dump_cmp(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+
+//*****************************************************************************
+// per phase latency, in us
+static void dump_stats(uint64_t span)
+{
+    struct dump_phase *ph;
+    uint8_t ev;
+    int i;
+
+    printf("\n%-8s %8s %12s %12s %6s %10s %10s %10s %10s\n",
+           "phase", "count", "total", "exclusive", "%", "p50", "p99", "max", "marks");
+
+    for (ev = 1; ev < DUMP_EVENTS; ev++) {
+        ph = &phases[ev];
+        if (!ph->count && !ph->marks) continue;
+
+        if (!ph->count) {
+            printf("%-8s %8u %12s %12s %6s %10s %10s %10s %10u\n",
+                   dump_name(ev), 0, "-", "-", "-", "-", "-", "-", ph->marks);
+            continue;
+        }
+
+        qsort(ph->dur, ph->count, sizeof(uint64_t), dump_cmp);
+
+        printf("%-8s %8u %12.3f %12.3f %6.1f %10.3f %10.3f %10.3f %10u\n",
+               dump_name(ev), ph->count, ph->total / 1e3, ph->excl / 1e3,
+               span ? (100.0 * ph->excl / span) : 0.0,
+               ph->dur[ph->count / 2] / 1e3,
+               ph->dur[(ph->count * 99) / 100] / 1e3,
+               ph->dur[ph->count - 1] / 1e3,
+               ph->marks);
+    }
+
+    printf("\nslowest spans\n");
+    for (i = 0; (i < DUMP_SLOWEST) && slowest[i].dur; i++) {
+        printf("  %-8s %10.3f us at +%.3f us, arg %d\n", dump_name(slowest[i].event),
+               slowest[i].dur / 1e3, slowest[i].at / 1e3, (int32_t) slowest[i].arg);
+    }
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+int main(int argc, char *argv[])
+{
+    struct dump_span stack[DUMP_DEPTH];
+    shell_trace_file_t hdr;
+    shell_trace_rec_t rec;
+    const char *path = NULL;
+    bool quiet = false;
+    uint64_t first = 0, last = 0, dur, prev = 0;
+    int depth = 0;
+    uint32_t n;
+    FILE *file;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-q")) quiet = true;
+        else path = argv[i];
+    }
+
+    if (path == NULL) {
+        fprintf(stderr, "usage: %s [-q] <file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    if ((fread(&hdr, sizeof(hdr), 1, file) != 1) || (hdr.magic != SHELL_TRACE_MAGIC) ||
+        (hdr.version != SHELL_TRACE_VERSION) || (hdr.rec_size != sizeof(rec))) {
+        fprintf(stderr, "%s: not a shell trace\n", path);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u records, %u lost before the dump\n", hdr.count, hdr.lost);
+
+    for (n = 0; (n < hdr.count) && (fread(&rec, sizeof(rec), 1, file) == 1); n++) {
+        if (!n) first = prev = rec.ts;
+        if (rec.ts < prev) rec.ts = prev;         //a torn or reordered record
+        last = prev = rec.ts;
+
+        if (rec.event >= DUMP_EVENTS) rec.event = 0;
+
+        switch (rec.kind) {
+            case SHELL_TRACE_BEGIN_KIND:
+                if (!quiet) printf("%12.3f %*s> %s %d\n", (rec.ts - first) / 1e3, depth * 2, "",
+                                   dump_name(rec.event), (int32_t) rec.arg);
+
+                if (depth < DUMP_DEPTH) {
+                    stack[depth].event = rec.event;
+                    stack[depth].start = rec.ts;
+                    stack[depth].child = 0;
+                }
+                depth++;
+                break;
+            case SHELL_TRACE_END_KIND:
+                /* spans lost with the start of the ring are skipped */
+                for (i = ((depth < DUMP_DEPTH) ? depth : DUMP_DEPTH) - 1; i >= 0; i--) {
+                    if (stack[i].event == rec.event) break;
+                }
+                if (i < 0) break;
+
+                depth = i;
+                dur = rec.ts - stack[i].start;
+                dump_add(rec.event, dur, dur - ((stack[i].child < dur) ? stack[i].child : dur),
+                         stack[i].start - first, rec.arg);
+                if (i > 0) stack[i - 1].child += dur;
+
+                if (!quiet) printf("%12.3f %*s< %s %d (%.3f us)\n", (rec.ts - first) / 1e3, depth * 2, "",
+                                   dump_name(rec.event), (int32_t) rec.arg, dur / 1e3);
+                break;
+            default:
+                phases[rec.event].marks++;
+                if (!quiet) printf("%12.3f %*s* %s %d\n", (rec.ts - first) / 1e3, depth * 2, "",
+                                   dump_name(rec.event), (int32_t) rec.arg);
+                break;
+        }
+    }
+
+    fclose(file);
+
+    printf("\n%.3f us traced\n", (last - first) / 1e3);
+    dump_stats(last - first);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_vars_test.c
+* @details Expansion of the variables in the corner cases of the syntax
+*
+*   shell_vars_test
+*
+*   A table holds a few variables, each line is expanded by
+*   shellVarsExpand() and compared with the line expected: "${NAME" with
+*   no closing brace, "\$", a '$' not followed by a name, a name too
+*   long, and an output buffer too short.
+*
+*   Exit status: 0 passed, 1 a line differs.
+*
+*   cc -I.. -DSHELL_CFG_VARS=1 -o shell_vars_test shell_vars_test.c ../shell_vars.c ../shell.c ../shell_fmt.c ../shell_io.c ../vt100.c
+*
+* @author Auban le Grelle
+*
+* @date 20 oct. 2026 04:26:05
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shell.h"
+#include "shell_vars.h"
+
+
+
+
+
+#define TEST_LINE_LEN                   128
+
+
+/**
+ * Line and its expansion, NULL if it doesn't hold in size
+ */
+struct test_case
+{
+    const char          *line;
+    const char          *want;
+    size_t              size;
+};
+
+
+static const struct test_case test_cases[] = {
+    { "i2c read $dev 0",        "i2c read 0x48 0",      TEST_LINE_LEN },
+    { "i2c read ${dev}0",       "i2c read 0x480",       TEST_LINE_LEN },
+
+    /* no closing brace, the text stays as it is */
+    { "echo ${dev",             "echo ${dev",           TEST_LINE_LEN },
+    { "echo ${dev x}",          "echo ${dev x}",        TEST_LINE_LEN },
+    { "echo ${",                "echo ${",              TEST_LINE_LEN },
+    { "echo ${}",               "echo ${}",             TEST_LINE_LEN },
+
+    /* an escaped '$' is kept, the name after it too, a lone backslash is a char */
+    { "echo \\$dev",            "echo $dev",            TEST_LINE_LEN },
+    { "echo \\${dev}",          "echo ${dev}",          TEST_LINE_LEN },
+    { "echo \\\\$dev",          "echo \\$dev",          TEST_LINE_LEN },   /* only "\$" is escaped */
+    { "echo a\\b",              "echo a\\b",            TEST_LINE_LEN },
+    { "echo \\",                "echo \\",              TEST_LINE_LEN },
+
+    /* not a name */
+    { "echo $",                 "echo $",               TEST_LINE_LEN },
+    { "echo $ 1",               "echo $ 1",             TEST_LINE_LEN },
+    { "echo $1",                "echo $1",              TEST_LINE_LEN },
+    { "echo $unset.",           "echo .",               TEST_LINE_LEN },
+    { "$dev$dev",               "0x480x48",             TEST_LINE_LEN },
+
+    /* the output buffer */
+    { "$dev",                   "0x48",                 5 },
+    { "$dev",                   NULL,                   4 },
+    { "echo ${dev",             NULL,                   10 },
+};
+
+
+static shell_vars_t test_vars;
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+int main(void)
+{
+    const struct test_case *tc;
+    char out[TEST_LINE_LEN];
+    shellObject_t *pshell;
+    int failed = 0;
+    int32_t n;
+    size_t i;
+    bool same;
+
+    pshell = shellOpenIo(&shell_io_ring, NULL, "> ", NULL);
+    if ((pshell == NULL) || (shellVarsOpen(pshell, &test_vars) != SYS_EOK)) return 1;
+
+    shellVarsSet(pshell, "dev", "0x48");
+
+    for (i = 0; i < sizeof(test_cases) / sizeof(test_cases[0]); i++) {
+        tc = &test_cases[i];
+
+        n = shellVarsExpand(pshell, tc->line, out, tc->size);
+        same = (tc->want == NULL) ? (n < 0) : ((n == (int32_t) strlen(tc->want)) && !strcmp(out, tc->want));
+
+        printf("%-4s [%s] -> [%s]\n", same ? "ok" : "FAIL", tc->line, (tc->want != NULL) ? tc->want : "(too long)");
+        if (!same) {
+            printf("     got %d [%s]\n", (int) n, (n >= 0) ? out : "");
+            failed++;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
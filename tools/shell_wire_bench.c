@@ -0,0 +1,432 @@
+/***************************************************************************//**
+* @file
+* @brief C File shell_wire_bench.c
+* @details Bytes on the wire of the line editor, checked on an emulated screen
+*
+*   shell_wire_bench [-q] [-o report] [-r reference]
+*
+*   Scripted edits (typing, inserts and deletes at both ends, history,
+*   wrap across the columns, tab, paste) go through a session on the ring
+*   backend, all its output is interpreted by the vtemu emulator. After
+*   each key the screen must show the prompt and the line buffer where
+*   the cursor says, with nothing left after it, and the cursor on
+*   line_cur. Built with SHELL_CFG_HIGHLIGHT the colours are checked too.
+*
+*   Each operation reports the bytes written by the shell, per key and
+*   their time on a 9600 bauds link. -o writes the bytes of each operation
+*   to a report, -r fails when one grew since a previous report.
+*
+*   Exit status: 0 passed, 1 the screen is wrong, 2 more bytes than the
+*   reference.
+*
+*   cc -O2 -I.. -o shell_wire_bench shell_wire_bench.c ../shell.c ../shell_fmt.c ../shell_io.c ../vt100.c ../vtemu.c
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 23:05:44
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shell.h"
+#include "vtemu.h"
+
+
+
+
+
+#define BENCH_ROWS                      24
+#define BENCH_COLS                      40         //!< Narrow, the long lines wrap
+#define BENCH_PROMPT                    "$ "
+#define BENCH_BAUDS                     9600       //!< 10 bits a byte
+#define BENCH_RING_LEN                  65536
+#define BENCH_PASSES                    1000       //!< Engine passes before giving up on a key
+#define BENCH_OPS                       32
+
+#define ESC                             "\033"
+#define LEFT                            ESC "[D"
+#define RIGHT                           ESC "[C"
+#define UP                              ESC "[A"
+#define DOWN                            ESC "[B"
+#define LEFT5                           LEFT LEFT LEFT LEFT LEFT
+#define RIGHT5                          RIGHT RIGHT RIGHT RIGHT RIGHT
+#define BS3                             "\177\177\177"
+
+
+/**
+ * Scripted operation, each key is checked
+ */
+struct bench_op
+{
+    const char          *name;
+    const char          *keys;
+};
+
+/**
+ * Bytes of an operation
+ */
+struct bench_res
+{
+    uint32_t            keys;
+    uint32_t            bytes;
+    uint32_t            max;                       //!< Most bytes for one key
+    uint32_t            errors;
+};
+
+/**
+ * Session under test and its screen
+ */
+struct bench
+{
+    shellObject_t       *pshell;
+    shell_ring_t        rx;
+    shell_ring_t        tx;
+    shell_io_ring_t     io;
+    vtemu_t             emu;
+    uint32_t            bytes;                     //!< Written by the shell
+    bool                quiet;
+};
+
+
+static const struct bench_op bench_ops[] = {
+    { "type",           "show -v alpha" },
+    { "left",           LEFT5 LEFT5 LEFT LEFT LEFT },
+    { "insert-head",    "x" },
+    { "delete-head",    RIGHT "\177" },
+    { "right",          RIGHT5 },
+    { "delete-mid",     BS3 },
+    { "end",            RIGHT5 RIGHT5 RIGHT5 },
+    { "backspace-end",  BS3 },
+    { "wrap",           " 0123456789abcdefghijklmnopqrstuvwxyz0123456789" },
+    { "wrap-left",      LEFT5 LEFT5 LEFT5 LEFT5 LEFT5 LEFT5 },
+    { "wrap-insert",    "ABC" },
+    { "wrap-delete",    BS3 BS3 },
+    { "tab",            "\t" },
+    { "enter",          "\r\n" },
+    { "history-up",     UP UP },
+    { "history-down",   DOWN },
+    { "ctrl-c",         "\003" },
+    { "paste",          ESC "[200~show -v pasted in one write, long enough to wrap" ESC "[201~" },
+    { "enter-wrapped",  "\r\n" },
+};
+
+#if SHELL_CFG_HIGHLIGHT
+/* same colours as the shell */
+static const uint8_t bench_hl_colour[] = {
+    VT_COL_DEFAULT, SHELL_HL_COLOUR_CMD, SHELL_HL_COLOUR_UNKNOWN, SHELL_HL_COLOUR_OPTION
+};
+#endif
+
+
+
+//Declare Prototype
+static int32_t bench_cmd_show(shellObject_t *pshell, int32_t argc, char *argv[]);
+static size_t bench_key(const char *keys);
+static void bench_run(struct bench *pb);
+static uint32_t bench_check(struct bench *pb);
+static void bench_dump(struct bench *pb);
+static int32_t bench_reference(const char *path, const char *name);
+
+
+static const shell_cmd_t bench_cmds[] = {
+    { "show", bench_cmd_show, "print its arguments", NULL },
+};
+
+
+
+
+//Private Function
+//*****************************************************************************
+static int32_t bench_cmd_show(shellObject_t *pshell, int32_t argc, char *argv[])
+{
+    shellPrintf(pshell, "%d args\r\n", (int) argc - 1);
+    (void) argv;
+
+    return 0;
+}
+
+
+//*****************************************************************************
+// length of the first key: a byte, CR LF, a control sequence or a paste
+static size_t bench_key(const char *keys)
+{
+    const char *end;
+    size_t len;
+
+    if (!strncmp(keys, ESC "[200~", 6)) {
+        end = strstr(keys, ESC "[201~");
+        return end ? (size_t) (end - keys) + 6 : strlen(keys);
+    }
+
+    if ((keys[0] == '\033') && (keys[1] == '[')) {
+        for (len = 2; keys[len] && ((keys[len] < 0x40) || (keys[len] > 0x7E)); len++) {}
+        return keys[len] ? len + 1 : len;
+    }
+
+    if ((keys[0] == '\r') && (keys[1] == '\n')) return 2;
+
+    return 1;
+}
+
+
+//*****************************************************************************
+// run the engine until the input is consumed, the output goes on the screen
+// and the answers of the terminal come back as input
+static void bench_run(struct bench *pb)
+{
+    shellObject_t *pshell = pb->pshell;
+    uint8_t buf[1024];
+    uint32_t passes;
+    uint32_t n;
+    bool busy;
+    char *line;
+
+    for (passes = 0; passes < BENCH_PASSES; passes++) {
+        line = shellEngine(pshell);
+        if (line != NULL) shellExec(pshell, line);
+
+        busy = false;
+        while ((n = shellRingRead(&pb->tx, buf, sizeof(buf))) > 0) {
+            vtEmuWrite(&pb->emu, buf, n);
+            pb->bytes += n;
+            busy = true;
+        }
+        while ((n = vtEmuReply(&pb->emu, buf, sizeof(buf))) > 0) {
+            shellRingWrite(&pb->rx, buf, n);
+            busy = true;
+        }
+
+        if (!busy && !shellRingCount(&pb->rx) && (pshell->in_pos >= pshell->in_len) &&
+            (pshell->state == SHELL_STATE_READY)) return;
+    }
+}
+
+
+//*****************************************************************************
+// the screen must show the prompt and the line, the cursor on line_cur and
+// nothing after the line. Return the number of wrong cells.
+static uint32_t bench_check(struct bench *pb)
+{
+    shellObject_t *pshell = pb->pshell;
+    vtemu_t *emu = &pb->emu;
+    uint16_t ncols = emu->ncols;
+    uint16_t plen = pshell->prompt_len;
+    uint16_t end = plen + pshell->line_pos;
+    uint16_t cur = plen + pshell->line_cur;
+    uint32_t errors = 0;
+    int32_t first;
+    uint16_t row, col, i;
+    char want;
+
+    first = (int32_t) emu->cur.row - cur / ncols;
+
+    if (emu->cur.wrap || (emu->cur.col != cur % ncols) || (first < 0)) {
+        if (!pb->quiet) printf("  cursor %u,%u%s, line_cur %u\n", emu->cur.row, emu->cur.col,
+                               emu->cur.wrap ? " (wrap pending)" : "", pshell->line_cur);
+        return 1;
+    }
+
+    for (i = 0; i < end; i++) {
+        row = first + i / ncols;
+        col = i % ncols;
+        want = (i < plen) ? pshell->prompt[i] : pshell->line[i - plen];
+
+        if (vtEmuChar(emu, row, col) != want) {
+            if (!errors && !pb->quiet) printf("  offset %u: '%c' instead of '%c'\n", i, vtEmuChar(emu, row, col), want);
+            errors++;
+        }
+#if SHELL_CFG_HIGHLIGHT
+        else if ((i >= plen) && (want != ' ') && pshell->highlight &&
+                 (vtEmuColour(emu, row, col) != bench_hl_colour[pshell->hl[i - plen]] - '0')) {
+            if (!errors && !pb->quiet) printf("  offset %u: colour %u instead of %c\n", i,
+                                              vtEmuColour(emu, row, col), bench_hl_colour[pshell->hl[i - plen]]);
+            errors++;
+        }
+#endif
+    }
+
+    /* left overs of a longer line */
+    for (i = end; i < (emu->nrows - first) * ncols; i++) {
+        row = first + i / ncols;
+        col = i % ncols;
+
+        if (vtEmuChar(emu, row, col) != ' ') {
+            if (!errors && !pb->quiet) printf("  offset %u: '%c' after the end\n", i, vtEmuChar(emu, row, col));
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+
+//*****************************************************************************
+static void bench_dump(struct bench *pb)
+{
+    char text[VTEMU_MAX_COLS + 1];
+    uint16_t row;
+
+    printf("  line \"%s\" pos %u cur %u\n", pb->pshell->line, pb->pshell->line_pos, pb->pshell->line_cur);
+    for (row = 0; row < pb->emu.nrows; row++) {
+        printf("  %2u|%s\n", row, vtEmuRow(&pb->emu, row, text));
+    }
+}
+
+
+//*****************************************************************************
+// bytes of the operation in a previous report, -1 if it isn't there
+static int32_t bench_reference(const char *path, const char *name)
+{
+    char op[64];
+    unsigned bytes;
+    FILE *file;
+    int32_t found = -1;
+
+    file = fopen(path, "r");
+    if (file == NULL) return -1;
+
+    while (fscanf(file, "%63s %u", op, &bytes) == 2) {
+        if (!strcmp(op, name)) {
+            found = bytes;
+            break;
+        }
+    }
+
+    fclose(file);
+
+    return found;
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+int main(int argc, char *argv[])
+{
+    static uint8_t rx_buf[BENCH_RING_LEN], tx_buf[BENCH_RING_LEN];
+    static struct bench b;
+    struct bench_res res[BENCH_OPS];
+    const char *report = NULL;
+    const char *reference = NULL;
+    FILE *out = NULL;
+    uint32_t total = 0, total_keys = 0;
+    int status = 0;
+    size_t i, len;
+    int32_t ref;
+    int opt;
+
+    for (opt = 1; opt < argc; opt++) {
+        if (!strcmp(argv[opt], "-q")) b.quiet = true;
+        else if (!strcmp(argv[opt], "-o") && (opt + 1 < argc)) report = argv[++opt];
+        else if (!strcmp(argv[opt], "-r") && (opt + 1 < argc)) reference = argv[++opt];
+        else {
+            fprintf(stderr, "usage: %s [-q] [-o report] [-r reference]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    shellRingInit(&b.rx, rx_buf, sizeof(rx_buf));
+    shellRingInit(&b.tx, tx_buf, sizeof(tx_buf));
+    b.io.rx = &b.rx;
+    b.io.tx = &b.tx;
+    vtEmuInit(&b.emu, BENCH_ROWS, BENCH_COLS);
+
+    b.pshell = shellOpenIo(&shell_io_ring, &b.io, BENCH_PROMPT, NULL);
+    if (b.pshell == NULL) return 2;
+    shellSetCommands(b.pshell, bench_cmds, sizeof(bench_cmds) / sizeof(bench_cmds[0]));
+
+    /* the size probe is answered by the emulator */
+    shellInit(b.pshell, true);
+    bench_run(&b);
+
+    if ((b.pshell->vt->ncols != BENCH_COLS) || bench_check(&b)) {
+        printf("setup: the session doesn't see the screen\n");
+        bench_dump(&b);
+        return 1;
+    }
+
+    if (report != NULL) out = fopen(report, "w");
+
+    printf("%-16s %5s %7s %9s %5s %9s  %s\n", "op", "keys", "bytes", "bytes/key", "max", "ms/key@" "9600", "screen");
+
+    for (i = 0; i < sizeof(bench_ops) / sizeof(bench_ops[0]); i++) {
+        const char *keys = bench_ops[i].keys;
+        struct bench_res *r = &res[i];
+
+        memset(r, 0, sizeof(*r));
+
+        while (*keys) {
+            uint32_t before = b.bytes;
+
+            len = bench_key(keys);
+            shellRingWrite(&b.rx, (const uint8_t *) keys, len);
+            keys += len;
+
+            bench_run(&b);
+
+            r->keys++;
+            r->bytes += b.bytes - before;
+            if (b.bytes - before > r->max) r->max = b.bytes - before;
+
+            if (bench_check(&b)) {
+                r->errors++;
+                if (!b.quiet) bench_dump(&b);
+            }
+        }
+
+        printf("%-16s %5u %7u %9.1f %5u %9.2f  %s", bench_ops[i].name, r->keys, r->bytes,
+               (double) r->bytes / r->keys, r->max,
+               (double) r->bytes * 10 * 1000 / BENCH_BAUDS / r->keys, r->errors ? "WRONG" : "ok");
+
+        if (r->errors) status = 1;
+
+        if (reference != NULL) {
+            ref = bench_reference(reference, bench_ops[i].name);
+            if ((ref >= 0) && (r->bytes > (uint32_t) ref)) {
+                printf("  +%u bytes", r->bytes - ref);
+                if (!status) status = 2;
+            }
+        }
+        printf("\n");
+
+        if (out != NULL) fprintf(out, "%s %u\n", bench_ops[i].name, r->bytes);
+
+        total += r->bytes;
+        total_keys += r->keys;
+    }
+
+    printf("%-16s %5u %7u %9.1f\n", "total", total_keys, total, (double) total / total_keys);
+
+    if (out != NULL) fclose(out);
+    shellClose(b.pshell);
+
+    return status;
+}
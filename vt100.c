@@ -30,6 +30,7 @@
 
 
 #include <stdio.h>
+#include <string.h>
 
 #include "vt100.h"
 
@@ -41,6 +42,9 @@
 #define VT_SPECIAL_CHAR_G1  ')'
 #define VT_SPECIAL_KEY      '~'
 
+#define VT_KEY_PASTE_BEGIN  200             //!< ESC[200~ bracketed paste start
+#define VT_KEY_PASTE_END    201             //!< ESC[201~ bracketed paste end
+
 
 /******************************* VT Command ***********************************/
 #define VT_CMD_RESET        'c'             //!< Reset Device
@@ -156,6 +160,19 @@ static int32_t vt_esc_special_process(vt100_t *pvt, int32_t ch)
             pvt->row_pos = pvt->esc_elem[0];
             pvt->col_pos = pvt->esc_elem[1];
             ch = 0;
+
+            /* the reply of a size probe gives the bottom right corner */
+            if (pvt->size_probe) {
+                pvt->size_probe = false;
+                ch = VT_EVT_SIZE;
+            }
+            break;
+        case VT_SPECIAL_KEY:
+            ch = 0;
+            if (pvt->esc_elems) {
+                if (pvt->esc_elem[0] == VT_KEY_PASTE_BEGIN) ch = VT_EVT_PASTE_BEGIN;
+                else if (pvt->esc_elem[0] == VT_KEY_PASTE_END) ch = VT_EVT_PASTE_END;
+            }
             break;
         default:
             ch = 0;
@@ -173,6 +190,17 @@ static int32_t vt_esc_special_process(vt100_t *pvt, int32_t ch)
 
 
 //Public Function
+//*****************************************************************************
+// Reset the parser and set the default screen size
+void vtInit(vt100_t *pvt, uint16_t nrows, uint16_t ncols)
+{
+    memset(pvt, 0, sizeof(vt100_t));
+
+    pvt->nrows = nrows;
+    pvt->ncols = ncols;
+}
+
+
 //*****************************************************************************
 //return -1 = EOF
 int32_t vtProcessChar(vt100_t *pvt, int32_t ch)
@@ -290,7 +318,7 @@ char *vtSetCursor(vt100_t *pvt, uint16_t row, uint16_t col)
 //***************************
 // Move cursor X to UP, DOWN, LEFT, RIGHT
 //***************************
-char *vtMoveCursor(vt100_t *pvt, uint8_t num, uint8_t cmd)
+char *vtMoveCursor(vt100_t *pvt, uint16_t num, uint8_t cmd)
 {
     snprintf(pvt->out_buffer, VT_ESC_ELEM_SIZE, "%s%d%c",VT_ESC_SEQ, num, cmd);
     return pvt->out_buffer;
@@ -328,6 +356,20 @@ char *vtInvokeCursor(vt100_t *pvt)
 }
 
 
+//***************************
+// Probe the screen size
+//
+// Request the cursor position, the reply is
+// flagged VT_EVT_SIZE by vtProcessChar(). The
+// cursor must be moved to VT_PROBE_POS before.
+//***************************
+char *vtProbeSize(vt100_t *pvt)
+{
+    pvt->size_probe = true;
+    return vtInvokeCursor(pvt);
+}
+
+
 //***************************
 // Region screen scrolling to some lines only
 //***************************
@@ -49,6 +49,8 @@ extern "C" {
 
 #define VT_ESC_ELEM_SIZE        16      //!< Buffer for escape sequence.
 
+#define VT_PROBE_POS            999     //!< Far corner used to probe the screen size
+
 
 
 // Ascii Keyboard Key Extended
@@ -138,6 +140,12 @@ extern "C" {
 #define KB_ALT_DELETE       (0X100|163)
 
 
+// Terminal Events
+#define VT_EVT_SIZE         (0X200|1)   //!< Terminal answered a size probe (row_pos/col_pos)
+#define VT_EVT_PASTE_BEGIN  (0X200|2)   //!< Bracketed paste start marker ESC[200~
+#define VT_EVT_PASTE_END    (0X200|3)   //!< Bracketed paste end marker ESC[201~
+
+
 
 /*** Ascii Key codes ***/
 #define KEY_NUL      0   //!< ^@ Null character
@@ -202,6 +210,7 @@ extern "C" {
 #define VT_MODE_ARM            "?8"     //!< Auto Wrap  ON/OFF
 #define VT_MODE_PFF            "?18"    //!< Select termination char (FF) ON/OFF
 #define VT_MODE_PEX            "?19"    //!< Selects full screen or scroll region to print
+#define VT_MODE_BPM            "?2004"  //!< Bracketed paste ON/OFF
 
 #define VT_MODE_ATTR_NONE       '0'     //!< Reset all attributes
 #define VT_MODE_ATTR_BOLD       '1'     //!< Set "bright" attribute
@@ -277,7 +286,8 @@ struct vt100{
    int32_t              esc_cur_num;
    int32_t              esc_char;
    uint8_t              esc_elems;
-   uint8_t              esc_elem[VT_ESC_ELEM_SIZE]; //!< Escape Sequence buffer
+   uint16_t             esc_elem[VT_ESC_ELEM_SIZE]; //!< Escape Sequence buffer
+   bool                 size_probe;                 //!< Waiting the reply of a size probe
 };
 typedef struct vt100 vt100_t;
 
@@ -289,6 +299,7 @@ typedef struct vt100 vt100_t;
 
 
 
+void vtInit(vt100_t *pvt, uint16_t nrows, uint16_t ncols);
 int32_t vtProcessChar(vt100_t *pvt, int32_t ch);
 char * vtResetDevice(vt100_t *pvt);
 char * vtSetCursorVisible(vt100_t *pvt, bool state);
@@ -301,10 +312,11 @@ char *vtResizeScreen(vt100_t *pvt, uint16_t nrows, uint16_t ncols);
 char *vtSetColour(vt100_t *pvt, uint8_t fg_bg, uint8_t colour);
 
 char *vtSetCursor(vt100_t *pvt, uint16_t row, uint16_t col);
-char *vtMoveCursor(vt100_t *pvt, uint8_t num, uint8_t cmd);
+char *vtMoveCursor(vt100_t *pvt, uint16_t num, uint8_t cmd);
 char *vtSaveCursor(vt100_t *pvt);
 char *vtRestoreCursor(vt100_t *pvt);
 char *vtInvokeCursor(vt100_t *pvt);
+char *vtProbeSize(vt100_t *pvt);
 
 char *vtSetScrollRegion(vt100_t *pvt, uint8_t start, uint8_t end);
 char *vtChangeModeAttr(vt100_t *pvt, const char *mode, uint8_t cmd);
@@ -0,0 +1,416 @@
+/***************************************************************************//**
+* @file
+* @brief C File vtemu.c
+* @details VT100 emulator, the screen a terminal would show
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 22:41:18
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "vtemu.h"
+
+
+
+#define EMU_GROUND                      0
+#define EMU_ESC                         1          //!< ESC read
+#define EMU_CSI                         2          //!< ESC [ read, parameters follow
+
+#define EMU_TAB                         8          //!< Tab stops
+
+
+
+//Declare Prototype
+static void emu_clear(vtemu_t *emu, uint16_t row, uint16_t from, uint16_t to);
+static void emu_scroll_up(vtemu_t *emu);
+static void emu_linefeed(vtemu_t *emu);
+static void emu_print(vtemu_t *emu, uint8_t ch);
+static uint16_t emu_param(const vtemu_t *emu, uint8_t idx, uint16_t def);
+static void emu_reply(vtemu_t *emu, const char *text);
+static void emu_csi(vtemu_t *emu, uint8_t final);
+static void emu_byte(vtemu_t *emu, uint8_t ch);
+
+
+
+
+
+
+//Private Function
+//*****************************************************************************
+// blank the columns [from, to) of a row
+static void emu_clear(vtemu_t *emu, uint16_t row, uint16_t from, uint16_t to)
+{
+    if (to > emu->ncols) to = emu->ncols;
+    if (from >= to) return;
+
+    memset(&emu->ch[row][from], ' ', to - from);
+    memset(&emu->fg[row][from], VTEMU_FG_DEFAULT, to - from);
+}
+
+
+//*****************************************************************************
+// the scroll region moves up by one row
+static void emu_scroll_up(vtemu_t *emu)
+{
+    uint16_t row;
+
+    for (row = emu->top; row < emu->bottom; row++) {
+        memcpy(emu->ch[row], emu->ch[row + 1], emu->ncols);
+        memcpy(emu->fg[row], emu->fg[row + 1], emu->ncols);
+    }
+    emu_clear(emu, emu->bottom, 0, emu->ncols);
+    emu->scrolls++;
+}
+
+
+//*****************************************************************************
+static void emu_linefeed(vtemu_t *emu)
+{
+    emu->cur.wrap = false;
+
+    if (emu->cur.row == emu->bottom) emu_scroll_up(emu);
+    else if (emu->cur.row < emu->nrows - 1) emu->cur.row++;
+}
+
+
+//*****************************************************************************
+// a char on the screen, the wrap is done by the next one
+static void emu_print(vtemu_t *emu, uint8_t ch)
+{
+    if (emu->cur.wrap) {
+        emu->cur.col = 0;
+        emu_linefeed(emu);
+    }
+
+    emu->ch[emu->cur.row][emu->cur.col] = ch;
+    emu->fg[emu->cur.row][emu->cur.col] = emu->cur.fg;
+
+    if (emu->cur.col == emu->ncols - 1) emu->cur.wrap = true;
+    else emu->cur.col++;
+}
+
+
+//*****************************************************************************
+// parameter idx, def if missing or 0
+static uint16_t emu_param(const vtemu_t *emu, uint8_t idx, uint16_t def)
+{
+    if ((idx >= emu->nparams) || !emu->param[idx]) return def;
+
+    return emu->param[idx];
+}
+
+
+//*****************************************************************************
+static void emu_reply(vtemu_t *emu, const char *text)
+{
+    size_t len = strlen(text);
+
+    if (emu->reply_len + len > sizeof(emu->reply)) return;
+
+    memcpy(&emu->reply[emu->reply_len], text, len);
+    emu->reply_len += len;
+}
+
+
+//*****************************************************************************
+// control sequence, the parameters are read
+static void emu_csi(vtemu_t *emu, uint8_t final)
+{
+    struct vtemu_cursor *cur = &emu->cur;
+    uint16_t n = emu_param(emu, 0, 1);
+    char text[32];
+    uint16_t i;
+
+    if (final != 'm') cur->wrap = false;
+
+    switch (final) {
+        case 'A':
+            /* it stops on the top margin */
+            if (cur->row >= emu->top) cur->row = (cur->row - emu->top >= n) ? cur->row - n : emu->top;
+            else cur->row = (cur->row >= n) ? cur->row - n : 0;
+            break;
+        case 'B':
+            /* and on the bottom one */
+            if (cur->row <= emu->bottom) cur->row = (cur->row + n <= emu->bottom) ? cur->row + n : emu->bottom;
+            else cur->row = (cur->row + n < emu->nrows) ? cur->row + n : emu->nrows - 1;
+            break;
+        case 'C':
+            cur->col = (cur->col + n < emu->ncols) ? cur->col + n : emu->ncols - 1;
+            break;
+        case 'D':
+            cur->col = (cur->col >= n) ? cur->col - n : 0;
+            break;
+        case 'G':
+            cur->col = (n <= emu->ncols) ? n - 1 : emu->ncols - 1;
+            break;
+        case 'd':
+            cur->row = (n <= emu->nrows) ? n - 1 : emu->nrows - 1;
+            break;
+        case 'H':
+        case 'f':
+            n = emu_param(emu, 0, 1);
+            cur->row = (n <= emu->nrows) ? n - 1 : emu->nrows - 1;
+            n = emu_param(emu, 1, 1);
+            cur->col = (n <= emu->ncols) ? n - 1 : emu->ncols - 1;
+            break;
+        case 'J':
+            switch (emu_param(emu, 0, 0)) {
+                case 0:
+                    emu_clear(emu, cur->row, cur->col, emu->ncols);
+                    for (i = cur->row + 1; i < emu->nrows; i++) emu_clear(emu, i, 0, emu->ncols);
+                    break;
+                case 1:
+                    for (i = 0; i < cur->row; i++) emu_clear(emu, i, 0, emu->ncols);
+                    emu_clear(emu, cur->row, 0, cur->col + 1);
+                    break;
+                default:
+                    for (i = 0; i < emu->nrows; i++) emu_clear(emu, i, 0, emu->ncols);
+                    break;
+            }
+            break;
+        case 'K':
+            switch (emu_param(emu, 0, 0)) {
+                case 0:  emu_clear(emu, cur->row, cur->col, emu->ncols); break;
+                case 1:  emu_clear(emu, cur->row, 0, cur->col + 1); break;
+                default: emu_clear(emu, cur->row, 0, emu->ncols); break;
+            }
+            break;
+        case 'P':
+            if (n > emu->ncols - cur->col) n = emu->ncols - cur->col;
+            memmove(&emu->ch[cur->row][cur->col], &emu->ch[cur->row][cur->col + n], emu->ncols - cur->col - n);
+            memmove(&emu->fg[cur->row][cur->col], &emu->fg[cur->row][cur->col + n], emu->ncols - cur->col - n);
+            emu_clear(emu, cur->row, emu->ncols - n, emu->ncols);
+            break;
+        case '@':
+            if (n > emu->ncols - cur->col) n = emu->ncols - cur->col;
+            memmove(&emu->ch[cur->row][cur->col + n], &emu->ch[cur->row][cur->col], emu->ncols - cur->col - n);
+            memmove(&emu->fg[cur->row][cur->col + n], &emu->fg[cur->row][cur->col], emu->ncols - cur->col - n);
+            emu_clear(emu, cur->row, cur->col, cur->col + n);
+            break;
+        case 'X':
+            emu_clear(emu, cur->row, cur->col, cur->col + n);
+            break;
+        case 'r':
+            emu->top = emu_param(emu, 0, 1) - 1;
+            emu->bottom = emu_param(emu, 1, emu->nrows) - 1;
+            if (emu->bottom >= emu->nrows) emu->bottom = emu->nrows - 1;
+            if (emu->top >= emu->bottom) {
+                emu->top = 0;
+                emu->bottom = emu->nrows - 1;
+            }
+            cur->row = 0;
+            cur->col = 0;
+            break;
+        case 's':
+            emu->saved = *cur;
+            break;
+        case 'u':
+            *cur = emu->saved;
+            break;
+        case 'm':
+            for (i = 0; i < emu->nparams || !i; i++) {
+                uint16_t p = (i < emu->nparams) ? emu->param[i] : 0;
+
+                if (!p || (p == 39)) cur->fg = VTEMU_FG_DEFAULT;
+                else if ((p >= 30) && (p <= 37)) cur->fg = p - 30;
+            }
+            break;
+        case 'h':
+        case 'l':
+            if (!emu->priv && (emu_param(emu, 0, 0) == 20)) emu->lnm = (final == 'h');
+            break;
+        case 'n':
+            if (emu_param(emu, 0, 0) == 6) {
+                snprintf(text, sizeof(text), "\033[%u;%uR", cur->row + 1, cur->col + 1);
+                emu_reply(emu, text);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+
+//*****************************************************************************
+static void emu_byte(vtemu_t *emu, uint8_t ch)
+{
+    emu->bytes++;
+
+    switch (emu->state) {
+        case EMU_ESC:
+            emu->state = EMU_GROUND;
+            if (ch == '[') {
+                emu->state = EMU_CSI;
+                emu->priv = false;
+                emu->nparams = 0;
+                memset(emu->param, 0, sizeof(emu->param));
+            }
+            else if (ch == '7') {
+                emu->saved = emu->cur;
+            }
+            else if (ch == '8') {
+                emu->cur = emu->saved;
+            }
+            return;
+        case EMU_CSI:
+            if (ch == '?') {
+                emu->priv = true;
+            }
+            else if ((ch >= '0') && (ch <= '9')) {
+                if (!emu->nparams) emu->nparams = 1;
+                if (emu->nparams <= VTEMU_PARAMS) {
+                    emu->param[emu->nparams - 1] = emu->param[emu->nparams - 1] * 10 + (ch - '0');
+                }
+            }
+            else if (ch == ';') {
+                if (!emu->nparams) emu->nparams = 1;
+                emu->nparams++;
+            }
+            else if ((ch >= 0x40) && (ch <= 0x7E)) {
+                if (emu->nparams > VTEMU_PARAMS) emu->nparams = VTEMU_PARAMS;
+                emu->state = EMU_GROUND;
+                emu_csi(emu, ch);
+            }
+            return;
+        default:
+            break;
+    }
+
+    switch (ch) {
+        case 0x1B:
+            emu->state = EMU_ESC;
+            emu->seqs++;
+            break;
+        case '\r':
+            emu->cur.col = 0;
+            emu->cur.wrap = false;
+            break;
+        case '\n':
+        case '\v':
+        case '\f':
+            if (emu->lnm) emu->cur.col = 0;
+            emu_linefeed(emu);
+            break;
+        case '\b':
+            if (emu->cur.col) emu->cur.col--;
+            emu->cur.wrap = false;
+            break;
+        case '\t':
+            emu->cur.col = (emu->cur.col / EMU_TAB + 1) * EMU_TAB;
+            if (emu->cur.col >= emu->ncols) emu->cur.col = emu->ncols - 1;
+            emu->cur.wrap = false;
+            break;
+        default:
+            if (ch >= 0x20) emu_print(emu, ch);
+            break;
+    }
+}
+
+
+
+
+
+
+
+
+
+/******************************************************************************/
+//Public Function
+//*****************************************************************************
+// Blank screen, cursor home, no scroll region
+bool vtEmuInit(vtemu_t *emu, uint16_t nrows, uint16_t ncols)
+{
+    uint16_t row;
+
+    if (!nrows || !ncols || (nrows > VTEMU_MAX_ROWS) || (ncols > VTEMU_MAX_COLS)) return false;
+
+    memset(emu, 0, sizeof(vtemu_t));
+    emu->nrows = nrows;
+    emu->ncols = ncols;
+    emu->bottom = nrows - 1;
+    emu->cur.fg = VTEMU_FG_DEFAULT;
+    emu->saved = emu->cur;
+
+    for (row = 0; row < nrows; row++) emu_clear(emu, row, 0, ncols);
+
+    return true;
+}
+
+
+//*****************************************************************************
+// Interpret the output of the shell
+void vtEmuWrite(vtemu_t *emu, const uint8_t *data, size_t len)
+{
+    while (len--) emu_byte(emu, *data++);
+}
+
+
+//*****************************************************************************
+// Take the answers of the terminal, to give to the shell as input
+uint32_t vtEmuReply(vtemu_t *emu, uint8_t *buf, uint32_t len)
+{
+    if (len > emu->reply_len) len = emu->reply_len;
+
+    memcpy(buf, emu->reply, len);
+    memmove(emu->reply, &emu->reply[len], emu->reply_len - len);
+    emu->reply_len -= len;
+
+    return len;
+}
+
+
+char vtEmuChar(const vtemu_t *emu, uint16_t row, uint16_t col)
+{
+    if ((row >= emu->nrows) || (col >= emu->ncols)) return ' ';
+
+    return emu->ch[row][col];
+}
+
+
+//*****************************************************************************
+// Foreground colour of a cell, 0 to 7 or VTEMU_FG_DEFAULT
+uint8_t vtEmuColour(const vtemu_t *emu, uint16_t row, uint16_t col)
+{
+    if ((row >= emu->nrows) || (col >= emu->ncols)) return VTEMU_FG_DEFAULT;
+
+    return emu->fg[row][col];
+}
+
+
+//*****************************************************************************
+// Text of a row without its trailing blanks, buf holds ncols + 1 chars
+char *vtEmuRow(const vtemu_t *emu, uint16_t row, char *buf)
+{
+    uint16_t len = emu->ncols;
+
+    if (row >= emu->nrows) len = 0;
+    else while (len && (emu->ch[row][len - 1] == ' ')) len--;
+
+    if (len) memcpy(buf, emu->ch[row], len);
+    buf[len] = '\0';
+
+    return buf;
+}
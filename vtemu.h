@@ -0,0 +1,124 @@
+/*****************************************************************//**
+* @file
+* @brief H File vtemu.h
+* @details VT100 emulator, the screen a terminal would show
+*
+*   The bytes written by the shell are interpreted as a terminal does:
+*   autowrap with the wrap pending on the last column, scroll region,
+*   saved cursor, erase, insert and delete of chars and the foreground
+*   colour of each cell. The size probe is answered like a terminal, the
+*   reply is read with vtEmuReply() and given back as input.
+*
+*   It's an oracle for tests and benchmarks, not a terminal: the sequences
+*   the shell never sends are ignored.
+*
+* @author Auban le Grelle
+*
+* @date 19 oct. 2026 22:41:18
+*
+* <B>Contact:</B> a.legrelle@lgelectronicsystems.com
+*
+* @copyright (c) 2012, Electronic Systems
+*
+* <B>Distribution:</B> This file is part of EmbeddedLib.
+*
+*    EmbeddedLib is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    EmbeddedLib is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with EmbeddedLib.  If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*******************************************************************************/
+
+#ifndef _VTEMU_H
+#define _VTEMU_H
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#ifndef VTEMU_MAX_ROWS
+#define VTEMU_MAX_ROWS                  64
+#endif
+
+#ifndef VTEMU_MAX_COLS
+#define VTEMU_MAX_COLS                  160
+#endif
+
+#define VTEMU_PARAMS                    8          //!< Parameters of a control sequence
+#define VTEMU_REPLY_LEN                 64
+#define VTEMU_FG_DEFAULT                9          //!< Colour of a cell without SGR
+
+
+/**
+ * Cursor and what DECSC keeps with it
+ */
+struct vtemu_cursor
+{
+    uint16_t            row;                       //!< From 0
+    uint16_t            col;                       //!< From 0
+    uint8_t             fg;
+    bool                wrap;                      //!< On the last column, the next char wraps
+};
+
+/**
+ * Emulated terminal
+ */
+struct vtemu
+{
+    uint16_t            nrows;
+    uint16_t            ncols;
+    struct vtemu_cursor cur;
+    struct vtemu_cursor saved;
+    uint16_t            top;                       //!< Scroll region, from 0
+    uint16_t            bottom;
+    bool                lnm;                       //!< LF is also a CR
+
+    uint8_t             state;                     //!< Parser state
+    bool                priv;                      //!< '?' control sequence
+    uint8_t             nparams;
+    uint16_t            param[VTEMU_PARAMS];
+
+    char                ch[VTEMU_MAX_ROWS][VTEMU_MAX_COLS];
+    uint8_t             fg[VTEMU_MAX_ROWS][VTEMU_MAX_COLS];
+
+    uint8_t             reply[VTEMU_REPLY_LEN];    //!< Answers of the terminal
+    uint32_t            reply_len;
+
+    uint32_t            bytes;                     //!< Bytes interpreted
+    uint32_t            seqs;                      //!< Escape sequences among them
+    uint32_t            scrolls;
+};
+typedef struct vtemu vtemu_t;
+
+
+
+bool vtEmuInit(vtemu_t *emu, uint16_t nrows, uint16_t ncols);
+void vtEmuWrite(vtemu_t *emu, const uint8_t *data, size_t len);
+uint32_t vtEmuReply(vtemu_t *emu, uint8_t *buf, uint32_t len);
+char vtEmuChar(const vtemu_t *emu, uint16_t row, uint16_t col);
+uint8_t vtEmuColour(const vtemu_t *emu, uint16_t row, uint16_t col);
+char *vtEmuRow(const vtemu_t *emu, uint16_t row, char *buf);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VTEMU_H */